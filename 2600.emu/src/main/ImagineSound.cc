@@ -7,7 +7,7 @@ void ImagineSound::open()
 	myTIASound.reset();
 
 	// Now initialize the TIASound object which will actually generate sound
-	myTIASound.outputFrequency(EmuSystem::pcmFormat.rate);
+	myTIASound.outputFrequency(tiaSoundRate);
 	//myTIASound.tiaFrequency(tiafreq);
 	myTIASound.channels(soundChannels, 0);
 
@@ -19,7 +19,7 @@ void ImagineSound::processAudio(TIASound::Sample* stream, uint length)
 	const uint channels = soundChannels;
 	// If there are excessive items on the queue then we'll remove some
 	//logMsg("sound duration %f", myRegWriteQueue.duration());
-	SysDDec streamLengthInSecs = (SysDDec)length/(SysDDec)EmuSystem::pcmFormat.rate;
+	SysDDec streamLengthInSecs = (SysDDec)length/(SysDDec)tiaSoundRate;
 	SysDDec excessStreamSecs = myRegWriteQueue.duration() - streamLengthInSecs;
 	if(excessStreamSecs > 0.0)
 	{
@@ -60,7 +60,7 @@ void ImagineSound::processAudio(TIASound::Sample* stream, uint length)
 			RegWrite& info = myRegWriteQueue.front();
 
 			// How long will the remaining samples in the fragment take to play
-			SysDDec duration = remaining / (SysDDec)EmuSystem::pcmFormat.rate;
+			SysDDec duration = remaining / (SysDDec)tiaSoundRate;
 
 			// Does the register update occur before the end of the fragment?
 			if(info.delta <= duration)
@@ -71,7 +71,7 @@ void ImagineSound::processAudio(TIASound::Sample* stream, uint length)
 				{
 					// Process the fragment upto the next TIA register write.  We
 					// round the count passed to process up if needed.
-					SysDDec samples = (EmuSystem::pcmFormat.rate * info.delta);
+					SysDDec samples = (tiaSoundRate * info.delta);
 					//        myTIASound.process(stream + (uInt32)position, (uInt32)samples +
 					//            (uInt32)(position + samples) -
 					//            ((uInt32)position + (uInt32)samples));
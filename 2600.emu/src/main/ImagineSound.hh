@@ -155,3 +155,5 @@ public:
 };
 
 static const uint soundChannels = 1;
+// samples are generated at the TIA's rate & converted by EmuSystem::writeSound()
+static const uint tiaSoundRate = 31400;
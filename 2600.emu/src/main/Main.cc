@@ -38,14 +38,18 @@
 #include <util/strings.h>
 #include <util/time/sys.hh>
 #include <util/preprocessor/repeat.h>
-#include <unzip.h>
 #include <EmuSystem.hh>
+#include <RomImage.hh>
+#ifndef CONFIG_IO_ARCHIVE
+#include <unzip.h>
+#endif
+#include <pixmap/PixmapConv.hh>
 #include <CommonFrameworkIncludes.hh>
 
 static ImagineSound *vcsSound = 0;
 static uint16 tiaColorMap[256];
 static const PixelFormatDesc *pixFmt = &PixelFormatRGB565;
-static uint tiaSoundRate = 0, tiaSamplesPerFrame = 0;
+static const uint tiaSamplesPerFrame = tiaSoundRate/60;
 static Console *console = 0;
 #include "MiscStella.hh"
 #define MAX_ROM_SIZE  512 * 1024
@@ -126,7 +130,11 @@ static bool isVCSRomExtension(const char *name)
 
 static bool isVCSExtension(const char *name)
 {
+	#ifdef CONFIG_IO_ARCHIVE
+	return isVCSRomExtension(name) || IoArchive::hasArchiveExtension(name);
+	#else
 	return isVCSRomExtension(name) || string_hasDotExtension(name, "zip");
+	#endif
 }
 
 static int vcsFsFilter(const char *name, int type)
@@ -158,15 +166,10 @@ void EmuSystem::saveAutoState()
 	{
 		FsSys::cPath saveStr;
 		sprintStateFilename(saveStr, -1);
-		logMsg("saving autosave-state %s", saveStr);
 		#ifdef CONFIG_BASE_IOS_SETUID
 			fixFilePermissions(saveStr);
 		#endif
-		Serializer state(string(saveStr), 0);
-		if(!stateManager.saveState(state))
-		{
-			logMsg("failed");
-		}
+		saveStateFile(saveStr, 1);
 	}
 }
 
@@ -190,88 +193,88 @@ static void updateSwitchValues()
 bool EmuSystem::vidSysIsPAL() { return 0; }
 bool touchControlsApplicable() { return 1; }
 
-static bool openROM(uchar buff[MAX_ROM_SIZE], const char *path, uint32& size)
+#ifndef CONFIG_IO_ARCHIVE
+static bool openZipROM(RomImage &rom, const char *path)
 {
-	if(string_hasDotExtension(path, "zip"))
-	{
-		unzFile zipFile = unzOpen(path);
-		if(!zipFile) return 0;
-
-		if(unzGoToFirstFile(zipFile) != UNZ_OK)
-		{
-			unzClose(zipFile);
-			return 0;
-		}
-
-		// Find a valid file
-		unz_file_info info;
-		bool foundRom = 0;
-		do
-		{
-			FsSys::cPath name;
-			if(unzGetCurrentFileInfo(zipFile, &info, name, 128, NULL, 0, NULL, 0) != UNZ_OK)
-			{
-				unzClose(zipFile);
-				return 0;
-			}
+	unzFile zipFile = unzOpen(path);
+	if(!zipFile) return 0;
 
-			if(isVCSRomExtension(name))
-			{
-				foundRom = 1;
-				break;
-			}
-		}
-		while(unzGoToNextFile(zipFile) == UNZ_OK);
+	if(unzGoToFirstFile(zipFile) != UNZ_OK)
+	{
+		unzClose(zipFile);
+		return 0;
+	}
 
-		if(!foundRom || info.uncompressed_size > MAX_ROM_SIZE)
+	// Find a valid file
+	unz_file_info info;
+	bool foundRom = 0;
+	do
+	{
+		FsSys::cPath name;
+		if(unzGetCurrentFileInfo(zipFile, &info, name, 128, NULL, 0, NULL, 0) != UNZ_OK)
 		{
 			unzClose(zipFile);
 			return 0;
 		}
 
-		// read the ROM data
-		if(unzOpenCurrentFile(zipFile) != UNZ_OK)
+		if(isVCSRomExtension(name))
 		{
-			unzClose(zipFile);
-			return 0;
+			foundRom = 1;
+			break;
 		}
+	}
+	while(unzGoToNextFile(zipFile) == UNZ_OK);
 
-		size = info.uncompressed_size;
-		if(unzReadCurrentFile(zipFile, buff, info.uncompressed_size) != (int)info.uncompressed_size)
-		{
-			unzCloseCurrentFile(zipFile);
-			unzClose(zipFile);
-			return 0;
-		}
+	if(!foundRom || info.uncompressed_size > MAX_ROM_SIZE)
+	{
+		unzClose(zipFile);
+		return 0;
+	}
 
-		unzCloseCurrentFile(zipFile);
+	// read the ROM data
+	if(unzOpenCurrentFile(zipFile) != UNZ_OK)
+	{
 		unzClose(zipFile);
-		return 1;
+		return 0;
 	}
-	else
+
+	uchar *buff = rom.allocate(info.uncompressed_size);
+	if(!buff || unzReadCurrentFile(zipFile, buff, info.uncompressed_size) != (int)info.uncompressed_size)
 	{
-		Io *f = IoSys::open(path);
-		if(!f)
-			return 0;
-		size = f->readUpTo(buff, MAX_ROM_SIZE);
-		delete f;
-		return 1;
+		rom.close();
+		unzCloseCurrentFile(zipFile);
+		unzClose(zipFile);
+		return 0;
 	}
+
+	unzCloseCurrentFile(zipFile);
+	unzClose(zipFile);
+	return 1;
+}
+#endif
+
+static bool openROM(RomImage &rom, const char *path)
+{
+	#ifndef CONFIG_IO_ARCHIVE
+	if(string_hasDotExtension(path, "zip"))
+		return openZipROM(rom, path);
+	#endif
+	return rom.open(path, IoArchive::EntryFilter::create<&isVCSRomExtension>(), "vcs");
 }
 
 int EmuSystem::loadGame(const char *path)
 {
 	closeGame();
 	setupGamePaths(path);
-	uchar buff[MAX_ROM_SIZE];
-	string md5;
-	uint32 size;
-	if(!openROM(buff, path, size))
+	// the cartridge keeps its own copy, so the mapped file is only read once
+	RomImage rom;
+	if(!openROM(rom, path))
 	{
 		popup.post("Error loading game", 1);
 		return 0;
 	}
-	md5 = MD5(buff, size);
+	uint32 size = IG::min(rom.size(), (size_t)MAX_ROM_SIZE);
+	string md5 = MD5(rom.data(), size);
 	Properties props;
 	osystem.propSet().getMD5(md5, props);
 
@@ -279,7 +282,7 @@ int EmuSystem::loadGame(const char *path)
 	string cartId;
 	Settings &settings = osystem.settings();
 	settings.setInt("romloadcount", 0);
-	cartridge = Cartridge::create(buff, size, md5, romType, cartId, osystem, settings);
+	cartridge = Cartridge::create(rom.data(), size, md5, romType, cartId, osystem, settings);
 	console = new Console(&osystem, cartridge, props);
 	osystem.myConsole = console;
 
@@ -306,17 +309,20 @@ void EmuSystem::clearInputBuffers()
 void EmuSystem::configAudioRate()
 {
 	pcmFormat.rate = optionSoundRate;
-	tiaSoundRate = optionSoundRate;
+	applyAudioRateScale();
+}
+
+// the scale is applied by writeSound()'s resampler, which keeps its state
+void EmuSystem::applyAudioRateScale()
+{
+	// whole frames of TIA samples are generated, so that's the effective rate
+	double rate = tiaSamplesPerFrame * 60.;
 	#if defined(CONFIG_ENV_WEBOS)
 	if(optionFrameSkip != optionFrameSkipAuto)
-		tiaSoundRate = (float)optionSoundRate * (42660./44100.); // better sync with Pre's refresh rate
+		rate *= 44100./42660.; // better sync with Pre's refresh rate
 	#endif
-	tiaSamplesPerFrame = tiaSoundRate/60.;
-	if(gameIsRunning())
-	{
-		vcsSound->tiaSound().outputFrequency(tiaSoundRate);
-	}
-	logMsg("set sound rate %d", tiaSoundRate);
+	setNativeSoundRate(rate);
+	logMsg("set native sound rate %f", rate);
 }
 
 static const uint audioMaxFramesPerUpdate = (Audio::maxRate/59)*2;
@@ -459,24 +465,14 @@ void EmuSystem::runFrame(bool renderGfx, bool processGfx, bool renderAudio)
 		assert(tia.height() <= 320);
 		uint h = tia.height();
 		uint8* currentFrame = tia.currentFrameBuffer() /*+ (tia.ystart() * 160)*/;
-		iterateTimes(160 * h, i)
-		{
-			pixBuff[i] = tiaColorMap[currentFrame[i]];
-		}
+		PixmapConv::lookup(pixBuff, currentFrame, 160 * h, tiaColorMap);
 		emuView.updateAndDrawContent();
 	}
 	if(renderAudio)
 	{
-		#ifdef USE_NEW_AUDIO
-		Audio::BufferContext *aBuff = Audio::getPlayBuffer(tiaSamplesPerFrame);
-		if(!aBuff) return;
-		vcsSound->processAudio((TIASound::Sample*)aBuff->data, aBuff->frames);
-		Audio::commitPlayBuffer(aBuff, aBuff->frames);
-		#else
 		TIASound::Sample buff[tiaSamplesPerFrame*soundChannels];
 		vcsSound->processAudio(buff, tiaSamplesPerFrame);
-		Audio::writePcm((uchar*)buff, tiaSamplesPerFrame);
-		#endif
+		writeSound(buff, tiaSamplesPerFrame);
 	}
 }
 
@@ -490,31 +486,45 @@ int EmuSystem::saveState()
 {
 	FsSys::cPath saveStr;
 	sprintStateFilename(saveStr, saveStateSlot);
-	logMsg("saving state %s", saveStr);
 	#ifdef CONFIG_BASE_IOS_SETUID
 		fixFilePermissions(saveStr);
 	#endif
-	Serializer state(string(saveStr), 0);
-	if(!stateManager.saveState(state))
-	{
-		return STATE_RESULT_IO_ERROR;
-	}
-	return STATE_RESULT_OK;
+	return saveStateFile(saveStr);
 }
 
 int EmuSystem::loadState(int saveStateSlot)
 {
 	FsSys::cPath saveStr;
 	sprintStateFilename(saveStr, saveStateSlot);
-	logMsg("loading state %s", saveStr);
 	#ifdef CONFIG_BASE_IOS_SETUID
 		fixFilePermissions(saveStr);
 	#endif
-	Serializer state(string(saveStr), 1);
+	return loadStateFile(saveStr);
+}
+
+// state files hold the same serialized data as the in-memory states
+uint EmuSystem::stateBufferSize()
+{
+	Serializer state;
+	if(!stateManager.saveState(state))
+		return 0;
+	return state.getData(nullptr, 0);
+}
+
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size)
+{
+	Serializer state;
+	if(!stateManager.saveState(state))
+		return 0;
+	return state.getData(buff, size);
+}
+
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size)
+{
+	Serializer state;
+	state.setData(buff, size);
 	if(!stateManager.loadState(state))
-	{
-		return STATE_RESULT_IO_ERROR;
-	}
+		return STATE_RESULT_INVALID_DATA;
 	updateSwitchValues();
 	return STATE_RESULT_OK;
 }
@@ -524,7 +534,10 @@ void EmuSystem::savePathChanged() { }
 namespace Base
 {
 
-void onAppMessage(int type, int shortArg, int intArg, int intArg2) { }
+void onAppMessage(int type, int shortArg, int intArg, int intArg2)
+{
+	EmuIoWorker::onAppMessage(type, shortArg, intArg, intArg2);
+}
 
 CallResult onInit(int argc, char** argv)
 {
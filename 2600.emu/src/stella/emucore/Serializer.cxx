@@ -223,3 +223,23 @@ void Serializer::putBool(bool b)
 {
   putByte(b ? TruePattern: FalsePattern);
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 Serializer::getData(uInt8* buffer, uInt32 size)
+{
+  uInt32 len = (uInt32)myStream->tellp();
+  if(!buffer)
+    return len;
+  if(len > size)
+    return 0;
+  myStream->seekg(ios_base::beg);
+  myStream->read((char*)buffer, len);
+  return len;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::setData(const uInt8* buffer, uInt32 size)
+{
+  ((stringstream*)myStream)->str(string((const char*)buffer, size));
+  reset();
+}
@@ -192,6 +192,24 @@ class Serializer
     */
     void putBool(bool b);
 
+    /**
+      Copies everything written so far to an in-memory stream.
+      With a NULL buffer only the size of the data is returned.
+
+      @param buffer The location to store the data
+      @param size   The size of the buffer
+      @result The number of bytes copied, or 0 if they don't fit
+    */
+    uInt32 getData(uInt8* buffer, uInt32 size);
+
+    /**
+      Replaces the contents of an in-memory stream and resets it for reading.
+
+      @param buffer The data to read from
+      @param size   The size of the data
+    */
+    void setData(const uInt8* buffer, uInt32 size);
+
   private:
     // The stream to send the serialized data to.
     iostream* myStream;
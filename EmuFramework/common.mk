@@ -4,6 +4,13 @@ endif
 
 emuFrameworkPath := $(currPath)
 
+ifdef EMU_BENCH
+ # headless benchmark, EmuBench.cc supplies main() & an audio sink
+ config_audioModule := none
+ configDefs += CONFIG_EMU_BENCH CONFIG_BASE_NO_MAIN CONFIG_AUDIO
+ targetExtension := -bench
+endif
+
 ifdef embedImagine
 
 ifneq ($(ENV), ps3)
@@ -19,6 +26,10 @@ include $(imagineSrcDir)/bluetooth/system.mk
 ifeq ($(ENV), android)
 include $(imagineSrcDir)/io/zip/build.mk
 endif
+# zip/7z through libarchive & the ROM cache, cores fall back to their own zip code without it
+ifdef config_ioArchive
+include $(imagineSrcDir)/io/archive/build.mk
+endif
 include $(imagineSrcDir)/gui/GuiTable1D/build.mk
 include $(imagineSrcDir)/gui/MenuItem/build.mk
 include $(imagineSrcDir)/gui/FSPicker/build.mk
@@ -49,7 +60,17 @@ SRC += CreditsView.cc MsgPopup.cc FilePicker.cc EmuSystem.cc Recent.cc \
 Screenshot.cc ButtonConfigView.cc VideoImageOverlay.cc \
 StateSlotView.cc MenuView.cc EmuInput.cc TextEntry.cc \
 TouchConfigView.cc EmuOptions.cc OptionView.cc EmuView.cc \
-ConfigFile.cc InputManagerView.cc
+ConfigFile.cc InputManagerView.cc EmuThread.cc EmuRewind.cc EmuRunAhead.cc EmuPacing.cc \
+EmuIoWorker.cc RomImage.cc EmuVideoFilter.cc EmuVideoFilterHQ2x.cc EmuVideoFilterHQ3x.cc
+
+ifdef EMU_BENCH
+SRC += EmuBench.cc
+endif
+
+ifdef FRAME_PROFILER
+include $(imagineSrcDir)/util/time/FrameProfiler.mk
+SRC += FrameProfileOverlay.cc
+endif
 
 ifneq ($(ENV), ps3)
 SRC += VController.cc
@@ -31,6 +31,9 @@
 #include <InputManagerView.hh>
 #include <EmuView.hh>
 #include <TextEntry.hh>
+#ifdef CONFIG_IO_ARCHIVE
+#include <io/archive/ArchiveCache.hh>
+#endif
 #include <libgen.h>
 
 #include <meta.h>
@@ -88,11 +91,6 @@ namespace Gfx
 void onViewChange(Gfx::GfxViewState * = 0);
 }
 
-#if !defined(CONFIG_AUDIO_ALSA) && !defined(CONFIG_AUDIO_SDL) && !defined(CONFIG_AUDIO_PS3)
-	// use WIP direct buffer write API
-	#define USE_NEW_AUDIO
-#endif
-
 // used on iOS to allow saves on incorrectly root-owned files/dirs
 void fixFilePermissions(const char *path)
 {
@@ -603,6 +601,7 @@ void onExit(bool backgrounded)
 	{
 		EmuSystem::saveAutoState();
 		EmuSystem::saveBackupMem();
+		EmuIoWorker::flush(); // the app may be killed while in the background
 		if(optionNotificationIcon)
 		{
 			char title[48];
@@ -613,6 +612,7 @@ void onExit(bool backgrounded)
 	else
 	{
 		EmuSystem::closeGame();
+		EmuVideoFilter::deinit();
 	}
 
 	saveConfigFile();
@@ -841,7 +841,9 @@ void EmuView::inputEvent(const Input::Event &e)
 					bcase guiKeyIdxSaveState:
 					if(e.state == Input::PUSHED)
 					{
+						EmuThread::lock();
 						int ret = EmuSystem::saveState();
+						EmuThread::unlock();
 						if(ret != STATE_RESULT_OK)
 						{
 							popup.postError(stateResultToStr(ret));
@@ -854,7 +856,9 @@ void EmuView::inputEvent(const Input::Event &e)
 					bcase guiKeyIdxLoadState:
 					if(e.state == Input::PUSHED)
 					{
+						EmuThread::lock();
 						int ret = EmuSystem::loadState();
+						EmuThread::unlock();
 						if(ret != STATE_RESULT_OK && ret != STATE_RESULT_OTHER_ERROR)
 						{
 							popup.postError(stateResultToStr(ret));
@@ -884,7 +888,9 @@ void EmuView::inputEvent(const Input::Event &e)
 					bcase guiKeyIdxGameScreenshot:
 					if(e.state == Input::PUSHED)
 					{
+						EmuThread::lock();
 						takeGameScreenshot();
+						EmuThread::unlock();
 						return;
 					}
 
@@ -900,6 +906,33 @@ void EmuView::inputEvent(const Input::Event &e)
 						return;
 					}
 
+					bcase guiKeyIdxRewind:
+					if(e.state == Input::PUSHED)
+					{
+						if(!optionRewindBufferSize)
+						{
+							popup.post("Rewind is disabled in System Options", 2);
+							return;
+						}
+						EmuThread::lock();
+						bool rewound = EmuRewind::stepBack();
+						EmuThread::unlock();
+						if(!rewound)
+						{
+							if(EmuRewind::isActive())
+								popup.post("Rewind history is empty", 2);
+							else
+								popup.postError("Rewind not available for this game", 2);
+						}
+						else
+						{
+							popup.printf(2, 0, "Rewind: %d steps left, %.1f/%dMB, %.2fms per frame",
+								EmuRewind::steps(), EmuRewind::memoryUsed() / (1024. * 1024.),
+								(int)optionRewindBufferSize, EmuRewind::captureSecsPerFrame() * 1000.);
+						}
+						return;
+					}
+
 					bdefault:
 					{
 						//logMsg("action %d, %d", emuKey, state);
@@ -917,7 +950,7 @@ void EmuView::inputEvent(const Input::Event &e)
 								turboActions.removeEvent(sysAction);
 							}
 						}
-						EmuSystem::handleInputAction(e.state, sysAction);
+						EmuThread::handleInputAction(e.state, sysAction);
 					}
 				}
 			}
@@ -929,9 +962,9 @@ void EmuView::inputEvent(const Input::Event &e)
 
 namespace Gfx
 {
-void onDraw()
+void onDraw(const Base::FrameTime &frameTime)
 {
-	emuView.draw();
+	emuView.draw(frameTime);
 	if(likely(EmuSystem::isActive()))
 	{
 		if(trackFPS)
@@ -1110,6 +1143,22 @@ static void mainInitCommon()
 
 	loadConfigFile();
 
+	FsSys::cPath cacheBasePath, cachePath;
+	#ifdef CONFIG_BASE_USES_SHARED_DOCUMENTS_DIR
+	string_printf(cacheBasePath, "%s/explusalpha.com", Base::documentsPath());
+	FsSys::mkdir(cacheBasePath);
+	#else
+	string_copy(cacheBasePath, Base::documentsPath());
+	#endif
+	#ifdef CONFIG_IO_ARCHIVE
+	string_printf(cachePath, "%s/romCache", cacheBasePath);
+	ArchiveCache::setPath(cachePath);
+	#endif
+	#ifdef CONFIG_FS_POSIX
+	string_printf(cachePath, "%s/dirIndex", cacheBasePath);
+	DirScanner::setIndexPath(cachePath);
+	#endif
+
 	#if defined (CONFIG_BASE_X11) || defined (CONFIG_BASE_ANDROID)
 		Base::setWindowPixelBestColorHint(optionBestColorModeHint);
 	#endif
@@ -1211,6 +1260,7 @@ static void mainInitWindowCommon(const Gfx::LGradientStopDesc (&navViewGrad)[NAV
 	#if defined CONFIG_BASE_ANDROID && defined CONFIG_GFX_OPENGL_USE_DRAW_TEXTURE
 	emuView.disp.flags = Gfx::Sprite::HINT_NO_MATRIX_TRANSFORM;
 	#endif
+	EmuVideoFilter::setFilter(optionVideoFilter);
 	emuView.vidImgOverlay.setEffect(optionOverlayEffect);
 	emuView.vidImgOverlay.intensity = optionOverlayEffectLevel/100.;
 
@@ -1218,6 +1268,9 @@ static void mainInitWindowCommon(const Gfx::LGradientStopDesc (&navViewGrad)[NAV
 		Base::setDPI(optionDPI);
 	setupFont();
 	popup.init();
+	#ifdef CONFIG_FRAME_PROFILER
+	emuView.profileOverlay.init();
+	#endif
 	#ifndef CONFIG_BASE_PS3
 	vController.init((int)optionTouchCtrlAlpha / 255.0, Gfx::xMMSize(int(optionTouchCtrlSize) / 100.));
 	updateVControlImg();
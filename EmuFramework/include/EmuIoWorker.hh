@@ -0,0 +1,48 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <engine-globals.h>
+#include <base/Base.hh>
+
+// Background thread for file writes that shouldn't stall emulation, like
+// auto-save states and battery saves. Each job owns a snapshot of its data,
+// which goes to a temporary file that's then renamed over the destination,
+// so an interrupted write never leaves a truncated file behind. Every
+// result is reported on the main thread through MSG_IO_RESULT.
+namespace EmuIoWorker
+{
+
+// app messages below this value are left to the emulator
+static const ushort MSG_IO_RESULT = Base::MSG_USER + 128;
+
+enum { FLAG_COMPRESS = BIT(0) }; // gzip the data
+enum { JOB_STATE, JOB_BACKUP_MEM };
+
+// queue data allocated with mem_alloc() to be written to path, the worker
+// takes ownership of it, returns false if the write couldn't be queued
+bool write(const char *path, uchar *data, uint size, uint type, uint flags = 0);
+
+// write from the calling thread, returns a STATE_RESULT_* value
+int writeNow(const char *path, const uchar *data, uint size, uint flags = 0);
+
+// wait for all queued writes to finish
+void flush();
+
+// handles MSG_IO_RESULT, returns false for any other message type
+bool onAppMessage(int type, int shortArg, int intArg, int intArg2);
+
+}
@@ -54,6 +54,7 @@ extern OptionBlueToothScanCache optionBlueToothScanCache;
 #endif
 
 extern Byte4s1Option optionImgFilter;
+extern Byte1Option optionVideoFilter;
 extern OptionAspectRatio optionAspectRatio;
 
 
@@ -88,6 +89,14 @@ extern Option2DOrigin optionTouchCtrlMenuPos;
 extern Option2DOrigin optionTouchCtrlFFPos;
 
 extern Byte1Option optionFrameSkip;
+extern Byte1Option optionEmuThread;
+extern Byte1Option optionRewindBufferSize;
+extern Byte1Option optionRewindInterval;
+extern Byte1Option optionRunAhead;
+extern Byte1Option optionFramePacing;
+#ifdef CONFIG_FRAME_PROFILER
+extern Byte1Option optionShowFrameProfile;
+#endif
 
 static const uint optionImageZoomIntegerOnly = 255;
 extern Byte1Option optionImageZoom;
@@ -0,0 +1,38 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#pragma once
+
+#include <engine-globals.h>
+#include <base/Base.hh>
+
+// Runs one emulated frame per display refresh and keeps audio in sync by
+// nudging EmuSystem::audioRateScale from the audio buffer's fill level.
+// Frames are only skipped when refreshes were missed and audio is running low.
+namespace EmuPacing
+{
+
+// restart measurements, call when emulation resumes
+void reset();
+
+// call once per display refresh with the timing passed to Gfx::onDraw(),
+// returns false if the display rate or audio backend can't be paced &
+// the wall-clock frame skip should be used
+bool setupFrameSkip(const Base::FrameTime &frameTime, uint &skip);
+
+// apply a new audio rate scale to the running system
+void setAudioRateScale(double scale);
+
+}
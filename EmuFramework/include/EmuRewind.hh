@@ -0,0 +1,42 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#pragma once
+
+#include <engine-globals.h>
+
+// Rewind history built from EmuSystem::saveStateToBuffer() snapshots. Only the
+// newest snapshot is kept whole, older ones are stored as XOR deltas
+// run-length encoded into a ring sized by optionRewindBufferSize.
+namespace EmuRewind
+{
+
+// call after emulating frames, captures a snapshot every optionRewindInterval frames
+void addFrames(uint frames);
+
+// restore the previous snapshot, returns false if the history is empty
+bool stepBack();
+
+// free all memory, history restarts on the next capture
+void reset();
+
+bool isActive();
+uint steps();
+uint memoryUsed();
+uint memoryBudget();
+// average time spent capturing per emulated frame
+double captureSecsPerFrame();
+
+}
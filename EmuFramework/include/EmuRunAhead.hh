@@ -0,0 +1,40 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#pragma once
+
+#include <engine-globals.h>
+
+// Hides a game's internal input lag by presenting the frame optionRunAhead
+// frames in the future, then restoring the real state from memory
+namespace EmuRunAhead
+{
+
+// runs the next rendered frame, same as EmuSystem::runFrame(1, 1, renderAudio)
+// if run-ahead is off or the system lacks in-memory states
+void runFrame(bool renderAudio);
+
+// free the state buffer & clear the measured overhead
+void reset();
+
+bool isActive();
+// returns true once after enough frames were measured to report the overhead
+bool takeReport();
+// average time spent per frame on saving, loading & emulating ahead
+double overheadSecsPerFrame();
+// average time of the real frame, for comparison
+double frameSecs();
+
+}
@@ -22,6 +22,16 @@
 #include <config/env.hh>
 #include <gui/FSPicker/FSPicker.hh>
 #include <util/gui/ViewStack.hh>
+#include <EmuThread.hh>
+#include <EmuRewind.hh>
+#include <EmuRunAhead.hh>
+#include <EmuPacing.hh>
+#include <EmuIoWorker.hh>
+
+#if !defined(CONFIG_AUDIO_ALSA) && !defined(CONFIG_AUDIO_SDL) && !defined(CONFIG_AUDIO_PS3)
+	// use WIP direct buffer write API
+	#define USE_NEW_AUDIO
+#endif
 
 extern BasicNavView viewNav;
 
@@ -40,6 +50,10 @@ class EmuSystem
 	static TimeSys startTime;
 	static int emuFrameNow;
 	static Audio::PcmFormat pcmFormat;
+	static uchar *stateArena;
+	static uint stateArenaSize;
+	// multiplier applied by configAudioRate() so audio output tracks the display rate
+	static double audioRateScale;
 	static const uint optionFrameSkipAuto;
 	static uint aspectRatioX, aspectRatioY;
 	static const uint maxPlayers;
@@ -49,6 +63,20 @@ class EmuSystem
 	static int loadState(int slot = saveStateSlot);
 	static int saveState();
 	static bool stateExists(int slot);
+	// in-memory states, 0 from stateBufferSize() means the system has no support,
+	// saveStateToBuffer() returns the bytes written or 0 on error
+	static uint stateBufferSize();
+	static uint saveStateToBuffer(uchar *buff, uint size);
+	static int loadStateFromBuffer(const uchar *buff, uint size);
+	// state files layered on the in-memory API, saves are staged in an arena
+	// kept between calls and released in closeGame(), an async save hands the
+	// arena to EmuIoWorker and returns once the state is captured
+	static int saveStateFile(const char *path, bool async = 0);
+	static int loadStateFile(const char *path);
+	static void freeStateArena();
+	// inflates a gzip stream, such as a compressed state file,
+	// returns a buffer to release with mem_free() or null on error
+	static uchar *gunzipState(const uchar *buff, uint size, uint &stateSize);
 	static const char *savePath() { return strlen(savePath_) ? savePath_ : gamePath; }
 	static void sprintStateFilename(char *str, size_t size, int slot,
 		const char *statePath = savePath(), const char *gameName = EmuSystem::gameName);
@@ -73,6 +101,9 @@ class EmuSystem
 	static void runFrame(bool renderGfx, bool processGfx, bool renderAudio) ATTRS(hot);
 	static bool vidSysIsPAL();
 	static void configAudioRate();
+	// applies a new audioRateScale to a running game, unlike configAudioRate()
+	// only the output rate may change so the sound hardware keeps its state
+	static void applyAudioRateScale();
 	static void clearInputBuffers();
 	static void handleInputAction(uint state, uint emuKey);
 	static uint translateInputAction(uint input, bool &turbo);
@@ -83,7 +114,13 @@ class EmuSystem
 	}
 	static void stopSound();
 	static void startSound();
-	static int setupFrameSkip(uint optionVal);
+	// for systems generating audio at a fixed rate, writeSound() converts it
+	// to pcmFormat.rate adjusted by audioRateScale, so configAudioRate() only
+	// needs to call setNativeSoundRate() again
+	static void setNativeSoundRate(double rate);
+	static void writeSound(const int16 *samples, uint frames);
+	// frameTime is the display timing passed to Gfx::onDraw()
+	static int setupFrameSkip(uint optionVal, const Base::FrameTime &frameTime);
 	static void setupGamePaths(const char *filePath);
 
 	static void clearGamePaths()
@@ -115,6 +152,7 @@ class EmuSystem
 	{
 		if(isActive())
 			state = State::PAUSED;
+		EmuThread::stop();
 		stopSound();
 		cancelAutoSaveStateTimer();
 	}
@@ -124,9 +162,11 @@ class EmuSystem
 		state = State::ACTIVE;
 		clearInputBuffers();
 		emuFrameNow = -1;
+		EmuPacing::reset();
 		startSound();
 		startTime.setTimeNow();
 		startAutoSaveStateTimer();
+		EmuThread::start();
 	}
 
 	static void closeSystem();
@@ -134,10 +174,15 @@ class EmuSystem
 	{
 		if(gameIsRunning())
 		{
+			EmuThread::stop();
+			EmuRewind::reset();
+			EmuRunAhead::reset();
 			if(allowAutosaveState)
 				saveAutoState();
 			logMsg("closing game %s", gameName);
 			closeSystem();
+			freeStateArena();
+			EmuIoWorker::flush();
 			clearGamePaths();
 			cancelAutoSaveStateTimer();
 			viewNav.setRightBtnActive(0);
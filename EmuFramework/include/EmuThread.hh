@@ -0,0 +1,53 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <engine-globals.h>
+#include <pixmap/Pixmap.hh>
+
+// Optional mode running EmuSystem::runFrame() on its own thread so a slow
+// frame doesn't stall the draw callback. Finished frames are passed
+// to the renderer through a lock-free triple buffer.
+namespace EmuThread
+{
+
+// main thread functions
+
+// starts the thread if optionEmuThread is set
+void start();
+void stop();
+bool isActive();
+
+// queue one rendered frame, preceded by skipFrames unrendered ones
+void requestFrames(uint skipFrames, bool skipAudio, bool renderAudio);
+
+// waits until the current frame completes & blocks further ones,
+// needed before touching emulation state from the main thread
+void lock();
+void unlock();
+
+// init pix with the newest committed frame, returns false if none arrived since last call
+bool takeFrame(Pixmap &pix);
+
+// calls EmuSystem::handleInputAction() directly, or queues it to run on
+// the emulation thread before its next frame so it can't race with the core
+void handleInputAction(uint state, uint emuKey);
+
+// emulation thread functions
+
+void commitFrame(const Pixmap &pix);
+
+}
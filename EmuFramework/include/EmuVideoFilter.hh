@@ -0,0 +1,44 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <engine-globals.h>
+#include <pixmap/Pixmap.hh>
+
+// Optional CPU scaler run on each frame before it's uploaded to the
+// video image. The frame is split into horizontal slices that are
+// filtered in parallel by a pool of worker threads & the calling thread.
+// Only RGB565 frames are filtered, others pass through unchanged.
+namespace EmuVideoFilter
+{
+
+enum { NONE, SCALE2X, HQ2X, HQ3X };
+static const uint MAX_VAL = HQ3X;
+
+void setFilter(uint filter);
+
+// returns the filtered frame, or pix itself if no filter applies to it,
+// must always be called from the same thread
+Pixmap &apply(Pixmap &pix);
+
+// returns the pixmap apply() fills for frames like pix, sized but not
+// filtered, to initialize the video image with
+Pixmap &outputPixmap(Pixmap &pix);
+
+// stops the worker threads & frees the output frame & tables
+void deinit();
+
+}
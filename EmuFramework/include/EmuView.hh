@@ -3,8 +3,11 @@
 #include <gfx/GfxSprite.hh>
 #include <gfx/GfxBufferImage.hh>
 #include <VideoImageOverlay.hh>
+#include <FrameProfileOverlay.hh>
 #include <gui/View.hh>
 #include <EmuOptions.hh>
+#include <EmuThread.hh>
+#include <EmuVideoFilter.hh>
 
 class EmuView : public View
 {
@@ -15,7 +18,13 @@ public:
 	Pixmap vidPix {PixelFormatRGB565};
 	Gfx::BufferImage vidImg;
 	VideoImageOverlay vidImgOverlay;
+	#ifdef CONFIG_FRAME_PROFILER
+	FrameProfileOverlay profileOverlay;
+	#endif
 	Area gameView;
+	// size of the frame vidImg was last initialized with, only touched by the main thread
+	// since vidPix belongs to the emulation thread while it's active
+	uint vidImgX = 0, vidImgY = 0;
 
 	void deinit() { }
 	Rect2<int> rect;
@@ -25,21 +34,40 @@ public:
 	void placeEmu(); // game content only
 	template <bool active>
 	void drawContent();
-	void runFrame();
-	void draw();
+	void runFrame(const Base::FrameTime &frameTime);
+	void presentThreadFrame();
+	void draw(const Base::FrameTime &frameTime);
+	void draw() { draw(Base::FrameTime()); }
 	void inputEvent(const Input::Event &e);
 
 	void placeOverlay()
 	{
-		vidImgOverlay.place(disp, vidPix.y);
+		vidImgOverlay.place(disp, vidImgY);
 	}
 
 	void updateAndDrawContent()
 	{
-		vidImg.write(vidPix);
+		#ifdef CONFIG_EMU_BENCH
+		return; // headless, the frame stays in vidPix
+		#endif
+		if(EmuThread::isActive())
+		{
+			// called from the emulation thread, presentThreadFrame() uploads it
+			EmuThread::commitFrame(vidPix);
+			return;
+		}
+		vidImg.write(EmuVideoFilter::apply(vidPix));
 		drawContent<1>();
 	}
 
+	void initVidImg(Pixmap &pix)
+	{
+		vidImg.init(EmuVideoFilter::outputPixmap(pix), 0, optionImgFilter);
+		disp.setImg(&vidImg);
+		vidImgX = pix.x;
+		vidImgY = pix.y;
+	}
+
 	void initPixmap(uchar *pixBuff, const PixelFormatDesc *format, uint x, uint y, uint extraPitch = 0)
 	{
 		new(&vidPix) Pixmap(*format);
@@ -49,8 +77,7 @@ public:
 
 	void reinitImage()
 	{
-		vidImg.init(vidPix, 0, optionImgFilter);
-		disp.setImg(&vidImg);
+		initVidImg(vidPix);
 	}
 
 	void resizeImage(uint x, uint y, uint extraPitch = 0)
@@ -64,8 +91,12 @@ public:
 		basePix.init(pixBuff, totalX, totalY, extraPitch);
 		vidPix.initSubPixmap(basePix, xO, yO, x, y);
 		logMsg("using %d:%d:%d:%d region of %d,%d pixmap for EmuView", xO, yO, x, y, totalX, totalY);
-		vidImg.init(vidPix, 0, optionImgFilter);
-		disp.setImg(&vidImg);
+		#ifdef CONFIG_EMU_BENCH
+		return;
+		#endif
+		if(EmuThread::isActive())
+			return; // the new size travels with the committed frame, presentThreadFrame() resizes vidImg
+		initVidImg(vidPix);
 		if((uint)optionImageZoom == optionImageZoomIntegerOnly)
 			placeEmu();
 	}
@@ -44,6 +44,7 @@ class OptionView : public BaseMenuView
 {
 protected:
 	BoolMenuItem snd {"Sound"};
+	BoolMenuItem framePacing {"Sync Frames To Audio"};
 
 	#ifdef CONFIG_AUDIO_OPENSL_ES
 	BoolMenuItem sndUnderrunCheck {"Strict Underrun Check"};
@@ -116,6 +117,25 @@ protected:
 
 	BoolMenuItem confirmOverwriteState {"Confirm Overwrite State"};
 
+	BoolMenuItem emuThread {"Emulation Thread"};
+
+	MultiChoiceSelectMenuItem rewindBufferSize {"Rewind Buffer"};
+
+	void rewindBufferSizeInit();
+
+	MultiChoiceSelectMenuItem rewindInterval {"Rewind Interval"};
+
+	void rewindIntervalInit();
+
+	MultiChoiceSelectMenuItem runAhead {"Run-ahead"};
+
+	void runAheadInit();
+
+	#ifdef CONFIG_FRAME_PROFILER
+	BoolMenuItem showFrameProfile {"Show Frame Profile"};
+	TextMenuItem saveFrameProfile {"Save Frame Profile"};
+	#endif
+
 #if defined (CONFIG_BASE_X11) || defined (CONFIG_BASE_ANDROID)
 	BoolMenuItem bestColorModeHint {"Use Highest Color Mode"};
 	void bestColorModeHintHandler(BoolMenuItem &item, const Input::Event &e);
@@ -168,6 +188,10 @@ protected:
 
 	void imgFilterInit();
 
+	MultiChoiceSelectMenuItem videoFilter {"Image Scaler"};
+
+	void videoFilterInit();
+
 	MultiChoiceSelectMenuItem overlayEffect {"Overlay Effect"};
 
 	void overlayEffectInit();
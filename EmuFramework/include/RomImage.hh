@@ -0,0 +1,58 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <engine-globals.h>
+#include <util/bits.h>
+#include <io/archive/IoArchive.hh>
+
+// ROM file contents handed to a core. Uncompressed files are mapped
+// read-only so loading costs no copy and pages are only read in as they're
+// used. Cores that patch the ROM in place pass FLAG_WRITABLE to get a
+// copy-on-write mapping, where only modified pages take private memory.
+// Archives are opened through ArchiveCache when CONFIG_IO_ARCHIVE is set,
+// otherwise cores read them with their own code into allocate().
+class RomImage
+{
+public:
+	enum { FLAG_WRITABLE = BIT(0) };
+
+	constexpr RomImage() { }
+	~RomImage() { close(); }
+
+	// opens path, or the first file accepted by filter if path is an archive,
+	// the image is zero-padded to at least minSize bytes, filterId keys the
+	// extracted file in ArchiveCache
+	bool open(const char *path, IoArchive::EntryFilter filter, const char *filterId,
+		uint flags = 0, size_t minSize = 0, char *nameOut = nullptr, uint nameOutSize = 0);
+	void close();
+	// returns a writable, zero-padded image of size bytes for the core to fill
+	uchar *allocate(size_t size, size_t minSize = 0);
+
+	const uchar *data() const { return data_; }
+	uchar *writableData() const { assert(writable); return data_; }
+	// size of the file itself, excluding any padding
+	size_t size() const { return size_; }
+
+private:
+	Io *io = nullptr; // set when data_ points into a read-only Io
+	uchar *data_ = nullptr;
+	size_t size_ = 0, mapSize = 0;
+	bool writable = 0;
+
+	bool mapFile(const char *path, size_t minSize);
+	bool copyIo(Io *io, size_t minSize);
+};
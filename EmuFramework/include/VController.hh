@@ -477,13 +477,13 @@ public:
 		if(kbMode)
 		{
 			assert(vBtn < sizeofArray(kbMap));
-			EmuSystem::handleInputAction(action, kbMap[vBtn]);
+			EmuThread::handleInputAction(action, kbMap[vBtn]);
 		}
 		else
 		#endif
 		{
 			assert(vBtn < sizeofArray(map));
-			EmuSystem::handleInputAction(action, map[vBtn]);
+			EmuThread::handleInputAction(action, map[vBtn]);
 		}
 	}
 
@@ -648,12 +648,15 @@ public:
 		setBlendMode(BLEND_MODE_ALPHA);
 		setColor(1., 1., 1., alpha);
 
+		// on-screen controls don't overlap, let their sprites batch by texture
+		beginUnorderedDraws();
 		#ifdef CONFIG_VCONTROLLER_KEYBOARD
 		if(kbMode)
 			kb.draw();
 		else
 		#endif
 		gp.draw();
+		endUnorderedDraws();
 	}
 };
 
@@ -186,6 +186,14 @@ static bool readConfig2(Io *io)
 			bcase CFGKEY_AUTO_SAVE_STATE: optionAutoSaveState.readFromIO(io, size);
 			bcase CFGKEY_CONFIRM_AUTO_LOAD_STATE: optionConfirmAutoLoadState.readFromIO(io, size);
 			bcase CFGKEY_FRAME_SKIP: optionFrameSkip.readFromIO(io, size);
+			bcase CFGKEY_EMU_THREAD: optionEmuThread.readFromIO(io, size);
+			bcase CFGKEY_REWIND_BUFFER_SIZE: optionRewindBufferSize.readFromIO(io, size);
+			bcase CFGKEY_REWIND_INTERVAL: optionRewindInterval.readFromIO(io, size);
+			bcase CFGKEY_RUN_AHEAD: optionRunAhead.readFromIO(io, size);
+			bcase CFGKEY_FRAME_PACING: optionFramePacing.readFromIO(io, size);
+			#ifdef CONFIG_FRAME_PROFILER
+			bcase CFGKEY_SHOW_FRAME_PROFILE: optionShowFrameProfile.readFromIO(io, size);
+			#endif
 			#if defined(CONFIG_BASE_ANDROID)
 			bcase CFGKEY_DITHER_IMAGE: optionDitherImage.readFromIO(io, size);
 			#endif
@@ -205,6 +213,7 @@ static bool readConfig2(Io *io)
 			bcase CFGKEY_GAME_ORIENTATION: optionGameOrientation.readFromIO(io, size);
 			bcase CFGKEY_MENU_ORIENTATION: optionMenuOrientation.readFromIO(io, size);
 			bcase CFGKEY_GAME_IMG_FILTER: optionImgFilter.readFromIO(io, size);
+			bcase CFGKEY_VIDEO_FILTER: optionVideoFilter.readFromIO(io, size);
 			bcase CFGKEY_GAME_ASPECT_RATIO: optionAspectRatio.readFromIO(io, size);
 			bcase CFGKEY_IMAGE_ZOOM: optionImageZoom.readFromIO(io, size);
 			bcase CFGKEY_DPI: optionDPI.readFromIO(io, size);
@@ -409,6 +418,7 @@ static OptionBase *cfgFileOption[] =
 	&optionAspectRatio,
 	&optionImageZoom,
 	&optionImgFilter,
+	&optionVideoFilter,
 	&optionOverlayEffect,
 	&optionOverlayEffectLevel,
 	&optionRelPointerDecel,
@@ -443,6 +453,14 @@ static OptionBase *cfgFileOption[] =
 	&optionUseOSInputMethod,
 	#endif
 	&optionFrameSkip,
+	&optionEmuThread,
+	&optionRewindBufferSize,
+	&optionRewindInterval,
+	&optionRunAhead,
+	&optionFramePacing,
+	#ifdef CONFIG_FRAME_PROFILER
+	&optionShowFrameProfile,
+	#endif
 	&optionDPI,
 	&optionVibrateOnPush,
 	&optionRecentGames,
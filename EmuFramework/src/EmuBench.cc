@@ -0,0 +1,223 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+// Headless benchmark, built by the *-bench.mk targets in place of the
+// platform main(). Runs a game without a window, GL context, or audio device
+// and reports frame timing plus hashes of the final video & audio output.
+
+#define thisModuleName "bench"
+#include <EmuSystem.hh>
+#include <EmuView.hh>
+#include <audio/Audio.hh>
+#include <base/Base.hh>
+#include <util/time/sys.hh>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+extern EmuView emuView;
+
+static const uint64 fnvOffset = 0xcbf29ce484222325ULL;
+static const uint64 fnvPrime = 0x100000001b3ULL;
+
+static uint64 fnv1a(uint64 hash, const uchar *data, uint size)
+{
+	iterateTimes(size, i)
+	{
+		hash = (hash ^ data[i]) * fnvPrime;
+	}
+	return hash;
+}
+
+static uint64 audioHash = fnvOffset;
+static uint64 audioFrames = 0;
+
+// audio sink replacing the platform backend, hashes everything written to it
+namespace Audio
+{
+
+PcmFormat preferredPcmFormat = maxFormat;
+PcmFormat pcmFormat = maxFormat;
+static bool pcmOpen = 0;
+static BufferContext playBuffer;
+static uchar playBufferData[maxRate * 4 * 2];
+
+CallResult init() { return OK; }
+
+CallResult openPcm(const PcmFormat &format)
+{
+	pcmFormat = format;
+	pcmOpen = 1;
+	return OK;
+}
+
+void closePcm() { pcmOpen = 0; }
+bool isOpen() { return pcmOpen; }
+
+void writePcm(uchar *samples, uint framesToWrite)
+{
+	audioHash = fnv1a(audioHash, samples, pcmFormat.framesToBytes(framesToWrite));
+	audioFrames += framesToWrite;
+}
+
+BufferContext *getPlayBuffer(uint wantedFrames)
+{
+	playBuffer.data = playBufferData;
+	playBuffer.frames = IG::min(wantedFrames, (uint)sizeof(playBufferData) / pcmFormat.framesToBytes(1));
+	return &playBuffer;
+}
+
+void commitPlayBuffer(BufferContext *buffer, uint frames)
+{
+	writePcm((uchar*)buffer->data, frames);
+}
+
+int frameDelay() { return 0; }
+int framesFree() { return pcmFormat.rate; }
+void setHintPcmFramesPerWrite(uint frames) { }
+void setHintPcmMaxBuffers(uint buffers) { }
+uint hintPcmMaxBuffers() { return 0; }
+void setHintStrictUnderrunCheck(bool on) { }
+bool hintStrictUnderrunCheck() { return 0; }
+
+}
+
+static uint64 videoHash()
+{
+	auto &pix = emuView.vidPix;
+	uint64 hash = fnvOffset;
+	iterateTimes(pix.y, y)
+	{
+		hash = fnv1a(hash, &pix.data[y * pix.pitch], pix.sizeOfNumPixels(pix.x));
+	}
+	return hash;
+}
+
+static int compareDouble(const void *a, const void *b)
+{
+	double x = *(const double*)a, y = *(const double*)b;
+	return x < y ? -1 : x > y;
+}
+
+static double percentile(const double *sorted, uint count, uint pct)
+{
+	return sorted[IG::min(count - 1, (count * pct) / 100)];
+}
+
+static void printUsage(const char *exec)
+{
+	fprintf(stderr, "usage: %s [-frames N] [-state SLOT|auto] ROM\n", exec);
+}
+
+int main(int argc, char** argv)
+{
+	logger_init();
+
+	uint frames = 1800;
+	int stateSlot = INT_MIN;
+	const char *romArg = nullptr;
+	for(int i = 1; i < argc; i++)
+	{
+		if(string_equal(argv[i], "-frames") && i + 1 < argc)
+		{
+			frames = atoi(argv[++i]);
+		}
+		else if(string_equal(argv[i], "-state") && i + 1 < argc)
+		{
+			i++;
+			stateSlot = string_equal(argv[i], "auto") ? -1 : atoi(argv[i]);
+		}
+		else if(argv[i][0] != '-' && !romArg)
+		{
+			romArg = argv[i];
+		}
+		else
+		{
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+	if(!romArg || !frames || (stateSlot != INT_MIN && (stateSlot < -1 || stateSlot > 9)))
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	// resolve the ROM before the working directory moves to the app's
+	char romPath[PATH_MAX];
+	if(!realpath(romArg, romPath))
+	{
+		fprintf(stderr, "can't open %s\n", romArg);
+		return 1;
+	}
+	#ifdef CONFIG_FS
+	FsSys::changeToAppDir(argv[0]);
+	#endif
+
+	if(Base::onInit(argc, argv) != OK)
+	{
+		fprintf(stderr, "error initializing\n");
+		return 1;
+	}
+	EmuSystem::configAudioRate();
+	Audio::openPcm(EmuSystem::pcmFormat);
+
+	if(EmuSystem::loadGame(romPath) != 1)
+	{
+		fprintf(stderr, "error loading %s\n", romPath);
+		return 1;
+	}
+	if(stateSlot != INT_MIN)
+	{
+		int ret = EmuSystem::loadState(stateSlot);
+		if(ret != STATE_RESULT_OK)
+		{
+			fprintf(stderr, "error loading state %s: %s\n", stateNameStr(stateSlot),
+				ret == STATE_RESULT_OTHER_ERROR ? "Unknown Error" : stateResultToStr(ret));
+			return 1;
+		}
+	}
+
+	auto frameSecs = (double*)mem_alloc(frames * sizeof(double));
+	if(!frameSecs)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	TimeSys start, end;
+	start.setTimeNow();
+	TimeSys frameStart = start;
+	iterateTimes(frames, i)
+	{
+		EmuSystem::runFrame(1, 1, 1);
+		TimeSys frameEnd;
+		frameEnd.setTimeNow();
+		frameSecs[i] = double(frameEnd - frameStart);
+		frameStart = frameEnd;
+	}
+	end = frameStart;
+	double totalSecs = double(end - start);
+
+	qsort(frameSecs, frames, sizeof(double), compareDouble);
+	printf("game: %s\n", EmuSystem::fullGameName);
+	printf("frames: %u in %.3fs, %.2f fps\n", frames, totalSecs, frames / totalSecs);
+	printf("frame ms: min %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n",
+		frameSecs[0] * 1000., percentile(frameSecs, frames, 50) * 1000., percentile(frameSecs, frames, 90) * 1000.,
+		percentile(frameSecs, frames, 99) * 1000., frameSecs[frames - 1] * 1000.);
+	printf("video: %ux%u hash %016llx\n", emuView.vidPix.x, emuView.vidPix.y, (unsigned long long)videoHash());
+	printf("audio: %llu frames hash %016llx\n", (unsigned long long)audioFrames, (unsigned long long)audioHash);
+	mem_free(frameSecs);
+	return 0;
+}
@@ -0,0 +1,226 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "emuIoWorker"
+#include <EmuIoWorker.hh>
+#include <EmuSystem.hh>
+#include <MsgPopup.hh>
+#include <io/sys.hh>
+#include <util/strings.h>
+#include <util/thread/pthread.hh>
+#include <zlib.h>
+
+extern MsgPopup popup;
+
+namespace EmuIoWorker
+{
+
+struct Job
+{
+	constexpr Job() { }
+	FsSys::cPath path {0};
+	uchar *data = nullptr;
+	uint size = 0, type = 0, flags = 0;
+};
+
+static const uint maxJobs = 4;
+
+static ThreadPThread thread;
+static MutexPThread mutex;
+static CondVarPThread requestCond, doneCond;
+static bool running = 0;
+
+// guarded by mutex, busy counts queued jobs plus the one being written
+static Job job[maxJobs];
+static uint jobs = 0, busy = 0;
+
+static uchar *gzip(const uchar *data, uint size, uint &gzSize)
+{
+	z_stream zs {0};
+	if(deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return nullptr;
+	uint bound = deflateBound(&zs, size) + 18; // allow for the gzip header and trailer
+	auto out = (uchar*)mem_alloc(bound);
+	if(!out)
+	{
+		deflateEnd(&zs);
+		return nullptr;
+	}
+	zs.next_in = (Bytef*)data;
+	zs.avail_in = size;
+	zs.next_out = out;
+	zs.avail_out = bound;
+	bool deflated = deflate(&zs, Z_FINISH) == Z_STREAM_END;
+	gzSize = zs.total_out;
+	deflateEnd(&zs);
+	if(!deflated)
+	{
+		logErr("error compressing %d bytes", size);
+		mem_free(out);
+		return nullptr;
+	}
+	return out;
+}
+
+static int resultFromCall(CallResult ret)
+{
+	switch(ret)
+	{
+		case OK: return STATE_RESULT_OK;
+		case PERMISSION_DENIED: return STATE_RESULT_NO_FILE_ACCESS;
+		default: return STATE_RESULT_IO_ERROR;
+	}
+}
+
+int writeNow(const char *path, const uchar *data, uint size, uint flags)
+{
+	uchar *gzData = nullptr;
+	if(flags & FLAG_COMPRESS)
+	{
+		uint gzSize;
+		gzData = gzip(data, size, gzSize);
+		if(!gzData)
+			return STATE_RESULT_OTHER_ERROR;
+		logMsg("compressed %d bytes to %d", size, gzSize);
+		data = gzData;
+		size = gzSize;
+	}
+	// write to a temporary file first so the old file survives a failed write
+	FsSys::cPath tempPath;
+	string_printf(tempPath, "%s.tmp", path);
+	CallResult ret = IoSys::writeToNewFile(tempPath, (void*)data, size);
+	if(gzData)
+		mem_free(gzData);
+	if(ret != OK)
+	{
+		logErr("error writing %s", tempPath);
+		FsSys::remove(tempPath);
+		return resultFromCall(ret);
+	}
+	ret = FsSys::rename(tempPath, path);
+	if(ret != OK)
+	{
+		FsSys::remove(tempPath);
+		return resultFromCall(ret);
+	}
+	return STATE_RESULT_OK;
+}
+
+static ptrsize runWorker(ThreadPThread &thread)
+{
+	logMsg("I/O worker running");
+	for(;;)
+	{
+		mutex.lock();
+		while(!jobs)
+			requestCond.wait(&mutex);
+		Job j = job[0];
+		iterateTimes(jobs - 1, i)
+		{
+			job[i] = job[i + 1];
+		}
+		jobs--;
+		mutex.unlock();
+
+		int result = writeNow(j.path, j.data, j.size, j.flags);
+		mem_free(j.data);
+		Base::sendMessageToMain(thread, MSG_IO_RESULT, j.type, result, 0);
+
+		mutex.lock();
+		busy--;
+		doneCond.broadcast();
+		mutex.unlock();
+	}
+	return 0;
+}
+
+static bool start()
+{
+	if(running)
+		return 1;
+	mutex.create();
+	requestCond.create(&mutex);
+	doneCond.create(&mutex);
+	if(!thread.create(1, ThreadPThread::EntryDelegate::create<&runWorker>()))
+	{
+		logErr("unable to create I/O worker thread");
+		return 0;
+	}
+	running = 1;
+	return 1;
+}
+
+bool write(const char *path, uchar *data, uint size, uint type, uint flags)
+{
+	if(!start())
+	{
+		mem_free(data);
+		return 0;
+	}
+	mutex.lock();
+	// a newer snapshot for a path still in the queue replaces the older one
+	iterateTimes(jobs, i)
+	{
+		if(string_equal(job[i].path, path))
+		{
+			mem_free(job[i].data);
+			job[i].data = data;
+			job[i].size = size;
+			job[i].flags = flags;
+			mutex.unlock();
+			return 1;
+		}
+	}
+	while(jobs == maxJobs)
+		doneCond.wait(&mutex);
+	auto &j = job[jobs];
+	string_copy(j.path, path);
+	j.data = data;
+	j.size = size;
+	j.type = type;
+	j.flags = flags;
+	jobs++;
+	busy++;
+	requestCond.signal();
+	mutex.unlock();
+	return 1;
+}
+
+void flush()
+{
+	if(!running)
+		return;
+	mutex.lock();
+	while(busy)
+		doneCond.wait(&mutex);
+	mutex.unlock();
+}
+
+bool onAppMessage(int type, int shortArg, int intArg, int intArg2)
+{
+	if(type != MSG_IO_RESULT)
+		return 0;
+	// queued writes are auto-saves, only failures need the user's attention
+	if(intArg == STATE_RESULT_OK)
+	{
+		logMsg("finished writing %s", shortArg == JOB_STATE ? "state" : "backup memory");
+		return 1;
+	}
+	popup.printf(3, 1, "Error saving %s: %s", shortArg == JOB_STATE ? "state" : "backup memory",
+		stateResultToStr(intArg));
+	return 1;
+}
+
+}
@@ -1,6 +1,7 @@
 #include <EmuOptions.hh>
 #include <EmuSystem.hh>
 #include "VController.hh"
+#include <EmuVideoFilter.hh>
 extern SysVController vController;
 
 bool optionOrientationIsValid(uint32 val)
@@ -61,6 +62,7 @@ OptionBlueToothScanCache optionBlueToothScanCache(CFGKEY_BLUETOOTH_SCAN_CACHE, 1
 OptionAspectRatio optionAspectRatio(0);
 
 Byte4s1Option optionImgFilter(CFGKEY_GAME_IMG_FILTER, Gfx::BufferImage::linear, 0, Gfx::BufferImage::isFilterValid);
+Byte1Option optionVideoFilter(CFGKEY_VIDEO_FILTER, EmuVideoFilter::NONE, 0, optionIsValidWithMax<EmuVideoFilter::MAX_VAL>);
 
 Byte1Option optionOverlayEffect(CFGKEY_OVERLAY_EFFECT, 0, 0, optionIsValidWithMax<VideoImageOverlay::MAX_EFFECT_VAL>);
 Byte1Option optionOverlayEffectLevel(CFGKEY_OVERLAY_EFFECT_LEVEL, 25, 0, optionIsValidWithMax<100>);
@@ -161,6 +163,15 @@ Byte1Option optionFrameSkip
 		#endif
 		Config::envIsPS3, optionFrameSkipIsValid);
 
+Byte1Option optionEmuThread(CFGKEY_EMU_THREAD, 0);
+Byte1Option optionRewindBufferSize(CFGKEY_REWIND_BUFFER_SIZE, 0, 0, optionIsValidWithMax<64>); // in MB, 0 disables
+Byte1Option optionRewindInterval(CFGKEY_REWIND_INTERVAL, 10, 0, optionIsValidWithMinMax<1, 60>);
+Byte1Option optionRunAhead(CFGKEY_RUN_AHEAD, 0, 0, optionIsValidWithMax<4>);
+Byte1Option optionFramePacing(CFGKEY_FRAME_PACING, 1);
+#ifdef CONFIG_FRAME_PROFILER
+Byte1Option optionShowFrameProfile(CFGKEY_SHOW_FRAME_PROFILE, 0);
+#endif
+
 bool optionImageZoomIsValid(uint8 val)
 {
 	return val == optionImageZoomIntegerOnly || val <= 100;
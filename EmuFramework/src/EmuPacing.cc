@@ -0,0 +1,116 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "pacing"
+#include <EmuPacing.hh>
+#include <EmuSystem.hh>
+#include <EmuOptions.hh>
+#include <audio/Audio.hh>
+#include <base/Base.hh>
+#include <math.h>
+
+namespace EmuPacing
+{
+
+static const double maxRateAdjust = .005; // furthest the buffer level can pull the audio rate
+static const double minRateChange = .001; // smaller changes aren't worth updating the system's audio rate
+static const double maxRefreshDeviation = .05;
+static const double starvedFill = .25;
+static const uint rateUpdateFrames = 60;
+static const uint maxFrameSkip = 6;
+
+static bool resumed = 1;
+static double refreshSecs = 1. / 60.; // display refresh period
+static int capacityFrames = 0; // largest free space seen in the audio buffer
+static double fill = .5; // averaged audio buffer fill level
+static uint framesUntilRateUpdate = rateUpdateFrames;
+
+static double systemFrameSecs()
+{
+	return EmuSystem::vidSysIsPAL() ? 1. / 50. : 1. / 60.;
+}
+
+void setAudioRateScale(double scale)
+{
+	if(scale == EmuSystem::audioRateScale)
+		return;
+	EmuThread::lock();
+	EmuSystem::audioRateScale = scale;
+	if(EmuSystem::gameIsRunning())
+		EmuSystem::applyAudioRateScale();
+	EmuThread::unlock();
+}
+
+static void updateRateScale()
+{
+	// match the display rate, then lean on the buffer level to cancel any remaining drift
+	double scale = (refreshSecs / systemFrameSecs()) * (1. + maxRateAdjust * (1. - 2. * fill));
+	if(fabs(scale - EmuSystem::audioRateScale) < minRateChange)
+		return;
+	logMsg("audio rate scale %f, buffer %d%% full, refresh %.3fHz", scale, int(fill * 100.), 1. / refreshSecs);
+	setAudioRateScale(scale);
+}
+
+void reset()
+{
+	resumed = 1;
+	capacityFrames = 0;
+	fill = .5;
+	framesUntilRateUpdate = rateUpdateFrames;
+}
+
+bool setupFrameSkip(const Base::FrameTime &frameTime, uint &skip)
+{
+	if(!optionFramePacing || !optionSound || !Audio::isOpen() || !frameTime.refreshes)
+		return 0;
+	int framesFree = Audio::framesFree();
+	if(framesFree <= 0 && !capacityFrames)
+		return 0; // backend doesn't report its buffer level
+	capacityFrames = IG::max(capacityFrames, framesFree);
+	double currFill = 1. - double(framesFree) / capacityFrames;
+	fill += (currFill - fill) * .05;
+
+	skip = 0;
+	refreshSecs = frameTime.interval;
+	if(resumed)
+	{
+		// refreshes counted while paused aren't missed frames
+		resumed = 0;
+		return 1;
+	}
+	if(fabs(refreshSecs / systemFrameSecs() - 1.) > maxRefreshDeviation)
+	{
+		setAudioRateScale(1.);
+		return 0;
+	}
+
+	if(currFill < starvedFill)
+	{
+		// refreshes were missed and audio is draining, catch up
+		if(frameTime.refreshes > 1)
+		{
+			skip = IG::min(frameTime.refreshes - 1, maxFrameSkip);
+			logMsg("skipping %u frames, buffer %d%% full", skip, int(currFill * 100.));
+		}
+	}
+	if(!--framesUntilRateUpdate)
+	{
+		framesUntilRateUpdate = rateUpdateFrames;
+		updateRateScale();
+	}
+	return 1;
+}
+
+}
@@ -0,0 +1,277 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "rewind"
+#include <EmuRewind.hh>
+#include <EmuSystem.hh>
+#include <EmuOptions.hh>
+#include <util/time/sys.hh>
+
+namespace EmuRewind
+{
+
+struct Entry
+{
+	uint offset, size;
+};
+
+static const uint maxEntries = 4096;
+static const uint maxRunWords = 0xFFFF;
+
+// newest snapshot & scratch space for the next one, both zero-padded past their contents
+static uchar *stateBuff = nullptr, *nextStateBuff = nullptr;
+static uint stateBuffSize = 0, stateSize = 0, stateHighWater = 0;
+static uint32 *deltaBuff = nullptr;
+static uint deltaBuffSize = 0;
+
+static uchar *ring = nullptr;
+static uint ringSize = 0, ringHead = 0, ringUsed = 0;
+static Entry *entry = nullptr;
+static uint entryStart = 0, entryCount = 0;
+
+static uint framesSinceCapture = 0;
+static bool unsupported = 0;
+static double captureSecs = 0;
+static uint capturedFrames = 0;
+
+static uint roundUpWords(uint bytes) { return (bytes + 3) / 4; }
+
+// Encodes older ^ newer as runs of (unchanged words | changed words << 16)
+// followed by the changed words XORed, returns the encoded size in words
+static uint encodeDelta(const uint32 *older, const uint32 *newer, uint words, uint32 *out)
+{
+	uint32 *o = out;
+	uint i = 0;
+	while(i < words)
+	{
+		uint skip = 0;
+		while(i < words && older[i] == newer[i] && skip < maxRunWords)
+		{
+			i++;
+			skip++;
+		}
+		uint copy = 0;
+		while(i + copy < words && older[i + copy] != newer[i + copy] && copy < maxRunWords)
+			copy++;
+		*o++ = skip | (copy << 16);
+		iterateTimes(copy, c)
+		{
+			*o++ = older[i + c] ^ newer[i + c];
+		}
+		i += copy;
+	}
+	return o - out;
+}
+
+static void applyDelta(uint32 *state, const uint32 *delta, uint deltaWords)
+{
+	const uint32 *end = delta + deltaWords;
+	uint i = 0;
+	while(delta < end)
+	{
+		uint skip = *delta & 0xFFFF, copy = *delta >> 16;
+		delta++;
+		i += skip;
+		iterateTimes(copy, c)
+		{
+			state[i + c] ^= delta[c];
+		}
+		delta += copy;
+		i += copy;
+	}
+}
+
+static Entry &oldestEntry() { return entry[entryStart]; }
+static Entry &newestEntry() { return entry[(entryStart + entryCount - 1) % maxEntries]; }
+
+static void popOldestEntry()
+{
+	ringUsed -= oldestEntry().size;
+	entryStart = (entryStart + 1) % maxEntries;
+	entryCount--;
+}
+
+static bool init()
+{
+	uint maxStateSize = EmuSystem::stateBufferSize();
+	if(!maxStateSize)
+	{
+		logMsg("system doesn't support in-memory states");
+		unsupported = 1;
+		return 0;
+	}
+	stateBuffSize = roundUpWords(maxStateSize) * 4;
+	// worst case is one run header per changed word pair, plus the size header
+	deltaBuffSize = stateBuffSize + (roundUpWords(stateBuffSize) / maxRunWords + 2) * 4;
+	uint fixedSize = stateBuffSize * 2 + deltaBuffSize + maxEntries * sizeof(Entry);
+	if(memoryBudget() <= fixedSize + deltaBuffSize)
+	{
+		logMsg("budget of %d bytes too small for %d byte states", memoryBudget(), maxStateSize);
+		unsupported = 1;
+		return 0;
+	}
+	ringSize = memoryBudget() - fixedSize;
+	stateBuff = (uchar*)mem_calloc(stateBuffSize);
+	nextStateBuff = (uchar*)mem_calloc(stateBuffSize);
+	deltaBuff = (uint32*)mem_alloc(deltaBuffSize);
+	ring = (uchar*)mem_alloc(ringSize);
+	entry = (Entry*)mem_alloc(maxEntries * sizeof(Entry));
+	if(!stateBuff || !nextStateBuff || !deltaBuff || !ring || !entry)
+	{
+		logErr("out of memory allocating rewind buffers");
+		reset();
+		unsupported = 1;
+		return 0;
+	}
+	logMsg("using %d bytes for up to %d byte states, %d bytes for deltas", memoryBudget(), maxStateSize, ringSize);
+	return 1;
+}
+
+static void storeEntry(const uchar *data, uint size)
+{
+	if(size > ringSize)
+	{
+		logMsg("%d byte delta doesn't fit in ring", size);
+		return;
+	}
+	if(entryCount == maxEntries)
+		popOldestEntry();
+	if(ringHead + size > ringSize)
+	{
+		// wrap around, anything past the head is older than what's at the start
+		while(entryCount && oldestEntry().offset >= ringHead)
+			popOldestEntry();
+		ringHead = 0;
+	}
+	while(entryCount && oldestEntry().offset >= ringHead && oldestEntry().offset < ringHead + size)
+		popOldestEntry();
+	memcpy(&ring[ringHead], data, size);
+	entry[(entryStart + entryCount) % maxEntries] = { ringHead, size };
+	entryCount++;
+	ringHead += size;
+	ringUsed += size;
+}
+
+static void capture()
+{
+	if(!ring && (unsupported || !init()))
+		return;
+	TimeSys begin;
+	begin.setTimeNow();
+	uint size = EmuSystem::saveStateToBuffer(nextStateBuff, stateBuffSize);
+	if(!size)
+	{
+		logErr("error capturing state");
+		return;
+	}
+	// clear anything left from a larger state so padding compares equal
+	uint words = roundUpWords(IG::max(size, stateSize));
+	if(stateHighWater > size)
+		mem_zero(&nextStateBuff[size], roundUpWords(stateHighWater) * 4 - size);
+	stateHighWater = IG::max(stateHighWater, size);
+	if(stateSize)
+	{
+		deltaBuff[0] = stateSize;
+		uint deltaWords = encodeDelta((uint32*)stateBuff, (uint32*)nextStateBuff, words, &deltaBuff[1]);
+		storeEntry((uchar*)deltaBuff, (deltaWords + 1) * 4);
+	}
+	IG::swap(stateBuff, nextStateBuff);
+	stateSize = size;
+	TimeSys end;
+	end.setTimeNow();
+	captureSecs += double(end - begin);
+}
+
+void addFrames(uint frames)
+{
+	if(!optionRewindBufferSize)
+		return;
+	capturedFrames += frames;
+	framesSinceCapture += frames;
+	if(framesSinceCapture < optionRewindInterval)
+		return;
+	framesSinceCapture = 0;
+	capture();
+}
+
+bool stepBack()
+{
+	if(!entryCount)
+		return 0;
+	auto &e = newestEntry();
+	const uint32 *delta = (uint32*)&ring[e.offset];
+	uint olderSize = delta[0];
+	applyDelta((uint32*)stateBuff, &delta[1], e.size / 4 - 1);
+	stateSize = olderSize;
+	ringHead = e.offset;
+	ringUsed -= e.size;
+	entryCount--;
+	framesSinceCapture = 0;
+	int ret = EmuSystem::loadStateFromBuffer(stateBuff, stateSize);
+	if(ret != STATE_RESULT_OK)
+	{
+		logErr("error %d loading state", ret);
+		return 0;
+	}
+	return 1;
+}
+
+void reset()
+{
+	mem_freeSafe(stateBuff);
+	mem_freeSafe(nextStateBuff);
+	mem_freeSafe(deltaBuff);
+	mem_freeSafe(ring);
+	mem_freeSafe(entry);
+	stateBuff = nextStateBuff = ring = nullptr;
+	deltaBuff = nullptr;
+	entry = nullptr;
+	stateBuffSize = stateSize = stateHighWater = deltaBuffSize = 0;
+	ringSize = ringHead = ringUsed = 0;
+	entryStart = entryCount = 0;
+	framesSinceCapture = 0;
+	unsupported = 0;
+	captureSecs = 0;
+	capturedFrames = 0;
+}
+
+bool isActive()
+{
+	return ring;
+}
+
+uint steps()
+{
+	return entryCount;
+}
+
+uint memoryUsed()
+{
+	if(!ring)
+		return 0;
+	return memoryBudget() - ringSize + ringUsed;
+}
+
+uint memoryBudget()
+{
+	return optionRewindBufferSize * 1024 * 1024;
+}
+
+double captureSecsPerFrame()
+{
+	return capturedFrames ? captureSecs / capturedFrames : 0;
+}
+
+}
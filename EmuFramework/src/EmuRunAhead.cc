@@ -0,0 +1,148 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "runAhead"
+#include <EmuRunAhead.hh>
+#include <EmuSystem.hh>
+#include <EmuOptions.hh>
+#include <util/time/sys.hh>
+
+namespace EmuRunAhead
+{
+
+static uchar *stateBuff = nullptr;
+static uint stateBuffSize = 0;
+static bool unsupported = 0;
+static double overheadSecs = 0, realFrameSecs = 0;
+static uint measuredFrames = 0;
+static const uint reportFrames = 180;
+static bool reportReady = 0;
+
+static void disable()
+{
+	unsupported = 1;
+	__atomic_store_n(&reportReady, 1, __ATOMIC_RELEASE);
+}
+
+static bool init()
+{
+	uint size = EmuSystem::stateBufferSize();
+	if(!size)
+	{
+		logMsg("system doesn't support in-memory states");
+		disable();
+		return 0;
+	}
+	stateBuff = (uchar*)mem_alloc(size);
+	if(!stateBuff)
+	{
+		logErr("out of memory allocating %d byte state buffer", size);
+		disable();
+		return 0;
+	}
+	stateBuffSize = size;
+	logMsg("allocated %d byte state buffer", size);
+	// catch systems that can't save the current game before a frame depends on it
+	if(!EmuSystem::saveStateToBuffer(stateBuff, stateBuffSize))
+	{
+		logErr("error saving state, disabling run-ahead");
+		mem_free(stateBuff);
+		stateBuff = nullptr;
+		stateBuffSize = 0;
+		disable();
+		return 0;
+	}
+	return 1;
+}
+
+void runFrame(bool renderAudio)
+{
+	uint aheadFrames = optionRunAhead;
+	if(!aheadFrames || (!stateBuff && (unsupported || !init())))
+	{
+		EmuSystem::runFrame(1, 1, renderAudio);
+		return;
+	}
+
+	TimeSys start, realFrameDone, end;
+	start.setTimeNow();
+	// the real frame only contributes audio, the picture comes from the last frame run ahead
+	EmuSystem::runFrame(0, 0, renderAudio);
+	realFrameDone.setTimeNow();
+	uint size = EmuSystem::saveStateToBuffer(stateBuff, stateBuffSize);
+	if(!size)
+	{
+		// the real frame's picture was skipped, present the next one so this refresh isn't lost
+		logErr("error saving state, disabling run-ahead");
+		disable();
+		EmuSystem::runFrame(1, 1, 0);
+		return;
+	}
+	iterateTimes(aheadFrames - 1, i)
+	{
+		EmuSystem::runFrame(0, 0, 0);
+	}
+	EmuSystem::runFrame(1, 1, 0);
+	int ret = EmuSystem::loadStateFromBuffer(stateBuff, size);
+	if(ret != STATE_RESULT_OK)
+	{
+		logErr("error %d loading state, disabling run-ahead", ret);
+		disable();
+		return;
+	}
+	end.setTimeNow();
+
+	realFrameSecs += double(realFrameDone - start);
+	overheadSecs += double(end - realFrameDone);
+	if(++measuredFrames == reportFrames)
+	{
+		logMsg("%d frames ahead costs %fms per frame, real frame takes %fms",
+			aheadFrames, overheadSecsPerFrame() * 1000., frameSecs() * 1000.);
+		__atomic_store_n(&reportReady, 1, __ATOMIC_RELEASE);
+	}
+}
+
+void reset()
+{
+	mem_freeSafe(stateBuff);
+	stateBuff = nullptr;
+	stateBuffSize = 0;
+	unsupported = 0;
+	overheadSecs = realFrameSecs = 0;
+	measuredFrames = 0;
+	reportReady = 0;
+}
+
+bool isActive()
+{
+	return stateBuff && !unsupported && optionRunAhead;
+}
+
+bool takeReport()
+{
+	return __atomic_exchange_n(&reportReady, 0, __ATOMIC_ACQUIRE);
+}
+
+double overheadSecsPerFrame()
+{
+	return measuredFrames ? overheadSecs / measuredFrames : 0;
+}
+
+double frameSecs()
+{
+	return measuredFrames ? realFrameSecs / measuredFrames : 0;
+}
+
+}
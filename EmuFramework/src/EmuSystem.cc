@@ -17,6 +17,8 @@
 #include <EmuSystem.hh>
 #include <EmuOptions.hh>
 #include <audio/Audio.hh>
+#include <audio/Resampler.hh>
+#include <zlib.h>
 
 EmuSystem::State EmuSystem::state = EmuSystem::State::OFF;
 FsSys::cPath EmuSystem::gamePath = "";
@@ -28,7 +30,12 @@ TimeSys EmuSystem::startTime;
 int EmuSystem::emuFrameNow;
 int EmuSystem::saveStateSlot = 0;
 Audio::PcmFormat EmuSystem::pcmFormat = Audio::pPCM;
+uchar *EmuSystem::stateArena = nullptr;
+uint EmuSystem::stateArenaSize = 0;
+double EmuSystem::audioRateScale = 1.;
 const uint EmuSystem::optionFrameSkipAuto = 32;
+static Audio::Resampler resampler;
+static int resamplerChannels = 0;
 EmuSystem::LoadGameCompleteDelegate EmuSystem::loadGameCompleteDel;
 Base::CallbackRef *EmuSystem::autoSaveStateCallbackRef = nullptr;
 void fixFilePermissions(const char *path);
@@ -39,7 +46,9 @@ static const auto autoSaveStateCallback = Base::CallbackDelegate::create<&saveAu
 void saveAutoStateFromTimer()
 {
 	logMsg("auto-save state timer fired");
+	EmuThread::lock();
 	EmuSystem::saveAutoState();
+	EmuThread::unlock();
 	EmuSystem::autoSaveStateCallbackRef = Base::callbackAfterDelaySec(autoSaveStateCallback, 60*optionAutoSaveState);
 }
 
@@ -65,6 +74,8 @@ void EmuSystem::startSound()
 {
 	if(optionSound)
 	{
+		if(resampler.isInit())
+			resampler.clear(); // don't play audio from before the pause
 		Audio::openPcm(pcmFormat);
 	}
 }
@@ -78,6 +89,40 @@ void EmuSystem::stopSound()
 	}
 }
 
+void EmuSystem::setNativeSoundRate(double rate)
+{
+	double outRate = pcmFormat.rate * audioRateScale;
+	if(resampler.isInit() && resamplerChannels == pcmFormat.channels)
+	{
+		resampler.setRates(rate, outRate);
+		return;
+	}
+	if(resampler.init(pcmFormat.channels, rate, outRate) != OK)
+	{
+		logErr("can't convert from native sound rate %f", rate);
+		return;
+	}
+	resamplerChannels = pcmFormat.channels;
+}
+
+void EmuSystem::writeSound(const int16 *samples, uint frames)
+{
+	if(unlikely(!resampler.isInit()))
+		return;
+	uint maxFrames = resampler.maxOutFrames(frames);
+	#ifdef USE_NEW_AUDIO
+	Audio::BufferContext *aBuff = Audio::getPlayBuffer(maxFrames);
+	if(!aBuff)
+		return;
+	uint outFrames = resampler.process(samples, frames, (int16*)aBuff->data, aBuff->frames);
+	Audio::commitPlayBuffer(aBuff, outFrames);
+	#else
+	int16 buff[maxFrames * resamplerChannels];
+	uint outFrames = resampler.process(samples, frames, buff, maxFrames);
+	Audio::writePcm((uchar*)buff, outFrames);
+	#endif
+}
+
 bool EmuSystem::stateExists(int slot)
 {
 	FsSys::cPath saveStr;
@@ -85,6 +130,115 @@ bool EmuSystem::stateExists(int slot)
 	return FsSys::fileExists(saveStr);
 }
 
+int EmuSystem::saveStateFile(const char *path, bool async)
+{
+	if(!stateArena && stateArenaSize)
+		stateArena = (uchar*)mem_alloc(stateArenaSize);
+	uint size = stateArena ? saveStateToBuffer(stateArena, stateArenaSize) : 0;
+	if(!size)
+	{
+		// first save since loading the game, or the state outgrew the arena
+		uint neededSize = stateBufferSize();
+		if(!neededSize)
+			return STATE_RESULT_IO_ERROR;
+		if(!stateArena || neededSize > stateArenaSize)
+		{
+			freeStateArena();
+			stateArena = (uchar*)mem_alloc(neededSize);
+			if(!stateArena)
+			{
+				logErr("out of memory for %d byte state", neededSize);
+				return STATE_RESULT_IO_ERROR;
+			}
+			stateArenaSize = neededSize;
+		}
+		size = saveStateToBuffer(stateArena, stateArenaSize);
+		if(!size)
+			return STATE_RESULT_IO_ERROR;
+	}
+	logMsg("writing %d byte state %s", size, path);
+	if(async)
+	{
+		// the worker frees the snapshot, the size is kept so the next
+		// save can allocate a new arena without asking the system again
+		auto snapshot = stateArena;
+		stateArena = nullptr;
+		if(!EmuIoWorker::write(path, snapshot, size, EmuIoWorker::JOB_STATE, EmuIoWorker::FLAG_COMPRESS))
+			return STATE_RESULT_OTHER_ERROR;
+		return STATE_RESULT_OK;
+	}
+	return EmuIoWorker::writeNow(path, stateArena, size, EmuIoWorker::FLAG_COMPRESS);
+}
+
+int EmuSystem::loadStateFile(const char *path)
+{
+	EmuIoWorker::flush(); // a pending auto-save may be for this file
+	CallResult ret;
+	Io *f = IoSys::open(path, 0, &ret);
+	if(!f)
+	{
+		switch(ret)
+		{
+			case PERMISSION_DENIED: return STATE_RESULT_NO_FILE_ACCESS;
+			case NOT_FOUND: return STATE_RESULT_NO_FILE;
+			default: return STATE_RESULT_IO_ERROR;
+		}
+	}
+	const uchar *data = f->mmapConst();
+	if(!data)
+	{
+		delete f;
+		return STATE_RESULT_IO_ERROR;
+	}
+	logMsg("loading %d byte state %s", (int)f->size(), path);
+	int result;
+	uint stateSize;
+	if(auto state = gunzipState(data, f->size(), stateSize))
+	{
+		result = loadStateFromBuffer(state, stateSize);
+		mem_free(state);
+	}
+	else
+		result = loadStateFromBuffer(data, f->size());
+	delete f;
+	return result;
+}
+
+void EmuSystem::freeStateArena()
+{
+	if(stateArena)
+	{
+		mem_free(stateArena);
+		stateArena = nullptr;
+	}
+	stateArenaSize = 0;
+}
+
+uchar *EmuSystem::gunzipState(const uchar *buff, uint size, uint &stateSize)
+{
+	if(size < 18 || buff[0] != 0x1f || buff[1] != 0x8b)
+		return nullptr;
+	// the gzip trailer ends with the uncompressed size
+	stateSize = buff[size-4] | (buff[size-3] << 8) | (buff[size-2] << 16) | (buff[size-1] << 24);
+	auto state = (uchar*)mem_alloc(stateSize);
+	if(!state)
+		return nullptr;
+	z_stream zs {0};
+	zs.next_in = (Bytef*)buff;
+	zs.avail_in = size;
+	zs.next_out = state;
+	zs.avail_out = stateSize;
+	bool inflated = inflateInit2(&zs, 16 + MAX_WBITS) == Z_OK && inflate(&zs, Z_FINISH) == Z_STREAM_END;
+	inflateEnd(&zs);
+	if(!inflated)
+	{
+		logErr("error inflating %d byte state", size);
+		mem_free(state);
+		return nullptr;
+	}
+	return state;
+}
+
 bool EmuSystem::loadAutoState()
 {
 	if(optionAutoSaveState)
@@ -98,10 +252,7 @@ bool EmuSystem::loadAutoState()
 	return 0;
 }
 
-//static int autoFrameSkipLevel = 0;
-//static int lowBufferFrames = (audio_maxRate/60)*3, highBufferFrames = (audio_maxRate/60)*5;
-
-int EmuSystem::setupFrameSkip(uint optionVal)
+int EmuSystem::setupFrameSkip(uint optionVal, const Base::FrameTime &frameTime)
 {
 	static const uint maxFrameSkip = 6;
 	static const uint ntscNSecs = 16666666, palNSecs = 20000000;
@@ -110,11 +261,21 @@ int EmuSystem::setupFrameSkip(uint optionVal)
 		return optionVal; // constant frame-skip for NTSC source
 	}
 
-	TimeSys realTime;
-	realTime.setTimeNow();
+	// count frames from when the display showed the last frame if it's known,
+	// so the jitter of waking up from the swap doesn't cause skips & repeats
+	TimeSys realTime = frameTime.timestamp;
+	if(!frameTime.refreshes || realTime < startTime)
+		realTime.setTimeNow();
 	TimeSys timeTotal = realTime - startTime;
 
 	int emuFrame = timeTotal.divByNSecs(vidSysIsPAL() ? palNSecs : ntscNSecs);
+	uint pacedSkip;
+	if(optionVal == optionFrameSkipAuto && EmuPacing::setupFrameSkip(frameTime, pacedSkip))
+	{
+		// paced by the display & audio buffer, keep the wall-clock count current for fallback
+		emuFrameNow = emuFrame;
+		return pacedSkip;
+	}
 	//logMsg("on frame %d, was %d, total time %f", emuFrame, emuFrameNow, (double)timeTotal);
 	assert(emuFrame >= emuFrameNow);
 	if(emuFrame == emuFrameNow)
@@ -132,29 +293,6 @@ int EmuSystem::setupFrameSkip(uint optionVal)
 		}
 		return skip;
 	}
-
-	/*uint skip = 0;
-	gfx_updateFrameTime();
-	//logMsg("%d real frames passed", gfx_frameTimeRel);
-	if(gfx_frameTimeRel > 1)
-	{
-		skip = min(gfx_frameTimeRel - 1, maxFrameSkip);
-		if(skip && Audio::framesFree() < Audio::maxRate/12)
-		{
-			logMsg("not skipping %d frames from full audio buffer", skip);
-			skip = 0;
-		}
-		else
-		{
-			logMsg("skipping %u frames", skip);
-		}
-	}
-	if(gfx_frameTimeRel == 0)
-	{
-		logMsg("no frames passed");
-		return -1;
-	}
-	return skip;*/
 }
 
 void EmuSystem::setupGamePaths(const char *filePath)
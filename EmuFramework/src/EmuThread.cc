@@ -0,0 +1,221 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "emuThread"
+#include <EmuThread.hh>
+#include <EmuSystem.hh>
+#include <EmuOptions.hh>
+#include <util/thread/pthread.hh>
+#include <util/thread/TripleBuffer.hh>
+#include <util/RingBuffer.hh>
+#include <util/time/FrameProfiler.hh>
+
+namespace EmuThread
+{
+
+struct FrameSlot
+{
+	constexpr FrameSlot() { }
+	uchar *data = nullptr;
+	uint size = 0;
+	uint x = 0, y = 0;
+};
+
+static ThreadPThread thread;
+static MutexPThread requestMutex, emuMutex;
+static CondVarPThread requestCond;
+static bool active = 0, quit = 0, mutexInit = 0;
+
+// pending work, guarded by requestMutex
+static bool framePending = 0, pendingSkipAudio = 0, pendingRenderAudio = 0;
+static uint pendingSkipFrames = 0;
+static const uint maxPendingSkipFrames = 6;
+
+static TripleBufferIndex frameIdx;
+static FrameSlot frameSlot[3];
+
+struct InputAction
+{
+	uint state, emuKey;
+};
+
+// written by the main thread, applied by the emulation thread between frames
+static InputAction inputActionBuff[64];
+static RingBuffer<InputAction> inputActions;
+
+static void applyInputActions()
+{
+	InputAction action;
+	while(inputActions.read(&action, 1))
+	{
+		EmuSystem::handleInputAction(action.state, action.emuKey);
+	}
+}
+
+static ptrsize runEmulation(ThreadPThread &)
+{
+	logMsg("emulation thread running");
+	for(;;)
+	{
+		requestMutex.lock();
+		while(!framePending && !quit)
+			requestCond.wait(&requestMutex);
+		if(quit)
+		{
+			requestMutex.unlock();
+			break;
+		}
+		uint skipFrames = pendingSkipFrames;
+		bool skipAudio = pendingSkipAudio, renderAudio = pendingRenderAudio;
+		pendingSkipFrames = 0;
+		framePending = 0;
+		requestMutex.unlock();
+
+		emuMutex.lock();
+		{
+			applyInputActions();
+			profileZone(ZONE_EMULATE);
+			iterateTimes(skipFrames, i)
+			{
+				EmuSystem::runFrame(0, 0, skipAudio);
+			}
+			EmuRunAhead::runFrame(renderAudio);
+			EmuRewind::addFrames(skipFrames + 1);
+		}
+		emuMutex.unlock();
+	}
+	logMsg("emulation thread exiting");
+	return 0;
+}
+
+void start()
+{
+	if(active || !optionEmuThread)
+		return;
+	if(!mutexInit)
+	{
+		requestMutex.create();
+		emuMutex.create();
+		requestCond.create(&requestMutex);
+		mutexInit = 1;
+	}
+	quit = 0;
+	framePending = 0;
+	pendingSkipFrames = 0;
+	frameIdx.reset();
+	inputActions.init(inputActionBuff, sizeofArray(inputActionBuff));
+	active = 1;
+	if(!thread.create(0, ThreadPThread::EntryDelegate::create<&runEmulation>()))
+	{
+		logErr("unable to create emulation thread, running frames in draw callback");
+		active = 0;
+	}
+}
+
+void stop()
+{
+	if(!active)
+		return;
+	requestMutex.lock();
+	quit = 1;
+	requestCond.signal();
+	requestMutex.unlock();
+	thread.join();
+	active = 0;
+	applyInputActions(); // anything queued after the last frame
+}
+
+bool isActive()
+{
+	return active;
+}
+
+void requestFrames(uint skipFrames, bool skipAudio, bool renderAudio)
+{
+	assert(active);
+	requestMutex.lock();
+	if(framePending)
+	{
+		// thread hasn't started on the last request yet, fold its rendered frame into the skipped ones
+		skipFrames += pendingSkipFrames + 1;
+	}
+	pendingSkipFrames = IG::min(skipFrames, maxPendingSkipFrames);
+	pendingSkipAudio = skipAudio;
+	pendingRenderAudio = renderAudio;
+	framePending = 1;
+	requestCond.signal();
+	requestMutex.unlock();
+}
+
+void lock()
+{
+	if(active)
+		emuMutex.lock();
+}
+
+void unlock()
+{
+	if(active)
+		emuMutex.unlock();
+}
+
+bool takeFrame(Pixmap &pix)
+{
+	if(!frameIdx.update())
+		return 0;
+	auto &slot = frameSlot[frameIdx.readIdx()];
+	pix.init(slot.data, slot.x, slot.y);
+	return 1;
+}
+
+void handleInputAction(uint state, uint emuKey)
+{
+	if(!active)
+	{
+		EmuSystem::handleInputAction(state, emuKey);
+		return;
+	}
+	InputAction action {state, emuKey};
+	if(!inputActions.write(&action, 1))
+	{
+		// queue full, wait for the current frame instead
+		emuMutex.lock();
+		applyInputActions();
+		EmuSystem::handleInputAction(state, emuKey);
+		emuMutex.unlock();
+	}
+}
+
+void commitFrame(const Pixmap &pix)
+{
+	// the write slot belongs only to this thread until commit(), so it's safe to resize
+	auto &slot = frameSlot[frameIdx.writeIdx()];
+	uint size = pix.sizeOfImage();
+	if(slot.size < size)
+	{
+		logMsg("resizing frame slot %d to %d bytes", frameIdx.writeIdx(), size);
+		mem_freeSafe(slot.data);
+		slot.data = (uchar*)mem_alloc(size);
+		slot.size = size;
+	}
+	Pixmap dest(pix.format);
+	dest.init(slot.data, pix.x, pix.y);
+	pix.copy(0, 0, 0, 0, &dest, 0, 0);
+	slot.x = pix.x;
+	slot.y = pix.y;
+	frameIdx.commit();
+}
+
+}
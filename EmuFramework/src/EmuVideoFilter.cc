@@ -0,0 +1,255 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "videoFilter"
+#include <EmuVideoFilter.hh>
+#include "EmuVideoFilterKernels.hh"
+#include <util/thread/pthread.hh>
+#include <unistd.h>
+
+namespace EmuVideoFilter
+{
+
+typedef void (*KernelFunc)(const uint16 *src, uint srcPitch, uint16 *dest, uint destPitch, uint width, uint height, uint yStart, uint yEnd);
+
+struct Job
+{
+	constexpr Job() { }
+	KernelFunc kernel = nullptr;
+	const uint16 *src = nullptr;
+	uint16 *dest = nullptr;
+	uint srcPitch = 0, destPitch = 0;
+	uint width = 0, height = 0;
+	uint slices = 1;
+};
+
+static const uint maxWorkers = 3;
+static ThreadPThread worker[maxWorkers];
+static uint workers = 0;
+static bool workersStarted = 0, quit = 0, mutexInit = 0;
+static MutexPThread mutex;
+static CondVarPThread startCond, doneCond;
+// guarded by mutex
+static uint jobId = 0, slicesDone = 0;
+static Job job;
+
+static uint filter = NONE;
+static Pixmap outPix {PixelFormatRGB565};
+
+void scale2x(const uint16 *src, uint srcPitch, uint16 *dest, uint destPitch, uint width, uint height, uint yStart, uint yEnd)
+{
+	for(uint y = yStart; y < yEnd; y++)
+	{
+		const uint16 *line = &src[y * srcPitch];
+		const uint16 *prevLine = y > 0 ? line - srcPitch : line;
+		const uint16 *nextLine = y < height - 1 ? line + srcPitch : line;
+		uint16 *out0 = &dest[y * 2 * destPitch];
+		uint16 *out1 = out0 + destPitch;
+		iterateTimes(width, x)
+		{
+			uint b = prevLine[x], h = nextLine[x], e = line[x];
+			uint d = x > 0 ? line[x-1] : e;
+			uint f = x < width - 1 ? line[x+1] : e;
+			if(b != h && d != f)
+			{
+				out0[x*2] = d == b ? d : e;
+				out0[x*2+1] = b == f ? f : e;
+				out1[x*2] = d == h ? d : e;
+				out1[x*2+1] = h == f ? f : e;
+			}
+			else
+			{
+				out0[x*2] = out0[x*2+1] = out1[x*2] = out1[x*2+1] = e;
+			}
+		}
+	}
+}
+
+static uint cpuCount()
+{
+	#ifdef _SC_NPROCESSORS_ONLN
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if(cpus > 0)
+		return cpus;
+	#endif
+	return 1;
+}
+
+static void runSlice(uint slice)
+{
+	uint yStart = job.height * slice / job.slices;
+	uint yEnd = job.height * (slice + 1) / job.slices;
+	job.kernel(job.src, job.srcPitch, job.dest, job.destPitch, job.width, job.height, yStart, yEnd);
+}
+
+static uint workerStartJobId = 0;
+
+static ptrsize runWorker(ThreadPThread &thread)
+{
+	uint slice = (&thread - worker) + 1;
+	mutex.lock();
+	uint lastJobId = workerStartJobId;
+	for(;;)
+	{
+		while(jobId == lastJobId && !quit)
+			startCond.wait(&mutex);
+		if(quit)
+			break;
+		lastJobId = jobId;
+		mutex.unlock();
+		runSlice(slice);
+		mutex.lock();
+		if(++slicesDone == workers)
+			doneCond.signal();
+	}
+	mutex.unlock();
+	return 0;
+}
+
+static void startWorkers()
+{
+	workersStarted = 1;
+	uint wantedWorkers = IG::min(cpuCount() - 1, maxWorkers);
+	if(!wantedWorkers)
+	{
+		logMsg("single CPU, filtering on the calling thread");
+		return;
+	}
+	if(!mutexInit)
+	{
+		mutex.create();
+		startCond.create(&mutex);
+		doneCond.create(&mutex);
+		mutexInit = 1;
+	}
+	quit = 0;
+	workerStartJobId = jobId;
+	iterateTimes(wantedWorkers, i)
+	{
+		if(!worker[i].create(0, ThreadPThread::EntryDelegate::create<&runWorker>()))
+		{
+			logErr("unable to create filter worker %d", i);
+			break;
+		}
+		workers++;
+	}
+	logMsg("started %d filter workers", workers);
+}
+
+static void stopWorkers()
+{
+	if(workers)
+	{
+		mutex.lock();
+		quit = 1;
+		startCond.broadcast();
+		mutex.unlock();
+		iterateTimes(workers, i)
+		{
+			worker[i].join();
+		}
+		workers = 0;
+	}
+	workersStarted = 0;
+}
+
+static KernelFunc kernel()
+{
+	switch(filter)
+	{
+		case SCALE2X: return scale2x;
+		case HQ2X: return hq2x;
+		case HQ3X: return hq3x;
+	}
+	return nullptr;
+}
+
+static uint scaleFactor()
+{
+	return filter == HQ3X ? 3 : 2;
+}
+
+void setFilter(uint newFilter)
+{
+	if(newFilter > MAX_VAL)
+		newFilter = NONE;
+	if(newFilter == filter)
+		return;
+	logMsg("setting filter %d", newFilter);
+	filter = newFilter;
+	deinit();
+}
+
+Pixmap &outputPixmap(Pixmap &pix)
+{
+	if(filter == NONE || pix.format.id != PIXEL_RGB565)
+		return pix;
+	uint x = pix.x * scaleFactor(), y = pix.y * scaleFactor();
+	if(outPix.x != x || outPix.y != y)
+	{
+		logMsg("resizing output to %d,%d", x, y);
+		outPix.init(x, y);
+	}
+	return outPix;
+}
+
+Pixmap &apply(Pixmap &pix)
+{
+	Pixmap &out = outputPixmap(pix);
+	if(&out == &pix)
+		return pix;
+	if(!workersStarted)
+		startWorkers();
+	if(filter == HQ2X || filter == HQ3X)
+		hqInit();
+	job.kernel = kernel();
+	job.src = (const uint16*)pix.data;
+	job.srcPitch = pix.pitchPixels();
+	job.dest = (uint16*)out.data;
+	job.destPitch = out.pitchPixels();
+	job.width = pix.x;
+	job.height = pix.y;
+	job.slices = workers + 1;
+	if(workers)
+	{
+		mutex.lock();
+		slicesDone = 0;
+		jobId++;
+		startCond.broadcast();
+		mutex.unlock();
+	}
+	runSlice(0);
+	if(workers)
+	{
+		mutex.lock();
+		while(slicesDone != workers)
+			doneCond.wait(&mutex);
+		mutex.unlock();
+	}
+	return out;
+}
+
+void deinit()
+{
+	stopWorkers();
+	if(outPix.data)
+	{
+		outPix.deinitManaged();
+		outPix.x = outPix.y = 0;
+	}
+	hqDeinit();
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+/*  Helpers shared by the hq2x & hq3x filters
+	Copyright (C) 2003 MaxSt ( maxst@hiend3d.com )
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later
+	version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details. */
+
+#include "EmuVideoFilterKernels.hh"
+#include <stdlib.h>
+
+namespace EmuVideoFilter
+{
+
+// RGB565 to packed YUV, built by hqInit()
+extern uint32 *hqRGBToYUV;
+
+static inline bool Diff(uint w1, uint w2)
+{
+	if(w1 == w2)
+		return 0;
+	int yuv1 = hqRGBToYUV[w1], yuv2 = hqRGBToYUV[w2];
+	return abs((yuv1 & 0xFF0000) - (yuv2 & 0xFF0000)) > 0x300000
+		|| abs((yuv1 & 0xFF00) - (yuv2 & 0xFF00)) > 0x700
+		|| abs((yuv1 & 0xFF) - (yuv2 & 0xFF)) > 0x6;
+}
+
+// Blending works on pixels spread to 00000GGGGGG00000RRRRR000000BBBBB
+// so each component has 4 bits of headroom for the weighted sums
+static inline uint spread(uint p)
+{
+	return (p | (p << 16)) & 0x07E0F81F;
+}
+
+static inline uint16 pack(uint p)
+{
+	p &= 0x07E0F81F;
+	return p | (p >> 16);
+}
+
+static inline uint16 interp1(uint c1, uint c2) { return pack((c1*3 + c2) >> 2); }
+static inline uint16 interp2(uint c1, uint c2, uint c3) { return pack((c1*2 + c2 + c3) >> 2); }
+
+}
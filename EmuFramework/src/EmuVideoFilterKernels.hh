@@ -0,0 +1,34 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <engine-globals.h>
+
+// Scalers used by EmuVideoFilter. Each one reads the whole source frame so
+// lines at the edges of [yStart, yEnd) see their real neighbors & writes
+// only the output lines of that range. Pitches are in pixels.
+namespace EmuVideoFilter
+{
+
+void scale2x(const uint16 *src, uint srcPitch, uint16 *dest, uint destPitch, uint width, uint height, uint yStart, uint yEnd);
+
+// builds the color difference table hq2x & hq3x share the first time it's called
+void hqInit();
+void hqDeinit();
+void hq2x(const uint16 *src, uint srcPitch, uint16 *dest, uint destPitch, uint width, uint height, uint yStart, uint yEnd);
+void hq3x(const uint16 *src, uint srcPitch, uint16 *dest, uint destPitch, uint width, uint height, uint yStart, uint yEnd);
+
+}
@@ -29,7 +29,7 @@ void EmuView::placeEmu()
 			gameView.init();
 			uint scaleFactor;
 			// TODO: generalize this?
-			uint gameX = vidPix.x, gameY = vidPix.y;
+			uint gameX = vidImgX, gameY = vidImgY;
 			GC gameAR = GC(gameX) / GC(gameY);
 			if(gameAR >= 2) // avoid overly wide images
 			{
@@ -115,10 +115,14 @@ void EmuView::drawContent()
 			}
 		}
 	#endif
+	#ifdef CONFIG_FRAME_PROFILER
+	if(optionShowFrameProfile)
+		profileOverlay.draw();
+	#endif
 	popup.draw();
 }
 
-void EmuView::draw()
+void EmuView::draw(const Base::FrameTime &frameTime)
 {
 	using namespace Gfx;
 	if(likely(EmuSystem::isActive()))
@@ -133,10 +137,18 @@ void EmuView::draw()
 		#endif
 		Base::displayNeedsUpdate();
 
-		runFrame();
+		runFrame(frameTime);
 	}
 	else if(EmuSystem::isStarted())
 	{
+		if(unlikely(vidImgX != vidPix.x || vidImgY != vidPix.y))
+		{
+			// emulation thread changed the frame size before it was presented,
+			// it's stopped now so vidPix is safe to read
+			reinitImage();
+			vidImg.write(EmuVideoFilter::apply(vidPix));
+			placeEmu();
+		}
 		setBlendMode(0);
 		setImgMode(IMG_MODE_MODULATE);
 		setColor(.33, .33, .33, 1.);
@@ -145,27 +157,72 @@ void EmuView::draw()
 	}
 }
 
-void EmuView::runFrame()
+void EmuView::presentThreadFrame()
+{
+	// only the format is read from vidPix, it's fixed after initPixmap()
+	Pixmap pix(vidPix.format);
+	if(EmuThread::takeFrame(pix))
+	{
+		if(unlikely(pix.x != vidImgX || pix.y != vidImgY))
+		{
+			logMsg("frame size changed to %d,%d", pix.x, pix.y);
+			initVidImg(pix);
+			placeEmu();
+		}
+		vidImg.write(EmuVideoFilter::apply(pix));
+	}
+	drawContent<1>();
+}
+
+void EmuView::runFrame(const Base::FrameTime &frameTime)
 {
 	commonUpdateInput();
 	bool renderAudio = optionSound;
+	if(unlikely(EmuRunAhead::takeReport()))
+	{
+		if(EmuRunAhead::isActive())
+			popup.printf(3, 0, "Run-ahead costs %.2fms per frame (%.2fms emulated)",
+				EmuRunAhead::overheadSecsPerFrame() * 1000., EmuRunAhead::frameSecs() * 1000.);
+		else
+			popup.postError("Run-ahead not available for this system");
+	}
+
+	if(EmuThread::isActive())
+	{
+		if(unlikely(ffGuiKeyPush || ffGuiTouch))
+		{
+			EmuThread::requestFrames(4, 0, renderAudio);
+		}
+		else
+		{
+			int framesToSkip = EmuSystem::setupFrameSkip(optionFrameSkip, frameTime);
+			if(framesToSkip != -1)
+				EmuThread::requestFrames(framesToSkip, renderAudio, renderAudio);
+		}
+		presentThreadFrame();
+		return;
+	}
 
+	profileZone(ZONE_EMULATE);
+	uint frames = 1;
 	if(unlikely(ffGuiKeyPush || ffGuiTouch))
 	{
 		iterateTimes(4, i)
 		{
 			EmuSystem::runFrame(0, 0, 0);
 		}
+		frames += 4;
 	}
 	else
 	{
-		int framesToSkip = EmuSystem::setupFrameSkip(optionFrameSkip);
+		int framesToSkip = EmuSystem::setupFrameSkip(optionFrameSkip, frameTime);
 		if(framesToSkip > 0)
 		{
 			iterateTimes(framesToSkip, i)
 			{
 				EmuSystem::runFrame(0, 0, renderAudio);
 			}
+			frames += framesToSkip;
 		}
 		else if(framesToSkip == -1)
 		{
@@ -174,5 +231,6 @@ void EmuView::runFrame()
 		}
 	}
 
-	EmuSystem::runFrame(1, 1, renderAudio);
+	EmuRunAhead::runFrame(renderAudio);
+	EmuRewind::addFrames(frames);
 }
@@ -0,0 +1,70 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "frameProfileOverlay"
+#include <FrameProfileOverlay.hh>
+#include <gfx/GeomRect.hh>
+#include <gui/View.hh>
+#include <audio/Audio.hh>
+#include <stdio.h>
+
+static const uint updateFrames = 30; // re-compiling the text every frame would show up in the profile
+
+void FrameProfileOverlay::init()
+{
+	text.init(View::defaultFace);
+	text.maxLines = FrameProfiler::ZONES + 1;
+	#ifdef CONFIG_AUDIO_PULL_STATS
+	text.maxLines++;
+	#endif
+}
+
+void FrameProfileOverlay::draw()
+{
+	using namespace Gfx;
+	if(!framesUntilUpdate)
+	{
+		uint len = snprintf(str, sizeof(str), "Frame %.2fms", FrameProfiler::averageFrameSecs() * 1000.);
+		iterateTimes(FrameProfiler::ZONES, i)
+		{
+			if(len >= sizeof(str))
+				break;
+			len += snprintf(&str[len], sizeof(str) - len, "\n%s %.2fms",
+				FrameProfiler::zoneName(i), FrameProfiler::averageSecs((FrameProfiler::Zone)i) * 1000.);
+		}
+		#ifdef CONFIG_AUDIO_PULL_STATS
+		if(len < sizeof(str) && Audio::isOpen())
+		{
+			Audio::PullStats audio;
+			Audio::pullStats(audio);
+			len += snprintf(&str[len], sizeof(str) - len, "\nAudio %d/%d under/xruns, period %.1f/%.1fms",
+				audio.underruns, audio.xruns, audio.lastPeriodUSecs / 1000., audio.maxPeriodUSecs / 1000.);
+			if(len < sizeof(str) && (audio.reopens || audio.droppedFrames))
+				len += snprintf(&str[len], sizeof(str) - len, "\nAudio %d reopens, %d dropped frames",
+					audio.reopens, audio.droppedFrames);
+		}
+		#endif
+		text.setString(str);
+		text.compile();
+		framesUntilUpdate = updateFrames;
+	}
+	framesUntilUpdate--;
+	resetTransforms();
+	setBlendMode(BLEND_MODE_ALPHA);
+	setColor(0., 0., 0., .5);
+	GeomRect::draw(Rect2<GC>(-proj.wHalf, proj.hHalf - text.ySize, -proj.wHalf + text.xSize, proj.hHalf));
+	setColor(1., 1., 1., 1.);
+	text.draw(-proj.wHalf, proj.hHalf, LT2DO, LT2DO);
+}
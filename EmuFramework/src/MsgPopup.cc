@@ -53,6 +53,10 @@ void MsgPopup::unpost()
 void MsgPopup::post(const char *msg, int secs, bool error)
 {
 	logMsg("%s", msg);
+	#ifdef CONFIG_EMU_BENCH
+	fprintf(stderr, "%s\n", msg); // no font or window to draw with
+	return;
+	#endif
 	text.setString(msg);
 	text.compile();
 	this->error = error;
@@ -2,6 +2,8 @@
 #include <OptionView.hh>
 #include <MsgPopup.hh>
 #include <FilePicker.hh>
+#include <EmuRewind.hh>
+#include <EmuRunAhead.hh>
 
 extern MsgPopup popup;
 extern EmuFilePicker fPicker;
@@ -12,6 +14,15 @@ void soundHandler(BoolMenuItem &item, const Input::Event &e)
 	optionSound = item.on;
 }
 
+static void framePacingHandler(BoolMenuItem &item, const Input::Event &e)
+{
+	item.toggle();
+	optionFramePacing = item.on;
+	EmuPacing::reset();
+	if(!item.on)
+		EmuPacing::setAudioRateScale(1.);
+}
+
 #ifdef CONFIG_AUDIO_OPENSL_ES
 static void soundUnderrunCheckHandler(BoolMenuItem &item, const Input::Event &e)
 {
@@ -237,6 +248,88 @@ void confirmOverwriteStateHandler(BoolMenuItem &item, const Input::Event &e)
 	optionConfirmOverwriteState = item.on;
 }
 
+void emuThreadHandler(BoolMenuItem &item, const Input::Event &e)
+{
+	item.toggle();
+	optionEmuThread = item.on; // takes effect when emulation resumes
+}
+
+static const uint rewindBufferSizeVal[] = { 0, 4, 8, 16, 32, 64 };
+
+void rewindBufferSizeSet(MultiChoiceMenuItem &, int val)
+{
+	optionRewindBufferSize.val = rewindBufferSizeVal[val];
+	EmuRewind::reset();
+	logMsg("set rewind buffer size: %dMB", int(optionRewindBufferSize));
+}
+
+void OptionView::rewindBufferSizeInit()
+{
+	static const char *str[] = { "Off", "4MB", "8MB", "16MB", "32MB", "64MB" };
+	uint init = 0;
+	forEachInArray(rewindBufferSizeVal, e)
+	{
+		if(*e == optionRewindBufferSize)
+			init = e_i;
+	}
+	rewindBufferSize.init(str, init, sizeofArray(str));
+	rewindBufferSize.valueDelegate().bind<&rewindBufferSizeSet>();
+}
+
+static const uint rewindIntervalVal[] = { 1, 2, 5, 10, 20, 30, 60 };
+
+void rewindIntervalSet(MultiChoiceMenuItem &, int val)
+{
+	optionRewindInterval.val = rewindIntervalVal[val];
+	logMsg("set rewind interval: %d frames", int(optionRewindInterval));
+}
+
+void OptionView::rewindIntervalInit()
+{
+	static const char *str[] = { "Every Frame", "2 Frames", "5 Frames", "10 Frames", "20 Frames", "30 Frames", "60 Frames" };
+	uint init = 3;
+	forEachInArray(rewindIntervalVal, e)
+	{
+		if(*e == optionRewindInterval)
+			init = e_i;
+	}
+	rewindInterval.init(str, init, sizeofArray(str));
+	rewindInterval.valueDelegate().bind<&rewindIntervalSet>();
+}
+
+void runAheadSet(MultiChoiceMenuItem &, int val)
+{
+	optionRunAhead.val = val;
+	EmuRunAhead::reset();
+	logMsg("set run-ahead: %d frames", int(optionRunAhead));
+}
+
+#ifdef CONFIG_FRAME_PROFILER
+void showFrameProfileHandler(BoolMenuItem &item, const Input::Event &e)
+{
+	item.toggle();
+	optionShowFrameProfile = item.on;
+}
+
+void saveFrameProfileHandler(TextMenuItem &, const Input::Event &e)
+{
+	FsSys::cPath csvPath, tracePath;
+	snprintf(csvPath, sizeof(csvPath), "%s/frameProfile.csv", Base::storagePath());
+	snprintf(tracePath, sizeof(tracePath), "%s/frameProfile.json", Base::storagePath());
+	if(FrameProfiler::writeCSV(csvPath) && FrameProfiler::writeTrace(tracePath))
+		popup.printf(3, 0, "Saved %s and %s", csvPath, tracePath);
+	else
+		popup.postError("Error writing frame profile");
+}
+#endif
+
+void OptionView::runAheadInit()
+{
+	static const char *str[] = { "Off", "1 Frame", "2 Frames", "3 Frames", "4 Frames" };
+	runAhead.init(str, IG::min((int)optionRunAhead, (int)sizeofArray(str) - 1), sizeofArray(str));
+	runAhead.valueDelegate().bind<&runAheadSet>();
+}
+
 void pauseUnfocusedHandler(BoolMenuItem &item, const Input::Event &e)
 {
 	item.toggle();
@@ -547,6 +640,24 @@ void OptionView::imgFilterInit()
 	imgFilter.valueDelegate().bind<&imgFilterSet>();
 }
 
+void videoFilterSet(MultiChoiceMenuItem &, int val)
+{
+	optionVideoFilter.val = val;
+	EmuVideoFilter::setFilter(val);
+	if(emuView.disp.img)
+	{
+		emuView.reinitImage();
+		emuView.vidImg.write(EmuVideoFilter::apply(emuView.vidPix));
+	}
+}
+
+void OptionView::videoFilterInit()
+{
+	static const char *str[] = { "None", "Scale2x", "HQ2x", "HQ3x" };
+	videoFilter.init(str, optionVideoFilter, sizeofArray(str));
+	videoFilter.valueDelegate().bind<&videoFilterSet>();
+}
+
 void overlayEffectSet(MultiChoiceMenuItem &, int val)
 {
 	uint setVal = 0;
@@ -775,6 +886,7 @@ void OptionView::loadVideoItems(MenuItem *item[], uint &items)
 	if(!optionGameOrientation.isConst) { gameOrientationInit(); item[items++] = &gameOrientation; }
 	aspectRatioInit(); item[items++] = &aspectRatio;
 	imgFilterInit(); item[items++] = &imgFilter;
+	videoFilterInit(); item[items++] = &videoFilter;
 	overlayEffectInit(); item[items++] = &overlayEffect;
 	overlayEffectLevelInit(); item[items++] = &overlayEffectLevel;
 	zoomInit(); item[items++] = &zoom;
@@ -817,6 +929,8 @@ void OptionView::loadAudioItems(MenuItem *item[], uint &items)
 	snd.init(optionSound); item[items++] = &snd;
 	snd.selectDelegate().bind<&soundHandler>();
 	if(!optionSoundRate.isConst) { audioRateInit(); item[items++] = &audioRate; }
+	framePacing.init(optionFramePacing); item[items++] = &framePacing;
+	framePacing.selectDelegate().bind<&framePacingHandler>();
 #ifdef CONFIG_AUDIO_CAN_USE_MAX_BUFFERS_HINT
 	soundBuffersInit(); item[items++] = &soundBuffers;
 #endif
@@ -860,6 +974,17 @@ void OptionView::loadSystemItems(MenuItem *item[], uint &items)
 	confirmAutoLoadState.selectDelegate().bind<&confirmAutoLoadStateHandler>();
 	confirmOverwriteState.init(optionConfirmOverwriteState); item[items++] = &confirmOverwriteState;
 	confirmOverwriteState.selectDelegate().bind<&confirmOverwriteStateHandler>();
+	emuThread.init(optionEmuThread); item[items++] = &emuThread;
+	emuThread.selectDelegate().bind<&emuThreadHandler>();
+	rewindBufferSizeInit(); item[items++] = &rewindBufferSize;
+	rewindIntervalInit(); item[items++] = &rewindInterval;
+	runAheadInit(); item[items++] = &runAhead;
+	#ifdef CONFIG_FRAME_PROFILER
+	showFrameProfile.init(optionShowFrameProfile); item[items++] = &showFrameProfile;
+	showFrameProfile.selectDelegate().bind<&showFrameProfileHandler>();
+	saveFrameProfile.init(); item[items++] = &saveFrameProfile;
+	saveFrameProfile.selectDelegate().bind<&saveFrameProfileHandler>();
+	#endif
 	printPathMenuEntryStr(savePathStr);
 	savePath.init(savePathStr, optionConfirmAutoLoadState); item[items++] = &savePath;
 	savePath.selectDelegate().bind<OptionView, &OptionView::savePathHandler>(this);
@@ -0,0 +1,163 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "romImage"
+#include <RomImage.hh>
+#ifdef CONFIG_IO_ARCHIVE
+#include <io/archive/ArchiveCache.hh>
+#endif
+#include <io/sys.hh>
+#include <util/strings.h>
+#ifdef CONFIG_IO_MMAP_FD
+#include <util/fd-utils.h>
+#include <sys/mman.h>
+#endif
+
+bool RomImage::open(const char *path, IoArchive::EntryFilter filter, const char *filterId,
+	uint flags, size_t minSize, char *nameOut, uint nameOutSize)
+{
+	close();
+	writable = flags & FLAG_WRITABLE;
+	#ifdef CONFIG_IO_ARCHIVE
+	bool isArchive = IoArchive::hasArchiveExtension(path);
+	#else
+	bool isArchive = 0;
+	#endif
+	#ifdef CONFIG_IO_MMAP_FD
+	if(!isArchive)
+	{
+		if(nameOut && nameOut != path)
+			string_copy(nameOut, path, nameOutSize);
+		return mapFile(path, minSize);
+	}
+	#endif
+	#ifdef CONFIG_IO_ARCHIVE
+	Io *io = ArchiveCache::openFile(path, filter, filterId, nameOut, nameOutSize);
+	#else
+	if(nameOut && nameOut != path)
+		string_copy(nameOut, path, nameOutSize);
+	Io *io = IoSys::open(path);
+	#endif
+	if(!io)
+		return 0;
+	auto src = io->mmapConst();
+	if(src && !writable && io->size() >= minSize)
+	{
+		// use the Io's memory as is
+		this->io = io;
+		data_ = (uchar*)src;
+		size_ = io->size();
+		return 1;
+	}
+	bool copied = copyIo(io, minSize);
+	delete io;
+	return copied;
+}
+
+#ifdef CONFIG_IO_MMAP_FD
+bool RomImage::mapFile(const char *path, size_t minSize)
+{
+	int fd = ::open(path, O_RDONLY);
+	if(fd == -1)
+	{
+		logErr("can't open %s", path);
+		return 0;
+	}
+	size_t fileSize = fd_size(fd);
+	size_t pageSize = sysconf(_SC_PAGESIZE);
+	size_t size = ((IG::max(fileSize, minSize) + pageSize - 1) / pageSize) * pageSize;
+	if(!size)
+	{
+		::close(fd);
+		return 0;
+	}
+	int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+	// reserve zero pages for any padding, then place the file at the start
+	void *base = mmap(nullptr, size, prot, MAP_PRIVATE | MAP_ANON, -1, 0);
+	if(base == MAP_FAILED)
+	{
+		logErr("can't reserve %d bytes", (int)size);
+		::close(fd);
+		return 0;
+	}
+	if(fileSize && mmap(base, fileSize, prot, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+	{
+		logErr("can't map %s", path);
+		munmap(base, size);
+		::close(fd);
+		return 0;
+	}
+	::close(fd);
+	data_ = (uchar*)base;
+	size_ = fileSize;
+	mapSize = size;
+	logMsg("mapped %d byte rom %s%s", (int)fileSize, path, writable ? " copy-on-write" : "");
+	return 1;
+}
+#endif
+
+uchar *RomImage::allocate(size_t size, size_t minSize)
+{
+	close();
+	size_t allocSize = IG::max(size, minSize);
+	data_ = (uchar*)mem_alloc(allocSize);
+	if(!data_)
+	{
+		logErr("out of memory for %d byte rom", (int)allocSize);
+		return nullptr;
+	}
+	memset(data_ + size, 0, allocSize - size);
+	size_ = size;
+	writable = 1;
+	return data_;
+}
+
+bool RomImage::copyIo(Io *io, size_t minSize)
+{
+	size_t fileSize = io->size();
+	bool wasWritable = writable;
+	if(!allocate(fileSize, minSize))
+		return 0;
+	writable = wasWritable;
+	if(io->read(data_, fileSize) != OK)
+	{
+		logErr("error reading rom");
+		close();
+		return 0;
+	}
+	return 1;
+}
+
+void RomImage::close()
+{
+	if(io)
+	{
+		delete io;
+		io = nullptr;
+	}
+	#ifdef CONFIG_IO_MMAP_FD
+	else if(mapSize)
+	{
+		munmap(data_, mapSize);
+		mapSize = 0;
+	}
+	#endif
+	else if(data_)
+	{
+		mem_free(data_);
+	}
+	data_ = nullptr;
+	size_ = 0;
+}
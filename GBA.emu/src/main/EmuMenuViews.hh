@@ -3,8 +3,24 @@
 
 class SystemOptionView : public OptionView
 {
+	BoolMenuItem renderThread {"Render On Worker Thread", BoolMenuItem::SelectDelegate::create<&renderThreadHandler>()};
+
+	static void renderThreadHandler(BoolMenuItem &item, const Input::Event &e)
+	{
+		item.toggle();
+		optionRenderThread = item.on;
+		if(EmuSystem::gameIsRunning() && !renderThreadSetActive(gGba, item.on))
+			logWarn("unable to start render thread");
+	}
+
 public:
 	constexpr SystemOptionView() { }
+
+	void loadVideoItems(MenuItem *item[], uint &items)
+	{
+		OptionView::loadVideoItems(item, items);
+		renderThread.init(optionRenderThread); item[items++] = &renderThread;
+	}
 };
 
 class SystemMenuView : public MenuView
@@ -25,11 +25,13 @@
 #include <util/strings.h>
 #include <util/time/sys.hh>
 #include <EmuSystem.hh>
+#include <RomImage.hh>
 #include <CommonFrameworkIncludes.hh>
 
 #include <vbam/gba/GBA.h>
 #include <vbam/gba/Sound.h>
 #include <vbam/common/SoundDriver.h>
+#include <vbam/gba/RenderThread.h>
 #include <vbam/Util.h>
 void setGameSpecificSettings(GBASys &gba);
 void CPULoop(GBASys &gba, bool renderGfx, bool processGfx, bool renderAudio);
@@ -41,6 +43,14 @@ bool CPUWriteState(GBASys &gba, const char *);
 
 const uint EmuSystem::maxPlayers = 1;
 uint EmuSystem::aspectRatioX = 3, EmuSystem::aspectRatioY = 2;
+
+enum
+{
+	CFGKEY_RENDER_THREAD = 256
+};
+
+static Byte1Option optionRenderThread(CFGKEY_RENDER_THREAD, 0);
+
 #include "CommonGui.hh"
 
 // controls
@@ -158,23 +168,24 @@ void EmuSystem::handleInputAction(uint state, uint emuKey)
 		setBits(P1, emuKey);
 }
 
-enum
-{
-	//	CFGKEY_* = 256 // no config keys defined yet
-};
-
 bool EmuSystem::readConfig(Io *io, uint key, uint readSize)
 {
 	switch(key)
 	{
 		default: return 0;
+		bcase CFGKEY_RENDER_THREAD: optionRenderThread.readFromIO(io, readSize);
 	}
 	return 1;
 }
 
 void EmuSystem::writeConfig(Io *io)
 {
+	optionRenderThread.writeWithKeyIfNotDefault(io);
+}
 
+static bool isGBAImage(const char *name)
+{
+	return utilIsGBAImage(name);
 }
 
 static bool isGBAExtension(const char *name)
@@ -244,20 +255,40 @@ int EmuSystem::saveState()
 	#ifdef CONFIG_BASE_IOS_SETUID
 		fixFilePermissions(saveStr);
 	#endif
-	if(CPUWriteState(gGba, saveStr))
-		return STATE_RESULT_OK;
-	else
-		return STATE_RESULT_IO_ERROR;
+	return saveStateFile(saveStr);
 }
 
 int EmuSystem::loadState(int saveStateSlot)
 {
 	FsSys::cPath saveStr;
 	sprintStateFilename(saveStr, saveStateSlot);
-	if(CPUReadState(gGba, saveStr))
+	// older .sgm files are inflated by loadStateFile() into data without the VBA header, which the memory reader also accepts
+	return loadStateFile(saveStr);
+}
+
+uint EmuSystem::stateBufferSize()
+{
+	// state size only depends on the game's save type, so measure it with a trial save
+	static const uint maxStateSize = 0x100000;
+	auto buff = (uchar*)mem_alloc(maxStateSize);
+	if(!buff)
+		return 0;
+	uint size = saveStateToBuffer(buff, maxStateSize);
+	mem_free(buff);
+	return size ? size + 0x1000 : 0;
+}
+
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size)
+{
+	return CPUWriteMemState(gGba, (char*)buff, size);
+}
+
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size)
+{
+	if(CPUReadMemState(gGba, (char*)buff, size))
 		return STATE_RESULT_OK;
 	else
-		return STATE_RESULT_IO_ERROR;
+		return STATE_RESULT_INVALID_DATA;
 }
 
 void EmuSystem::saveAutoState()
@@ -269,7 +300,7 @@ void EmuSystem::saveAutoState()
 		#ifdef CONFIG_BASE_IOS_SETUID
 			fixFilePermissions(saveStr);
 		#endif
-		CPUWriteState(gGba, saveStr);
+		saveStateFile(saveStr, 1);
 	}
 }
 
@@ -296,6 +327,7 @@ void EmuSystem::closeSystem()
 	assert(gameIsRunning());
 	logMsg("closing game %s", gameName);
 	saveBackupMem();
+	renderThreadSetActive(gGba, 0);
 	CPUCleanUp();
 }
 
@@ -306,7 +338,21 @@ int EmuSystem::loadGame(const char *path)
 	setupGamePaths(path);
 	systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
 	soundInit();
-	int size = CPULoadRom(gGba, fullGamePath);
+	int size = 0;
+	#ifndef CONFIG_IO_ARCHIVE
+	if(string_hasDotExtension(fullGamePath, "zip") || string_hasDotExtension(fullGamePath, "7z"))
+		size = CPULoadRom(gGba, fullGamePath); // extracted by fex
+	else
+	#endif
+	{
+		RomImage rom;
+		FsSys::cPath romName;
+		if(rom.open(fullGamePath, IoArchive::EntryFilter::create<&isGBAImage>(), "gba", 0, 0, romName, sizeof(romName)))
+		{
+			utilIsGBAImage(romName); // sets cpuIsMultiBoot from the ROM file name
+			size = CPULoadRomData(gGba, rom.data(), rom.size());
+		}
+	}
 	if(size == 0)
 	{
 		popup.postError("Error loading ROM");
@@ -315,6 +361,8 @@ int EmuSystem::loadGame(const char *path)
 	setGameSpecificSettings(gGba);
 	CPUInit(gGba, 0, 0);
 	CPUReset(gGba);
+	if(optionRenderThread && !renderThreadSetActive(gGba, 1))
+		logWarn("unable to start render thread");
 	FsSys::cPath saveStr;
 	snprintf(saveStr, sizeof(saveStr), "%s/%s.sav", savePath(), gameName);
 	CPUReadBatteryFile(gGba, saveStr);
@@ -377,7 +425,12 @@ void EmuSystem::configAudioRate()
 {
 	logMsg("set audio rate %d", (int)optionSoundRate);
 	pcmFormat.rate = optionSoundRate;
-	soundSetSampleRate(gGba, optionSoundRate *.9954);
+	soundSetSampleRate(gGba, optionSoundRate *.9954 * audioRateScale);
+}
+
+void EmuSystem::applyAudioRateScale()
+{
+	soundAdjustSampleRate(optionSoundRate *.9954 * audioRateScale);
 }
 
 void EmuSystem::savePathChanged() { }
@@ -385,7 +438,10 @@ void EmuSystem::savePathChanged() { }
 namespace Base
 {
 
-void onAppMessage(int type, int shortArg, int intArg, int intArg2) { }
+void onAppMessage(int type, int shortArg, int intArg, int intArg2)
+{
+	EmuIoWorker::onAppMessage(type, shortArg, intArg, intArg2);
+}
 
 CallResult onInit(int argc, char** argv)
 {
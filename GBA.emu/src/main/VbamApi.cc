@@ -1,6 +1,7 @@
 #include <vbam/gba/GBA.h>
 #include <vbam/gba/Sound.h>
 #include <vbam/gba/RTC.h>
+#include <vbam/gba/IdleLoop.h>
 #include <vbam/common/SoundDriver.h>
 #include <vbam/Util.h>
 #include <logger/interface.h>
@@ -57,6 +58,7 @@ struct GameSettings
 	int rtcEnabled;
 	int flashSize;
 	int mirroringEnabled;
+	bool noIdleLoopSkip; // the game misbehaves when its busy-wait loops are skipped
 };
 
 static void resetGameSettings()
@@ -65,6 +67,7 @@ static void resetGameSettings()
 	rtcEnable(0);
 	cpuSaveType = 0;
 	flashSetSize(0x10000);
+	idleLoopSkipping = 1;
 }
 
 void setGameSpecificSettings(GBASys &gba)
@@ -956,6 +959,11 @@ void setGameSpecificSettings(GBASys &gba)
 				logMsg("using mirroring");
 				mirroringEnable = e->mirroringEnabled;
 			}
+			if(e->noIdleLoopSkip)
+			{
+				logMsg("not skipping idle loops");
+				idleLoopSkipping = 0;
+			}
 			break;
 		}
 	}
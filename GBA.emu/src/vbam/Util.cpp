@@ -483,6 +483,75 @@ gzFile utilMemGzOpen(char *memory, int available, const char *mode)
   return memgzopen(memory, available, mode);
 }
 
+// uncompressed memory stream, each write or read is a single memcpy
+struct MemRawFile {
+  char *memory;
+  int available;
+  int pos; // keeps counting past the end so overruns can be detected
+};
+
+static int ZEXPORT memRawWrite(gzFile file, voidpc buffer, unsigned len)
+{
+  MemRawFile *f = (MemRawFile *)file;
+  if(f->pos + (int)len <= f->available)
+    memcpy(f->memory + f->pos, buffer, len);
+  f->pos += len;
+  return len;
+}
+
+static int ZEXPORT memRawRead(gzFile file, voidp buffer, unsigned len)
+{
+  MemRawFile *f = (MemRawFile *)file;
+  int copy = f->available - f->pos;
+  if(copy > (int)len)
+    copy = len;
+  if(copy < 0)
+    copy = 0;
+  memcpy(buffer, f->memory + f->pos, copy);
+  f->pos += len;
+  return copy;
+}
+
+static int ZEXPORT memRawClose(gzFile file)
+{
+  free(file);
+  return 0;
+}
+
+static z_off_t ZEXPORT memRawSeek(gzFile file, z_off_t offset, int whence)
+{
+  MemRawFile *f = (MemRawFile *)file;
+  if(whence == SEEK_SET)
+    f->pos = offset;
+  else if(whence == SEEK_CUR)
+    f->pos += offset;
+  else
+    return -1;
+  return f->pos;
+}
+
+gzFile utilMemRawOpen(char *memory, int available)
+{
+  utilGzWriteFunc = memRawWrite;
+  utilGzReadFunc = memRawRead;
+  utilGzCloseFunc = memRawClose;
+  utilGzSeekFunc = memRawSeek;
+
+  MemRawFile *f = (MemRawFile *)malloc(sizeof(MemRawFile));
+  if(f == NULL)
+    return NULL;
+  f->memory = memory;
+  f->available = available;
+  f->pos = 0;
+  return (gzFile)f;
+}
+
+// bytes written or read so far, more than the buffer holds after an overrun
+long utilMemRawTell(gzFile file)
+{
+  return ((MemRawFile *)file)->pos;
+}
+
 int utilGzWrite(gzFile file, const voidp buffer, unsigned int len)
 {
   return utilGzWriteFunc(file, buffer, len);
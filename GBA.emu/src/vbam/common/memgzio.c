@@ -67,6 +67,7 @@ typedef struct _MemFile {
   char *next;
   int available;
   int error;
+  int headerSize;
   char mode;
 } MEMFILE;
 
@@ -111,6 +112,7 @@ local MEMFILE *memOpen(char *memory, int available, char mode)
   f->memory = memory;
   f->mode = mode;
   f->error = 0;
+  f->headerSize = 8;
 
   if(mode == 'w') {
     f->available = available - 8;
@@ -120,14 +122,16 @@ local MEMFILE *memOpen(char *memory, int available, char mode)
     memory[2] = 'A';
     memory[3] = ' ';
     *((int *)(memory+4)) = 0;
-  } else {
-    if(memory[0] != 'V' || memory[1] != 'B' || memory[2] != 'A' ||
-       memory[3] != ' ') {
-      free(f);
-      return NULL;
-    }
+  } else if(memory[0] == 'V' && memory[1] == 'B' && memory[2] == 'A' &&
+       memory[3] == ' ') {
     f->available = *((int *)(memory+4));
     f->next = memory+8;
+  } else {
+    /* data without the VBA header, such as an inflated state file,
+       is read transparently if it has no gzip header either */
+    f->headerSize = 0;
+    f->available = available;
+    f->next = memory;
   }
 
   return f;
@@ -192,7 +196,7 @@ local int memPutc(int c, MEMFILE *file)
 
 local long memTell(MEMFILE *f)
 {
-  return (long)(f->next - f->memory) - 8;
+  return (long)(f->next - f->memory) - f->headerSize;
 }
 
 local int memError(MEMFILE *f)
@@ -0,0 +1,177 @@
+#include <string.h>
+#include "GBA.h"
+#include "BlockCache.h"
+
+u8 blockRamPageHasCode[blockRamPages] {0};
+bool blockCacheInvalidated = false;
+
+#ifdef VBAM_USE_BLOCK_CACHE
+
+static const uint blockPoolInsns = 0x20000;
+static const uint blockPoolBlocks = 0x8000;
+static const uint blockLookupSize = 0x10000; // direct-mapped, must be a power of 2
+
+static BlockInsn insnPool[blockPoolInsns];
+static Block blockPool[blockPoolBlocks];
+static u32 blockLookup[blockLookupSize]; // block index + 1, 0 if empty
+static s32 ramPageFirstBlock[blockRamPages];
+static uint usedInsns = 0, usedBlocks = 0;
+
+static uint lookupSlot(u32 pc)
+{
+	return ((pc >> 1) ^ ((pc >> 24) << 12)) & (blockLookupSize - 1);
+}
+
+void blockCacheFlush()
+{
+	if(!usedBlocks)
+		return;
+	memset(blockLookup, 0, sizeof(blockLookup));
+	memset(blockRamPageHasCode, 0, sizeof(blockRamPageHasCode));
+	usedInsns = usedBlocks = 0;
+	blockCacheInvalidated = true;
+}
+
+void blockCacheInvalidateRamPage(uint page)
+{
+	for(s32 i = ramPageFirstBlock[page]; i != -1; i = blockPool[i].nextInPage)
+	{
+		auto &slot = blockLookup[lookupSlot(blockPool[i].pc)];
+		if(slot == (u32)i + 1)
+			slot = 0;
+	}
+	blockRamPageHasCode[page] = 0;
+	blockCacheInvalidated = true;
+}
+
+Block *blockCacheLookup(u32 pc, bool arm)
+{
+	u32 idx = blockLookup[lookupSlot(pc)];
+	if(!idx)
+		return nullptr;
+	Block &block = blockPool[idx - 1];
+	if(block.pc != pc || block.arm != arm)
+		return nullptr;
+	return &block;
+}
+
+Block *blockCacheNew(u32 pc, bool arm, uint insnSize, uint &maxInsns)
+{
+	maxInsns = blockMaxInsns;
+	switch(pc >> 24)
+	{
+		case 0x00:
+			if(pc >= 0x4000)
+				return nullptr;
+			break;
+		case 0x02:
+		case 0x03:
+		{
+			// keep RAM blocks inside one page so a write only needs to check one
+			u32 pageEnd = (pc | ((1 << blockRamPageShift) - 1)) + 1;
+			if((pageEnd - pc) / insnSize < maxInsns)
+				maxInsns = (pageEnd - pc) / insnSize;
+			break;
+		}
+		case 0x08 ... 0x0D:
+			break;
+		default:
+			return nullptr;
+	}
+	if(usedInsns + blockMaxInsns > blockPoolInsns || usedBlocks == blockPoolBlocks)
+	{
+		logMsg("block cache full, flushing");
+		blockCacheFlush();
+	}
+	Block &block = blockPool[usedBlocks];
+	block.pc = pc;
+	block.arm = arm;
+	block.insnStart = usedInsns;
+	block.insns = 0;
+	block.idleLoopInsns = 0;
+	block.nextInPage = -1;
+	return &block;
+}
+
+void blockCacheCommit(Block &block, uint insns)
+{
+	block.insns = insns;
+	s32 idx = &block - blockPool;
+	int page = blockRamPage(block.pc);
+	if(page != -1)
+	{
+		if(!blockRamPageHasCode[page])
+			ramPageFirstBlock[page] = -1;
+		block.nextInPage = ramPageFirstBlock[page];
+		ramPageFirstBlock[page] = idx;
+		blockRamPageHasCode[page] = 1;
+	}
+	blockLookup[lookupSlot(block.pc)] = idx + 1;
+	usedInsns += insns;
+	usedBlocks++;
+}
+
+BlockInsn *blockCacheInsns(const Block &block)
+{
+	return &insnPool[block.insnStart];
+}
+
+#else
+
+void blockCacheFlush() { }
+void blockCacheInvalidateRamPage(uint page) { }
+
+#endif
+
+#ifdef VBAM_VALIDATE_BLOCK_CACHE
+
+static u8 internalRAMSnapshot[sizeof(GBAMem::internalRAM)];
+static u8 workRAMSnapshot[sizeof(GBAMem::workRAM)];
+static u8 ioMemSnapshot[sizeof(GBAMem::IoMem)];
+
+void BlockValidator::begin(ARM7TDMI &cpu)
+{
+	auto &mem = cpu.gba->mem;
+	start = cpu;
+	memcpy(internalRAMSnapshot, mem.internalRAM, sizeof(internalRAMSnapshot));
+	memcpy(workRAMSnapshot, mem.workRAM, sizeof(workRAMSnapshot));
+	memcpy(ioMemSnapshot, &mem.ioMem, sizeof(ioMemSnapshot));
+}
+
+void BlockValidator::rewind(ARM7TDMI &cpu)
+{
+	auto &mem = cpu.gba->mem;
+	result = cpu;
+	cpu = start;
+	memcpy(mem.internalRAM, internalRAMSnapshot, sizeof(internalRAMSnapshot));
+	memcpy(mem.workRAM, workRAMSnapshot, sizeof(workRAMSnapshot));
+	memcpy(&mem.ioMem, ioMemSnapshot, sizeof(ioMemSnapshot));
+	blockCacheSyncPrefetch(cpu);
+}
+
+void BlockValidator::check(const ARM7TDMI &cpu, u32 blockPC, uint insns)
+{
+	bool match = cpu.armNextPC == result.armNextPC
+		&& cpu.cpuTotalTicks == result.cpuTotalTicks
+		&& cpu.armState == result.armState
+		&& cpu.armMode == result.armMode
+		&& cpu.nFlag() == result.nFlag() && cpu.zFlag() == result.zFlag()
+		&& cpu.cFlag() == result.cFlag() && cpu.vFlag() == result.vFlag()
+		&& cpu.busPrefetchCount == result.busPrefetchCount;
+	iterateTimes(17, i)
+	{
+		if(cpu.reg[i].I != result.reg[i].I)
+		{
+			logMsg("block %08X: r%d is %08X, interpreter has %08X", blockPC, i, result.reg[i].I, cpu.reg[i].I);
+			match = false;
+		}
+	}
+	if(!match)
+	{
+		logMsg("block %08X (%s, %d insns) diverged from interpreter: pc %08X/%08X ticks %d/%d",
+			blockPC, start.armState ? "ARM" : "THUMB", insns,
+			result.armNextPC, cpu.armNextPC, result.cpuTotalTicks, cpu.cpuTotalTicks);
+	}
+}
+
+#endif
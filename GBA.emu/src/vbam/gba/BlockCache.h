@@ -0,0 +1,99 @@
+#ifndef GBA_BLOCKCACHE_H
+#define GBA_BLOCKCACHE_H
+
+#include "GBA.h"
+#include "GBAcpu.h"
+
+// Caches runs of pre-decoded ARM/THUMB instructions keyed by start address.
+// A cached block stores each instruction's handler & opcode so the CPU loop
+// skips the per-instruction fetch through cpu.map, the pipeline prefetch and
+// the handler table lookup. Blocks in EWRAM/IWRAM are dropped when their
+// 256-byte page is written.
+
+#if defined(VBAM_USE_BLOCK_CACHE) && defined(BKPT_SUPPORT)
+#undef VBAM_USE_BLOCK_CACHE // breakpoints need the interpreter
+#endif
+
+typedef int (*ThumbInsnFunc)(ARM7TDMI &cpu, u32 opcode, u32 oldArmNextPC);
+typedef void (*ArmInsnFunc)(ARM7TDMI &cpu, u32 opcode, int &clockTicks);
+
+struct BlockInsn
+{
+	union
+	{
+		ThumbInsnFunc thumb;
+		ArmInsnFunc arm;
+	};
+	u32 opcode;
+};
+
+struct Block
+{
+	u32 pc;
+	u32 insnStart;
+	u16 insns;
+	bool arm;
+	u8 idleLoopInsns; // length of the idle loop at the block start, or 0
+	s32 nextInPage; // next block in the same RAM page, or -1
+};
+
+static const uint blockMaxInsns = 64;
+static const uint blockRamPageShift = 8;
+static const uint blockEwramPages = 0x40000 >> blockRamPageShift;
+static const uint blockRamPages = blockEwramPages + (0x8000 >> blockRamPageShift);
+
+extern u8 blockRamPageHasCode[blockRamPages];
+extern bool blockCacheInvalidated; // set when a running block may be stale
+
+void blockCacheFlush();
+void blockCacheInvalidateRamPage(uint page);
+Block *blockCacheLookup(u32 pc, bool arm);
+// returns a block with room for maxInsns or nullptr if pc can't be cached
+Block *blockCacheNew(u32 pc, bool arm, uint insnSize, uint &maxInsns);
+void blockCacheCommit(Block &block, uint insns);
+BlockInsn *blockCacheInsns(const Block &block);
+
+static inline int blockRamPage(u32 address)
+{
+	switch(address >> 24)
+	{
+		case 0x02: return (address & 0x3FFFF) >> blockRamPageShift;
+		case 0x03: return blockEwramPages + ((address & 0x7FFF) >> blockRamPageShift);
+		default: return -1;
+	}
+}
+
+// call after writing EWRAM/IWRAM
+static inline void blockCacheCheckWrite(u32 address)
+{
+#ifdef VBAM_USE_BLOCK_CACHE
+	int page = blockRamPage(address);
+	if(UNLIKELY(blockRamPageHasCode[page]))
+		blockCacheInvalidateRamPage(page);
+#endif
+}
+
+static inline void blockCacheSyncPrefetch(ARM7TDMI &cpu)
+{
+	if(cpu.armState)
+		cpu.ARM_PREFETCH();
+	else
+		cpu.THUMB_PREFETCH();
+}
+
+#ifdef VBAM_VALIDATE_BLOCK_CACHE
+// Re-runs each block with the interpreter from a snapshot of the CPU & RAM
+// and logs any difference. I/O register side effects happen twice so this is
+// only meant for debugging the cache itself.
+struct BlockValidator
+{
+	constexpr BlockValidator(): start(nullptr), result(nullptr) { }
+	ARM7TDMI start;
+	ARM7TDMI result;
+	void begin(ARM7TDMI &cpu);
+	void rewind(ARM7TDMI &cpu);
+	void check(const ARM7TDMI &cpu, u32 blockPC, uint insns);
+};
+#endif
+
+#endif // GBA_BLOCKCACHE_H
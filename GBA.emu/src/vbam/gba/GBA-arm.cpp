@@ -7,6 +7,8 @@
 #include "GBA.h"
 #include "GBAcpu.h"
 #include "GBAinline.h"
+#include "BlockCache.h"
+#include "IdleLoop.h"
 #include "Globals.h"
 #include "EEprom.h"
 #include "Flash.h"
@@ -2293,38 +2295,8 @@ static void tester(void) {
 }
 #endif
 
-int armExecute(ARM7TDMI &cpu)
+static inline ATTRS(always_inline) bool armConditionPassed(ARM7TDMI &cpu, u32 opcode)
 {
-	//ARM7TDMI cpu = cpuO;
-	int &cpuNextEvent = cpu.cpuNextEvent;
-	int &cpuTotalTicks = cpu.cpuTotalTicks;
-    do {
-		if( cheatsEnabled ) {
-			cpuMasterCodeCheck(cpu);
-		}
-
-        if ((armNextPC & 0x0803FFFF) == 0x08020000)
-          busPrefetchCount = 0x100;
-
-        u32 opcode = cpu.prefetchArmOpcode();
-
-        busPrefetch = false;
-        if (busPrefetchCount & 0xFFFFFE00)
-            busPrefetchCount = 0x100 | (busPrefetchCount & 0xFF);
-
-        int clockTicks = 0;
-        int oldArmNextPC = armNextPC;
-
-#ifndef FINAL_VERSION
-        if (armNextPC == stop) {
-            armNextPC++;
-        }
-#endif
-
-        armNextPC = reg[15].I;
-        reg[15].I += 4;
-        ARM_PREFETCH_NEXT;
-
         int cond = opcode >> 28;
         u32 cond_res = true;
         if (UNLIKELY(cond != 0x0E)) {  // most opcodes are AL (always)
@@ -2382,20 +2354,174 @@ int armExecute(ARM7TDMI &cpu)
             }
         }
 
+        return cond_res;
+}
+
+static inline ATTRS(always_inline) int armStep(ARM7TDMI &cpu)
+{
+        if ((armNextPC & 0x0803FFFF) == 0x08020000)
+          busPrefetchCount = 0x100;
+
+        u32 opcode = cpu.prefetchArmOpcode();
+
+        busPrefetch = false;
+        if (busPrefetchCount & 0xFFFFFE00)
+            busPrefetchCount = 0x100 | (busPrefetchCount & 0xFF);
+
+        int clockTicks = 0;
+        int oldArmNextPC = armNextPC;
+
+#ifndef FINAL_VERSION
+        if (armNextPC == stop) {
+            armNextPC++;
+        }
+#endif
+
+        armNextPC = reg[15].I;
+        reg[15].I += 4;
+        ARM_PREFETCH_NEXT;
+
+        bool cond_res = armConditionPassed(cpu, opcode);
         if (cond_res)
             (*armInsnTable[((opcode>>16)&0xFF0) | ((opcode>>4)&0x0F)])(cpu, opcode, clockTicks);
 #ifdef INSN_COUNTER
         count(opcode, cond_res);
 #endif
 				#ifdef BKPT_SUPPORT
+        if (clockTicks < 0)
+            return clockTicks;
+				#endif
+        if (clockTicks == 0)
+            clockTicks = 1 + codeTicksAccessSeq32(cpu, oldArmNextPC);
+        return clockTicks;
+}
+
+#ifdef VBAM_USE_BLOCK_CACHE
+
+// true for unconditional instructions that always leave the sequential path
+static bool armInsnEndsBlock(u32 opcode)
+{
+    if ((opcode >> 28) != 0x0E)
+        return false;
+    return (opcode & 0x0E000000) == 0x0A000000 // B, BL
+        || (opcode & 0x0FFFFFF0) == 0x012FFF10 // BX
+        || (opcode & 0x0E108000) == 0x08108000 // LDM with pc
+        || (opcode & 0x0C10F000) == 0x0410F000 // LDR pc
+        || (opcode & 0x0C00F000) == 0x0000F000 // data processing to pc
+        || (opcode & 0x0F000000) == 0x0F000000; // SWI
+}
+
+static Block *armCompileBlock(ARM7TDMI &cpu, u32 pc)
+{
+    uint maxInsns;
+    Block *block = blockCacheNew(pc, true, 4, maxInsns);
+    if (!block)
+        return nullptr;
+    BlockInsn *insn = blockCacheInsns(*block);
+    uint insns = 0;
+    while (insns < maxInsns) {
+        u32 opcode = CPUReadMemoryQuick(cpu, pc + insns * 4);
+        insn[insns].arm = armInsnTable[((opcode>>16)&0xFF0) | ((opcode>>4)&0x0F)];
+        insn[insns].opcode = opcode;
+        insns++;
+        if (armInsnEndsBlock(opcode))
+            break;
+    }
+    block->idleLoopInsns = armIdleLoopInsns(insn, insns, pc);
+    blockCacheCommit(*block, insns);
+    return block;
+}
+
+// runs a block until it ends, branches, an event is due or its code changes
+static uint armRunBlock(ARM7TDMI &cpu, const Block &block)
+{
+    int &cpuNextEvent = cpu.cpuNextEvent;
+    int &cpuTotalTicks = cpu.cpuTotalTicks;
+    const BlockInsn *insn = blockCacheInsns(block);
+    const BlockInsn *end = insn + block.insns;
+    blockCacheInvalidated = false;
+    u32 oldArmNextPC;
+    do {
+        if ((armNextPC & 0x0803FFFF) == 0x08020000)
+          busPrefetchCount = 0x100;
+        busPrefetch = false;
+        if (busPrefetchCount & 0xFFFFFE00)
+            busPrefetchCount = 0x100 | (busPrefetchCount & 0xFF);
+
+        int clockTicks = 0;
+        oldArmNextPC = armNextPC;
+        armNextPC = reg[15].I;
+        reg[15].I += 4;
+        if (armConditionPassed(cpu, insn->opcode))
+            insn->arm(cpu, insn->opcode, clockTicks);
+        if (clockTicks == 0)
+            clockTicks = 1 + codeTicksAccessSeq32(cpu, oldArmNextPC);
+        cpuTotalTicks += clockTicks;
+        insn++;
+    } while (insn != end && armNextPC == oldArmNextPC + 4
+        && cpuTotalTicks < cpuNextEvent && !blockCacheInvalidated);
+    return insn - blockCacheInsns(block);
+}
+
+static int armExecuteBlocks(ARM7TDMI &cpu)
+{
+    int &cpuNextEvent = cpu.cpuNextEvent;
+    int &cpuTotalTicks = cpu.cpuTotalTicks;
+#ifdef VBAM_VALIDATE_BLOCK_CACHE
+    static BlockValidator validator;
+#endif
+    do {
+        const Block *block = blockCacheLookup(armNextPC, true);
+        if (UNLIKELY(!block))
+            block = armCompileBlock(cpu, armNextPC);
+        if (UNLIKELY(!block)) {
+            // code outside cacheable memory
+            ARM_PREFETCH;
+            cpuTotalTicks += armStep(cpu);
+            continue;
+        }
+#ifdef VBAM_VALIDATE_BLOCK_CACHE
+        validator.begin(cpu);
+        uint insns = armRunBlock(cpu, *block);
+        validator.rewind(cpu);
+        iterateTimes(insns, i) {
+            cpuTotalTicks += armStep(cpu);
+        }
+        validator.check(cpu, block->pc, insns);
+#else
+        uint insns = armRunBlock(cpu, *block);
+#endif
+        idleLoopCheck(cpu, *block, insns);
+    } while (cpuTotalTicks < cpuNextEvent && armState);
+    blockCacheSyncPrefetch(cpu);
+    return 1;
+}
+
+#endif
+
+int armExecute(ARM7TDMI &cpu)
+{
+	//ARM7TDMI cpu = cpuO;
+	int &cpuNextEvent = cpu.cpuNextEvent;
+	int &cpuTotalTicks = cpu.cpuTotalTicks;
+#ifdef VBAM_USE_BLOCK_CACHE
+	if(LIKELY(!cheatsEnabled))
+		return armExecuteBlocks(cpu);
+	blockCacheFlush(); // cheats can patch code
+#endif
+    do {
+		if( cheatsEnabled ) {
+			cpuMasterCodeCheck(cpu);
+		}
+
+        int clockTicks = armStep(cpu);
+				#ifdef BKPT_SUPPORT
         if (clockTicks < 0)
         {
         	//cpuO = cpu;
             return 0;
         }
 				#endif
-        if (clockTicks == 0)
-            clockTicks = 1 + codeTicksAccessSeq32(cpu, oldArmNextPC);
         cpuTotalTicks += clockTicks;
 
     } while (cpuTotalTicks<cpuNextEvent &&
@@ -7,6 +7,8 @@
 #include "GBA.h"
 #include "GBAcpu.h"
 #include "GBAinline.h"
+#include "BlockCache.h"
+#include "IdleLoop.h"
 #include "Globals.h"
 #include "EEprom.h"
 #include "Flash.h"
@@ -1730,19 +1732,8 @@ static const insnfunc_t thumbInsnTable[1024] = {
 
 // Wrapper routine (execution loop) ///////////////////////////////////////
 
-int thumbExecute(ARM7TDMI &cpu)
+static inline ATTRS(always_inline) int thumbStep(ARM7TDMI &cpu)
 {
-	//ARM7TDMI cpu = cpuO;
-	int &cpuNextEvent = cpu.cpuNextEvent;
-	int &cpuTotalTicks = cpu.cpuTotalTicks;
-  do {
-	  if( cheatsEnabled ) {
-		  cpuMasterCodeCheck(cpu);
-	  }
-
-    //if ((armNextPC & 0x0803FFFF) == 0x08020000)
-    //    busPrefetchCount=0x100;
-
     u32 opcode = cpu.prefetchThumbOpcode();
 
     busPrefetch = false;
@@ -1760,7 +1751,123 @@ int thumbExecute(ARM7TDMI &cpu)
     reg[15].I += 2;
     THUMB_PREFETCH_NEXT;
 
-    int clockTicks = (*thumbInsnTable[opcode>>6])(cpu, opcode, oldArmNextPC);
+    return (*thumbInsnTable[opcode>>6])(cpu, opcode, oldArmNextPC);
+}
+
+#ifdef VBAM_USE_BLOCK_CACHE
+
+// true for instructions that always leave the sequential path
+static bool thumbInsnEndsBlock(u32 opcode)
+{
+  return (opcode & 0xF800) == 0xE000 // B
+    || (opcode & 0xFF00) == 0x4700 // BX
+    || (opcode & 0xFF00) == 0xBD00 // POP {pc}
+    || (opcode & 0xF800) == 0xF800 // BL low
+    || (opcode & 0xFF00) == 0xDF00 // SWI
+    || (opcode & 0xFD87) == 0x4487; // ADD/MOV pc, Rs
+}
+
+static Block *thumbCompileBlock(ARM7TDMI &cpu, u32 pc)
+{
+  uint maxInsns;
+  Block *block = blockCacheNew(pc, false, 2, maxInsns);
+  if(!block)
+    return nullptr;
+  BlockInsn *insn = blockCacheInsns(*block);
+  uint insns = 0;
+  while(insns < maxInsns)
+  {
+    u32 opcode = CPUReadHalfWordQuick(cpu, pc + insns * 2);
+    insn[insns].thumb = thumbInsnTable[opcode>>6];
+    insn[insns].opcode = opcode;
+    insns++;
+    if(thumbInsnEndsBlock(opcode))
+      break;
+  }
+  block->idleLoopInsns = thumbIdleLoopInsns(insn, insns, pc);
+  blockCacheCommit(*block, insns);
+  return block;
+}
+
+// runs a block until it ends, branches, an event is due or its code changes
+static uint thumbRunBlock(ARM7TDMI &cpu, const Block &block)
+{
+  int &cpuNextEvent = cpu.cpuNextEvent;
+  int &cpuTotalTicks = cpu.cpuTotalTicks;
+  const BlockInsn *insn = blockCacheInsns(block);
+  const BlockInsn *end = insn + block.insns;
+  blockCacheInvalidated = false;
+  u32 oldArmNextPC;
+  do
+  {
+    busPrefetch = false;
+    oldArmNextPC = armNextPC;
+    armNextPC = reg[15].I;
+    reg[15].I += 2;
+    cpuTotalTicks += insn->thumb(cpu, insn->opcode, oldArmNextPC);
+    insn++;
+  } while(insn != end && armNextPC == oldArmNextPC + 2
+    && cpuTotalTicks < cpuNextEvent && !blockCacheInvalidated);
+  return insn - blockCacheInsns(block);
+}
+
+static int thumbExecuteBlocks(ARM7TDMI &cpu)
+{
+  int &cpuNextEvent = cpu.cpuNextEvent;
+  int &cpuTotalTicks = cpu.cpuTotalTicks;
+#ifdef VBAM_VALIDATE_BLOCK_CACHE
+  static BlockValidator validator;
+#endif
+  do {
+    const Block *block = blockCacheLookup(armNextPC, false);
+    if(UNLIKELY(!block))
+      block = thumbCompileBlock(cpu, armNextPC);
+    if(UNLIKELY(!block))
+    {
+      // code outside cacheable memory
+      THUMB_PREFETCH;
+      cpuTotalTicks += thumbStep(cpu);
+      continue;
+    }
+#ifdef VBAM_VALIDATE_BLOCK_CACHE
+    validator.begin(cpu);
+    uint insns = thumbRunBlock(cpu, *block);
+    validator.rewind(cpu);
+    iterateTimes(insns, i)
+    {
+      cpuTotalTicks += thumbStep(cpu);
+    }
+    validator.check(cpu, block->pc, insns);
+#else
+    uint insns = thumbRunBlock(cpu, *block);
+#endif
+    idleLoopCheck(cpu, *block, insns);
+  } while (cpuTotalTicks < cpuNextEvent && !armState);
+  blockCacheSyncPrefetch(cpu);
+  return 1;
+}
+
+#endif
+
+int thumbExecute(ARM7TDMI &cpu)
+{
+	//ARM7TDMI cpu = cpuO;
+	int &cpuNextEvent = cpu.cpuNextEvent;
+	int &cpuTotalTicks = cpu.cpuTotalTicks;
+#ifdef VBAM_USE_BLOCK_CACHE
+	if(LIKELY(!cheatsEnabled))
+		return thumbExecuteBlocks(cpu);
+	blockCacheFlush(); // cheats can patch code
+#endif
+  do {
+	  if( cheatsEnabled ) {
+		  cpuMasterCodeCheck(cpu);
+	  }
+
+    //if ((armNextPC & 0x0803FFFF) == 0x08020000)
+    //    busPrefetchCount=0x100;
+
+    int clockTicks = thumbStep(cpu);
 
 		#ifdef BKPT_SUPPORT
     if (clockTicks < 0)
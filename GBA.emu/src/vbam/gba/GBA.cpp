@@ -8,6 +8,7 @@
 #include "GBAinline.h"
 #include "Globals.h"
 #include "GBAGfx.h"
+#include "RenderThread.h"
 #include "EEprom.h"
 #include "Flash.h"
 #include "Sound.h"
@@ -23,6 +24,7 @@
 #include "GBALink.h"
 #include <logger/interface.h>
 #include <io/sys.hh>
+#include <util/time/FrameProfiler.hh>
 
 #ifdef PROFILING
 #include "prof/prof.h"
@@ -676,50 +678,35 @@ inline int CPUUpdateTicks(ARM7TDMI &cpu)
 
 static void CPUUpdateWindow0(GBASys &gba)
 {
-  int x00 = gba.mem.ioMem.WIN0H>>8;
-  int x01 = gba.mem.ioMem.WIN0H & 255;
-
-  if(x00 <= x01) {
-    for(int i = 0; i < 240; i++) {
-      gba.lcd.gfxInWin0[i] = (i >= x00 && i < x01);
-    }
-  } else {
-    for(int i = 0; i < 240; i++) {
-    	gba.lcd.gfxInWin0[i] = (i >= x00 || i < x01);
-    }
-  }
+  gfxUpdateWindow(gba.lcd.gfxInWin0, gba.mem.ioMem.WIN0H);
 }
 
 static void CPUUpdateWindow1(GBASys &gba)
 {
-  int x00 = gba.mem.ioMem.WIN1H>>8;
-  int x01 = gba.mem.ioMem.WIN1H & 255;
-
-  if(x00 <= x01) {
-    for(int i = 0; i < 240; i++) {
-    	gba.lcd.gfxInWin1[i] = (i >= x00 && i < x01);
-    }
-  } else {
-    for(int i = 0; i < 240; i++) {
-    	gba.lcd.gfxInWin1[i] = (i >= x00 || i < x01);
-    }
-  }
+  gfxUpdateWindow(gba.lcd.gfxInWin1, gba.mem.ioMem.WIN1H);
 }
 
 static void CPUUpdateRenderBuffers(GBASys &gba, bool force)
 {
+  uint cleared = 0;
   if(!(gba.lcd.layerEnable & 0x0100) || force) {
     gfxClearArray(gba.lcd.line0);
+    cleared |= 1;
   }
   if(!(gba.lcd.layerEnable & 0x0200) || force) {
   	gfxClearArray(gba.lcd.line1);
+  	cleared |= 2;
   }
   if(!(gba.lcd.layerEnable & 0x0400) || force) {
   	gfxClearArray(gba.lcd.line2);
+  	cleared |= 4;
   }
   if(!(gba.lcd.layerEnable & 0x0800) || force) {
   	gfxClearArray(gba.lcd.line3);
+  	cleared |= 8;
   }
+  if(renderThreadActive)
+    renderThreadClearLines(cleared);
 }
 
 static bool CPUWriteState(GBASys &gba, gzFile gzFile)
@@ -751,8 +738,6 @@ static bool CPUWriteState(GBASys &gba, gzFile gzFile)
   utilGzWrite(gzFile, gba.mem.workRAM, 0x40000);
   utilGzWrite(gzFile, gba.lcd.vram, 0x20000);
   utilGzWrite(gzFile, gba.lcd.oam, 0x400);
-  u32 dummyPix[241*162] = {0};
-  utilGzWrite(gzFile, dummyPix, 4*241*162);
   utilGzWrite(gzFile, gba.mem.ioMem.b, 0x400);
 
   eepromSaveGame(gzFile);
@@ -783,24 +768,33 @@ bool CPUWriteState(GBASys &gba, const char *file)
   return res;
 }
 
-bool CPUWriteMemState(GBASys &gba, char *memory, int available)
+// memory states start with this instead of the "VBA " header & gzip stream
+// of memgzio, the rest is copied as-is so they're cheap to take often
+static char rawStateMagic[4] = {'G', 'B', 'A', 'S'};
+
+// returns the number of bytes written or 0 on error, data is stored without
+// compression since callers like rewind do their own delta encoding
+int CPUWriteMemState(GBASys &gba, char *memory, int available)
 {
-  gzFile gzFile = utilMemGzOpen(memory, available, "w");
+  gzFile gzFile = utilMemRawOpen(memory, available);
 
   if(gzFile == NULL) {
-    return false;
+    return 0;
   }
 
+  utilGzWrite(gzFile, rawStateMagic, sizeof(rawStateMagic));
   bool res = CPUWriteState(gba, gzFile);
 
-  long pos = utilGzMemTell(gzFile)+8;
+  long size = utilMemRawTell(gzFile);
 
-  if(pos >= (available))
+  if(size > available)
     res = false;
 
   utilGzClose(gzFile);
 
-  return res;
+  if(!res)
+    return 0;
+  return size;
 }
 
 static bool CPUReadState(GBASys &gba, gzFile gzFile)
@@ -878,11 +872,12 @@ static bool CPUReadState(GBASys &gba, gzFile gzFile)
   utilGzRead(gzFile, gba.mem.workRAM, 0x40000);
   utilGzRead(gzFile, gba.lcd.vram, 0x20000);
   utilGzRead(gzFile, gba.lcd.oam, 0x400);
-  u32 dummyPix[241*162];
+  blockCacheFlush();
+  // skip the unused pixel buffer of older versions
   if(version < SAVE_GAME_VERSION_6)
-    utilGzRead(gzFile, dummyPix, 4*240*160);
-  else
-    utilGzRead(gzFile, dummyPix, 4*241*162);
+    utilGzSeek(gzFile, 4*240*160, SEEK_CUR);
+  else if(version < SAVE_GAME_VERSION_11)
+    utilGzSeek(gzFile, 4*241*162, SEEK_CUR);
   utilGzRead(gzFile, gba.mem.ioMem.b, 0x400);
 
   if(skipSaveGameBattery) {
@@ -946,6 +941,7 @@ static bool CPUReadState(GBASys &gba, gzFile gzFile)
   CPUUpdateRenderBuffers(gba, true);
   CPUUpdateWindow0(gba);
   CPUUpdateWindow1(gba);
+  renderThreadResync(gba);
   gbaSaveType = 0;
   switch(saveType) {
   case 0:
@@ -986,8 +982,31 @@ static bool CPUReadState(GBASys &gba, gzFile gzFile)
 
 bool CPUReadMemState(GBASys &gba, char *memory, int available)
 {
+  int magicSize = sizeof(rawStateMagic);
+  if(available > magicSize && memcmp(memory, rawStateMagic, magicSize) == 0) {
+    gzFile gzFile = utilMemRawOpen(memory + magicSize, available - magicSize);
+
+    if(gzFile == NULL)
+      return false;
+
+    bool res = CPUReadState(gba, gzFile);
+
+    if(utilMemRawTell(gzFile) > available - magicSize) {
+      logErr("state data ends early");
+      res = false;
+    }
+
+    utilGzClose(gzFile);
+
+    return res;
+  }
+
+  // legacy states in a memgzio stream, or inflated .sgm data
   gzFile gzFile = utilMemGzOpen(memory, available, "r");
 
+  if(gzFile == NULL)
+    return false;
+
   bool res = CPUReadState(gba, gzFile);
 
   utilGzClose(gzFile);
@@ -1442,9 +1461,12 @@ void CPUCleanUp()
   elfCleanUp();
 #endif //NO_DEBUGGER
 
+  blockCacheFlush();
   systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
 }
 
+static int CPULoadRomFinish(GBASys &gba);
+
 int CPULoadRom(GBASys &gba, const char *szFile)
 {
   romSize = 0x2000000;
@@ -1483,6 +1505,29 @@ int CPULoadRom(GBASys &gba, const char *szFile)
 	  }
   }
 
+  return CPULoadRomFinish(gba);
+}
+
+int CPULoadRomData(GBASys &gba, const u8 *data, int size)
+{
+  romSize = 0x2000000;
+
+  systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
+
+  memset(gba.mem.workRAM, 0, sizeof(gba.mem.workRAM));
+
+  u8 *whereToLoad = cpuIsMultiBoot ? gba.mem.workRAM : gba.mem.rom;
+  int maxSize = cpuIsMultiBoot ? (int)sizeof(gba.mem.workRAM) : romSize;
+  if(size <= 0)
+    return 0;
+  romSize = size < maxSize ? size : maxSize;
+  memcpy(whereToLoad, data, romSize);
+
+  return CPULoadRomFinish(gba);
+}
+
+static int CPULoadRomFinish(GBASys &gba)
+{
   u16 *temp = (u16 *)(gba.mem.rom+((romSize+1)&~1));
   int i;
   for(i = (romSize+1)&~1; i < 0x2000000; i+=2) {
@@ -2997,6 +3042,7 @@ void CPUInit(GBASys &gba, const char *biosFileName, bool useBiosFile)
 
 void CPUReset(GBASys &gba)
 {
+  blockCacheFlush();
   if(gbaSaveType == 0) {
     if(eepromInUse)
       gbaSaveType = 3;
@@ -3177,6 +3223,8 @@ void CPUReset(GBASys &gba)
 
   gba.dma.cpuDmaHack = false;
 
+  renderThreadResync(gba);
+
   //SWITicks = 0;
 }
 
@@ -3400,7 +3448,17 @@ void CPULoop(GBASys &gba, bool renderGfx, bool processGfx, bool renderAudio)
             	{
             	}*/
 
-              (*gba.lcd.renderLine)(gba.lcd.lineMix, gba.lcd, ioMem);
+              {
+                profileZone(ZONE_VIDEO);
+                if(renderThreadActive)
+                {
+                  renderThreadQueueLine(gba);
+                  if(ioMem.VCOUNT == 159)
+                    renderThreadWait(); // frame must be complete before it's shown
+                }
+                else
+                  (*gba.lcd.renderLine)(gba.lcd.lineMix, gba.lcd, ioMem);
+              }
               /*switch(systemColorDepth) {
 				#ifdef SUPPORT_PIX_16BIT
                 case 16:
@@ -3731,6 +3789,7 @@ void CPULoop(GBASys &gba, bool renderGfx, bool processGfx, bool renderAudio)
     }
   } while(!cpuBreakLoop);
 
+  renderThreadWait();
   gba.cpu = cpu;
 }
 
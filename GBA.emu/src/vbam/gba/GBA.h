@@ -21,7 +21,8 @@
 #define SAVE_GAME_VERSION_8 8
 #define SAVE_GAME_VERSION_9 9
 #define SAVE_GAME_VERSION_10 10
-#define SAVE_GAME_VERSION  SAVE_GAME_VERSION_10
+#define SAVE_GAME_VERSION_11 11 // drops the unused pixel buffer
+#define SAVE_GAME_VERSION  SAVE_GAME_VERSION_11
 
 struct GBAMem
 {
@@ -453,6 +454,8 @@ struct memoryMap {
 //#define VBAM_USE_IRQTICKS
 #define VBAM_USE_CPU_PREFETCH
 #define VBAM_USE_DELAYED_CPU_FLAGS
+#define VBAM_USE_BLOCK_CACHE
+//#define VBAM_VALIDATE_BLOCK_CACHE
 
 struct GBASys;
 
@@ -1025,9 +1028,10 @@ extern void CPUCleanUp();
 extern void CPUUpdateRender(GBASys &gba);
 extern bool CPUReadMemState(GBASys &gba, char *, int);
 extern bool CPUReadState(GBASys &gba, const char *);
-extern bool CPUWriteMemState(GBASys &gba, char *, int);
+extern int CPUWriteMemState(GBASys &gba, char *, int);
 extern bool CPUWriteState(GBASys &gba, const char *);
 extern int CPULoadRom(GBASys &gba, const char *);
+extern int CPULoadRomData(GBASys &gba, const u8 *data, int size);
 extern void doMirroring(GBASys &gba, bool);
 extern void CPUUpdateRegister(ARM7TDMI &cpu, u32, u16);
 extern void applyTimer(ARM7TDMI &cpu);
@@ -84,6 +84,14 @@ void mode5RenderLine(MixColorType *, GBALCD &lcd, const GBAMem::IoMem &ioMem);
 void mode5RenderLineNoWindow(MixColorType *, GBALCD &lcd, const GBAMem::IoMem &ioMem);
 void mode5RenderLineAll(MixColorType *, GBALCD &lcd, const GBAMem::IoMem &ioMem);
 
+enum GfxMixMode { GFX_MIX_NO_FX, GFX_MIX_FX, GFX_MIX_WINDOW };
+
+// Mixes lcd.lineOBJ & the BG line buffers in bgLayers (bit 0 for lcd.line0)
+// into lineMix, applying only OBJ semi-transparency, all color effects, or
+// windows & color effects. Uses SSE2/NEON when available.
+void gfxMixLine(MixColorType *lineMix, const GBALCD &lcd, const GBAMem::IoMem &ioMem,
+	uint bgLayers, GfxMixMode mode);
+
 static const int coeff[32] = {
   0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
   16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16};
@@ -115,6 +123,23 @@ static inline void gfxClearArray(u32 *array)
   }
 }
 
+// marks the columns inside a window from its WINxH register
+static inline void gfxUpdateWindow(bool inWin[240], u16 WINH)
+{
+  int x00 = WINH>>8;
+  int x01 = WINH & 255;
+
+  if(x00 <= x01) {
+    for(int i = 0; i < 240; i++) {
+      inWin[i] = (i >= x00 && i < x01);
+    }
+  } else {
+    for(int i = 0; i < 240; i++) {
+      inWin[i] = (i >= x00 || i < x01);
+    }
+  }
+}
+
 static inline void gfxDrawTextScreen(u8 vram[0x20000], u16 control, u16 hofs, u16 vofs,
 				     u32 *line, const u16 VCOUNT, const u16 MOSAIC, const u16 *palette)
 {
@@ -153,81 +178,50 @@ static inline void gfxDrawTextScreen(u8 vram[0x20000], u16 control, u16 hofs, u1
   }
 
   int yshift = ((yyy>>3)<<5);
-  if((control) & 0x80) {
-    const u16 *screenSource = screenBase + 0x400 * (xxx>>8) + ((xxx & 255)>>3) + yshift;
-    for(int x = 0; x < 240; x++) {
-      u16 data = READ16LE(screenSource);
-
-      int tile = data & 0x3FF;
-      int tileX = (xxx & 7);
-      int tileY = yyy & 7;
-
-      if(tileX == 7)
-        screenSource++;
-
-      if(data & 0x0400)
-        tileX = 7 - tileX;
-      if(data & 0x0800)
-        tileY = 7 - tileY;
-
-      u8 color = charBase[tile * 64 + tileY * 8 + tileX];
-
-      line[x] = color ? (READ16LE(&palette[color]) | prio): 0x80000000;
-
-      xxx++;
-      if(xxx == 256) {
-        if(sizeX > 256)
-          screenSource = screenBase + 0x400 + yshift;
-        else {
-          screenSource = screenBase + yshift;
-          xxx = 0;
-        }
-      } else if(xxx >= sizeX) {
-        xxx = 0;
-        screenSource = screenBase + yshift;
+  int tileY = yyy & 7;
+  const u16 *screenSource = screenBase + 0x400 * (xxx>>8) + ((xxx & 255)>>3) + yshift;
+  // decode a tile's row at a time, its pixels share the map entry
+  for(int x = 0; x < 240;) {
+    u16 data = READ16LE(screenSource);
+
+    int tile = data & 0x3FF;
+    int tileX = (xxx & 7);
+    int row = (data & 0x0800) ? 7 - tileY : tileY;
+    int flip = (data & 0x0400) ? 7 : 0;
+    int pixels = 8 - tileX;
+    if(pixels > 240 - x)
+      pixels = 240 - x;
+
+    if((control) & 0x80) {
+      const u8 *tileRow = &charBase[tile * 64 + row * 8];
+      for(int i = 0; i < pixels; i++) {
+        u8 color = tileRow[(tileX + i) ^ flip];
+        line[x + i] = color ? (READ16LE(&palette[color]) | prio): 0x80000000;
       }
-    }
-  } else {
-    const u16 *screenSource = screenBase + 0x400*(xxx>>8)+((xxx&255)>>3) +
-      yshift;
-    for(int x = 0; x < 240; x++) {
-      u16 data = READ16LE(screenSource);
-
-      int tile = data & 0x3FF;
-      int tileX = (xxx & 7);
-      int tileY = yyy & 7;
-
-      if(tileX == 7)
-        screenSource++;
-
-      if(data & 0x0400)
-        tileX = 7 - tileX;
-      if(data & 0x0800)
-        tileY = 7 - tileY;
-
-      u8 color = charBase[(tile<<5) + (tileY<<2) + (tileX>>1)];
-
-      if(tileX & 1) {
-        color = (color >> 4);
-      } else {
-        color &= 0x0F;
+    } else {
+      const u8 *tileRow = &charBase[(tile<<5) + (row<<2)];
+      const u16 *tilePalette = &palette[(data>>8) & 0xF0];
+      for(int i = 0; i < pixels; i++) {
+        int px = (tileX + i) ^ flip;
+        u8 color = (tileRow[px >> 1] >> ((px & 1) << 2)) & 0x0F;
+        line[x + i] = color ? (READ16LE(&tilePalette[color])|prio): 0x80000000;
       }
+    }
 
-      int pal = (data>>8) & 0xF0;
-      line[x] = color ? (READ16LE(&palette[pal + color])|prio): 0x80000000;
-
-      xxx++;
-      if(xxx == 256) {
-        if(sizeX > 256)
-          screenSource = screenBase + 0x400 + yshift;
-        else {
-          screenSource = screenBase + yshift;
-          xxx = 0;
-        }
-      } else if(xxx >= sizeX) {
-        xxx = 0;
+    x += pixels;
+    xxx += pixels;
+    if(!(xxx & 7))
+      screenSource++;
+    if(xxx == 256) {
+      if(sizeX > 256)
+        screenSource = screenBase + 0x400 + yshift;
+      else {
         screenSource = screenBase + yshift;
+        xxx = 0;
       }
+    } else if(xxx >= sizeX) {
+      xxx = 0;
+      screenSource = screenBase + yshift;
     }
   }
   if(mosaicOn) {
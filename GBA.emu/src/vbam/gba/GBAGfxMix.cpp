@@ -0,0 +1,386 @@
+#include <string.h>
+#include "GBA.h"
+#include "Globals.h"
+#include "GBAGfx.h"
+#if defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+static_assert(!directColorLookup, "line mixer outputs raw colors");
+
+// per-line state shared by every pixel
+struct MixParams
+{
+	u32 backdrop;
+	u32 bldmod;
+	uint effect;
+	int ca, cb, cy;
+	bool inWindow0, inWindow1;
+	u8 inWin0Mask, inWin1Mask, outMask, objWinMask;
+};
+
+static bool lineInWindow(u16 WINV, u16 VCOUNT)
+{
+	u8 v0 = WINV >> 8;
+	u8 v1 = WINV & 255;
+	bool inWindow = ((v0 == v1) && (v0 >= 0xe8));
+	if(v1 >= v0)
+		inWindow |= (VCOUNT >= v0 && VCOUNT < v1);
+	else
+		inWindow |= (VCOUNT >= v0 || VCOUNT < v1);
+	return inWindow;
+}
+
+static void initMixParams(MixParams &p, const GBALCD &lcd, const GBAMem::IoMem &ioMem)
+{
+	if(customBackdropColor == -1)
+		p.backdrop = (READ16LE(&((const u16 *)lcd.paletteRAM)[0]) | 0x30000000);
+	else
+		p.backdrop = ((customBackdropColor & 0x7FFF) | 0x30000000);
+	p.bldmod = ioMem.BLDMOD;
+	p.effect = (ioMem.BLDMOD >> 6) & 3;
+	p.ca = coeff[ioMem.COLEV & 0x1F];
+	p.cb = coeff[(ioMem.COLEV >> 8) & 0x1F];
+	p.cy = coeff[ioMem.COLY & 0x1F];
+	p.inWindow0 = (lcd.layerEnable & 0x2000) && lineInWindow(ioMem.WIN0V, ioMem.VCOUNT);
+	p.inWindow1 = (lcd.layerEnable & 0x4000) && lineInWindow(ioMem.WIN1V, ioMem.VCOUNT);
+	p.inWin0Mask = ioMem.WININ & 0xFF;
+	p.inWin1Mask = ioMem.WININ >> 8;
+	p.outMask = ioMem.WINOUT & 0xFF;
+	p.objWinMask = ioMem.WINOUT >> 8;
+}
+
+#if !defined __SSE2__ && !defined __ARM_NEON__
+
+static uint windowMask(const GBALCD &lcd, const MixParams &p, uint x)
+{
+	uint mask = p.outMask;
+	if(!(lcd.lineOBJWin[x] & 0x80000000))
+		mask = p.objWinMask;
+	if(p.inWindow1 && lcd.gfxInWin1[x])
+		mask = p.inWin1Mask;
+	if(p.inWindow0 && lcd.gfxInWin0[x])
+		mask = p.inWin0Mask;
+	return mask;
+}
+
+// keeps the layer's pixel if it's enabled & in front, for the 2nd target
+// search the top layer is skipped
+template <GfxMixMode MODE, bool BACK>
+ATTRS(always_inline) static inline void selectLayer(u32 layer, u32 id, uint mask, u32 top, u32 &color, u32 &colorTop)
+{
+	if((MODE != GFX_MIX_WINDOW || (mask & id)) && (!BACK || top != id) && (layer >> 24) < (color >> 24))
+	{
+		color = layer;
+		colorTop = id;
+	}
+}
+
+template <GfxMixMode MODE, uint BG_LAYERS, bool BACK>
+ATTRS(always_inline) static inline void selectLayers(const GBALCD &lcd, uint x, uint mask, u32 top, u32 &color, u32 &colorTop)
+{
+	if(BG_LAYERS & 1)
+		selectLayer<MODE, BACK>(lcd.line0[x], 0x01, mask, top, color, colorTop);
+	if(BG_LAYERS & 2)
+		selectLayer<MODE, BACK>(lcd.line1[x], 0x02, mask, top, color, colorTop);
+	if(BG_LAYERS & 4)
+		selectLayer<MODE, BACK>(lcd.line2[x], 0x04, mask, top, color, colorTop);
+	if(BG_LAYERS & 8)
+		selectLayer<MODE, BACK>(lcd.line3[x], 0x08, mask, top, color, colorTop);
+	selectLayer<MODE, BACK>(lcd.lineOBJ[x], 0x10, mask, top, color, colorTop);
+}
+
+template <GfxMixMode MODE, uint BG_LAYERS>
+static u32 mixPixel(const GBALCD &lcd, const MixParams &p, uint x)
+{
+	uint mask = MODE == GFX_MIX_WINDOW ? windowMask(lcd, p, x) : 0x3F;
+	u32 color = p.backdrop;
+	u32 top = 0x20;
+	selectLayers<MODE, BG_LAYERS, false>(lcd, x, mask, 0, color, top);
+
+	// a semi-transparent OBJ blends even where effects are off
+	bool semi = color & 0x00010000;
+	bool fx = MODE == GFX_MIX_FX || (MODE == GFX_MIX_WINDOW && (mask & 0x20));
+	if(!semi && (!fx || !p.effect || !(top & p.bldmod)))
+		return color;
+
+	if(semi || p.effect == 1)
+	{
+		u32 back = p.backdrop;
+		u32 top2 = 0x20;
+		selectLayers<MODE, BG_LAYERS, true>(lcd, x, mask, top, back, top2);
+		if(top2 & (p.bldmod >> 8))
+			return gfxAlphaBlend(color, back, p.ca, p.cb);
+		if(!semi)
+			return color;
+	}
+
+	switch(p.effect)
+	{
+		case 2:
+			if(p.bldmod & top)
+				color = gfxIncreaseBrightness(color, p.cy);
+			break;
+		case 3:
+			if(p.bldmod & top)
+				color = gfxDecreaseBrightness(color, p.cy);
+			break;
+	}
+	return color;
+}
+
+template <GfxMixMode MODE, uint BG_LAYERS>
+static void mixLine(MixColorType *lineMix, const GBALCD &lcd, const MixParams &p)
+{
+	for(uint x = 0; x < 240; x++)
+	{
+		lineMix[x] = convColor(mixPixel<MODE, BG_LAYERS>(lcd, p, x));
+	}
+}
+#else
+
+// 4 pixels per vector, multiplies & minimums only see 16-bit values
+#if defined __SSE2__
+typedef __m128i Vec;
+static Vec vDup(u32 a) { return _mm_set1_epi32(a); }
+static Vec vLoad(const u32 *p) { return _mm_loadu_si128((const __m128i *)p); }
+static Vec vAnd(Vec a, Vec b) { return _mm_and_si128(a, b); }
+static Vec vOr(Vec a, Vec b) { return _mm_or_si128(a, b); }
+static Vec vAndNot(Vec a, Vec b) { return _mm_andnot_si128(b, a); } // a & ~b
+static Vec vAdd(Vec a, Vec b) { return _mm_add_epi32(a, b); }
+static Vec vSub(Vec a, Vec b) { return _mm_sub_epi32(a, b); }
+static Vec vMul16(Vec a, Vec b) { return _mm_mullo_epi16(a, b); }
+static Vec vMin16(Vec a, Vec b) { return _mm_min_epi16(a, b); }
+template <int N> static Vec vShr(Vec a) { return _mm_srli_epi32(a, N); }
+template <int N> static Vec vShl(Vec a) { return _mm_slli_epi32(a, N); }
+static Vec vLess(Vec a, Vec b) { return _mm_cmplt_epi32(a, b); }
+static Vec vEq(Vec a, Vec b) { return _mm_cmpeq_epi32(a, b); }
+static Vec vTest(Vec a, Vec b) { return _mm_xor_si128(_mm_cmpeq_epi32(_mm_and_si128(a, b), _mm_setzero_si128()), _mm_set1_epi32(-1)); }
+static Vec vSel(Vec mask, Vec a, Vec b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+static bool vAny(Vec mask) { return _mm_movemask_epi8(mask); }
+
+static Vec vLoadBool(const bool *p)
+{
+	int bytes;
+	memcpy(&bytes, p, 4);
+	Vec zero = _mm_setzero_si128();
+	Vec v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+	return vTest(v, v);
+}
+
+static void vStore16(u16 *p, Vec a)
+{
+	// sign-extend the low halves so the saturating pack keeps them intact
+	a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+	_mm_storel_epi64((__m128i *)p, _mm_packs_epi32(a, a));
+}
+#else
+typedef uint32x4_t Vec;
+static Vec vDup(u32 a) { return vdupq_n_u32(a); }
+static Vec vLoad(const u32 *p) { return vld1q_u32(p); }
+static Vec vAnd(Vec a, Vec b) { return vandq_u32(a, b); }
+static Vec vOr(Vec a, Vec b) { return vorrq_u32(a, b); }
+static Vec vAndNot(Vec a, Vec b) { return vbicq_u32(a, b); } // a & ~b
+static Vec vAdd(Vec a, Vec b) { return vaddq_u32(a, b); }
+static Vec vSub(Vec a, Vec b) { return vsubq_u32(a, b); }
+static Vec vMul16(Vec a, Vec b) { return vmulq_u32(a, b); }
+static Vec vMin16(Vec a, Vec b) { return vminq_u32(a, b); }
+template <int N> static Vec vShr(Vec a) { return vshrq_n_u32(a, N); }
+template <int N> static Vec vShl(Vec a) { return vshlq_n_u32(a, N); }
+static Vec vLess(Vec a, Vec b) { return vcltq_u32(a, b); }
+static Vec vEq(Vec a, Vec b) { return vceqq_u32(a, b); }
+static Vec vTest(Vec a, Vec b) { return vtstq_u32(a, b); }
+static Vec vSel(Vec mask, Vec a, Vec b) { return vbslq_u32(mask, a, b); }
+
+static bool vAny(Vec mask)
+{
+	uint32x2_t m = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+	return vget_lane_u32(vpmax_u32(m, m), 0);
+}
+
+static Vec vLoadBool(const bool *p)
+{
+	u32 bytes;
+	memcpy(&bytes, p, 4);
+	Vec v = vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(bytes)))));
+	return vtstq_u32(v, v);
+}
+
+static void vStore16(u16 *p, Vec a)
+{
+	vst1_u16(p, vmovn_u32(a));
+}
+#endif
+
+static Vec channel(Vec c, uint shift)
+{
+	const Vec chMask = vDup(0x1F);
+	switch(shift)
+	{
+		case 0: return vAnd(c, chMask);
+		case 5: return vAnd(vShr<5>(c), chMask);
+		default: return vAnd(vShr<10>(c), chMask);
+	}
+}
+
+static Vec packChannels(Vec r, Vec g, Vec b)
+{
+	return vOr(r, vOr(vShl<5>(g), vShl<10>(b)));
+}
+
+// same per-channel results as the scalar gfxAlphaBlend/gfxIncreaseBrightness/gfxDecreaseBrightness
+static Vec alphaBlend(Vec a, Vec b, Vec ca, Vec cb)
+{
+	const Vec max = vDup(31);
+	Vec ch[3];
+	iterateTimes(3, i)
+	{
+		uint shift = i * 5;
+		ch[i] = vMin16(vShr<4>(vAdd(vMul16(channel(a, shift), ca), vMul16(channel(b, shift), cb))), max);
+	}
+	return packChannels(ch[0], ch[1], ch[2]);
+}
+
+static Vec increaseBrightness(Vec c, Vec cy)
+{
+	const Vec max = vDup(31);
+	Vec ch[3];
+	iterateTimes(3, i)
+	{
+		Vec v = channel(c, i * 5);
+		ch[i] = vAdd(v, vShr<4>(vMul16(vSub(max, v), cy)));
+	}
+	return packChannels(ch[0], ch[1], ch[2]);
+}
+
+static Vec decreaseBrightness(Vec c, Vec cy)
+{
+	Vec ch[3];
+	iterateTimes(3, i)
+	{
+		Vec v = channel(c, i * 5);
+		ch[i] = vSub(v, vShr<4>(vMul16(v, cy)));
+	}
+	return packChannels(ch[0], ch[1], ch[2]);
+}
+
+// keeps the layer in lanes where it's enabled & in front, for the 2nd
+// target search the top layer is skipped
+template <GfxMixMode MODE, bool BACK>
+ATTRS(always_inline) static inline void selectLayer(Vec layer, Vec id, Vec mask, Vec top, Vec &color, Vec &prio, Vec &colorTop)
+{
+	Vec layerPrio = vShr<24>(layer);
+	Vec less = vLess(layerPrio, prio);
+	if(MODE == GFX_MIX_WINDOW)
+		less = vAnd(less, vTest(mask, id));
+	if(BACK)
+		less = vAndNot(less, vEq(top, id));
+	color = vSel(less, layer, color);
+	prio = vSel(less, layerPrio, prio);
+	colorTop = vSel(less, id, colorTop);
+}
+
+template <GfxMixMode MODE, uint BG_LAYERS, bool BACK>
+ATTRS(always_inline) static inline void selectLayers(const GBALCD &lcd, uint x, Vec mask, Vec top, Vec &color, Vec &prio, Vec &colorTop)
+{
+	if(BG_LAYERS & 1)
+		selectLayer<MODE, BACK>(vLoad(&lcd.line0[x]), vDup(0x01), mask, top, color, prio, colorTop);
+	if(BG_LAYERS & 2)
+		selectLayer<MODE, BACK>(vLoad(&lcd.line1[x]), vDup(0x02), mask, top, color, prio, colorTop);
+	if(BG_LAYERS & 4)
+		selectLayer<MODE, BACK>(vLoad(&lcd.line2[x]), vDup(0x04), mask, top, color, prio, colorTop);
+	if(BG_LAYERS & 8)
+		selectLayer<MODE, BACK>(vLoad(&lcd.line3[x]), vDup(0x08), mask, top, color, prio, colorTop);
+	selectLayer<MODE, BACK>(vLoad(&lcd.lineOBJ[x]), vDup(0x10), mask, top, color, prio, colorTop);
+}
+
+template <GfxMixMode MODE, uint BG_LAYERS>
+static void mixLine(MixColorType *lineMix, const GBALCD &lcd, const MixParams &p)
+{
+	const Vec zero = vDup(0), ones = vDup(0xFFFFFFFF);
+	const Vec backdrop = vDup(p.backdrop), backdropPrio = vDup(p.backdrop >> 24),
+		backdropId = vDup(0x20), semiBit = vDup(0x00010000), fxBit = vDup(0x20);
+	const Vec target1 = vDup(p.bldmod & 0x3F), target2 = vDup((p.bldmod >> 8) & 0x3F);
+	const Vec ca = vDup(p.ca), cb = vDup(p.cb), cy = vDup(p.cy);
+	const Vec outMask = vDup(p.outMask), objWinMask = vDup(p.objWinMask),
+		inWin0Mask = vDup(p.inWin0Mask), inWin1Mask = vDup(p.inWin1Mask);
+
+	for(uint x = 0; x < 240; x += 4)
+	{
+		Vec mask = ones;
+		if(MODE == GFX_MIX_WINDOW)
+		{
+			Vec objWin = vEq(vShr<31>(vLoad(&lcd.lineOBJWin[x])), zero);
+			mask = vSel(objWin, objWinMask, outMask);
+			if(p.inWindow1)
+				mask = vSel(vLoadBool(&lcd.gfxInWin1[x]), inWin1Mask, mask);
+			if(p.inWindow0)
+				mask = vSel(vLoadBool(&lcd.gfxInWin0[x]), inWin0Mask, mask);
+		}
+
+		Vec color = backdrop, prio = backdropPrio, top = backdropId;
+		selectLayers<MODE, BG_LAYERS, false>(lcd, x, mask, zero, color, prio, top);
+
+		// a semi-transparent OBJ blends even where effects are off
+		Vec semi = vTest(color, semiBit);
+		Vec fx = MODE == GFX_MIX_FX ? ones : MODE == GFX_MIX_WINDOW ? vTest(mask, fxBit) : zero;
+		Vec firstTarget = vTest(top, target1);
+		Vec fxTarget = p.effect ? vAnd(fx, firstTarget) : zero;
+		if(!vAny(vOr(semi, fxTarget)))
+		{
+			vStore16(&lineMix[x], color);
+			continue;
+		}
+
+		Vec result = color;
+		Vec secondTarget = zero;
+		if(p.effect == 1 || vAny(semi))
+		{
+			Vec back = backdrop, backPrio = backdropPrio, top2 = backdropId;
+			selectLayers<MODE, BG_LAYERS, true>(lcd, x, mask, top, back, backPrio, top2);
+			secondTarget = vTest(top2, target2);
+			Vec blend = vAnd(secondTarget, p.effect == 1 ? vOr(semi, fxTarget) : semi);
+			if(vAny(blend))
+				result = vSel(blend, alphaBlend(color, back, ca, cb), result);
+		}
+		if(p.effect >= 2)
+		{
+			Vec bright = vAnd(firstTarget, vOr(vAndNot(semi, secondTarget), vAndNot(fx, semi)));
+			if(vAny(bright))
+			{
+				Vec adjusted = p.effect == 2 ? increaseBrightness(color, cy) : decreaseBrightness(color, cy);
+				result = vSel(bright, adjusted, result);
+			}
+		}
+		vStore16(&lineMix[x], result);
+	}
+}
+
+#endif
+
+template <uint BG_LAYERS>
+static void mixLine(MixColorType *lineMix, const GBALCD &lcd, const MixParams &p, GfxMixMode mode)
+{
+	switch(mode)
+	{
+		case GFX_MIX_NO_FX: mixLine<GFX_MIX_NO_FX, BG_LAYERS>(lineMix, lcd, p); break;
+		case GFX_MIX_FX: mixLine<GFX_MIX_FX, BG_LAYERS>(lineMix, lcd, p); break;
+		case GFX_MIX_WINDOW: mixLine<GFX_MIX_WINDOW, BG_LAYERS>(lineMix, lcd, p); break;
+	}
+}
+
+void gfxMixLine(MixColorType *lineMix, const GBALCD &lcd, const GBAMem::IoMem &ioMem,
+	uint bgLayers, GfxMixMode mode)
+{
+	MixParams p;
+	initMixParams(p, lcd, ioMem);
+	switch(bgLayers)
+	{
+		case 0xF: mixLine<0xF>(lineMix, lcd, p, mode); break; // mode 0
+		case 0x7: mixLine<0x7>(lineMix, lcd, p, mode); break; // mode 1
+		case 0xC: mixLine<0xC>(lineMix, lcd, p, mode); break; // mode 2
+		default: mixLine<0x4>(lineMix, lcd, p, mode); break; // modes 3-5
+	}
+}
@@ -8,6 +8,8 @@
 #include "agbprint.h"
 #include "GBAcpu.h"
 #include "GBALink.h"
+#include "IdleLoop.h"
+#include "RenderThread.h"
 
 static const u32  objTilesAddress [3] = {0x010000, 0x014000, 0x014000};
 
@@ -327,6 +329,7 @@ static inline u32 CPUReadHalfWordBase(ARM7TDMI &cpu, u32 address)
     {
       if (((address & 0x3fe)>0xFF) && ((address & 0x3fe)<0x10E))
       {
+        idleLoopTimerRead = true;
         if (((address & 0x3fe) == 0x100) && timer0On)
         	return armRotLoad16(0xFFFF - ((timer0Ticks-cpuTotalTicks) >> timer0ClockReload), address, rot);
         else
@@ -600,6 +603,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, u32 address, u32 value)
     else
 #endif
       WRITE32LE(((u32 *)&cpu.gba->mem.workRAM[address & 0x3FFFC]), value);
+    blockCacheCheckWrite(address);
     break;
   case 0x03:
 #ifdef BKPT_SUPPORT
@@ -609,6 +613,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, u32 address, u32 value)
     else
 #endif
       WRITE32LE(((u32 *)&cpu.gba->mem.internalRAM[address & 0x7ffC]), value);
+    blockCacheCheckWrite(address);
     break;
   case 0x04:
     if(address < 0x4000400) {
@@ -624,6 +629,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, u32 address, u32 value)
     else
 #endif
       WRITE32LE(((u32 *)&paletteRAM[address & 0x3FC]), value);
+    renderThreadPaletteWritten(address & 0x3FC);
     break;
   case 0x06:
     address = (address & 0x1fffc);
@@ -639,6 +645,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, u32 address, u32 value)
 #endif
 
       WRITE32LE(((u32 *)&vram[address]), value);
+    renderThreadVramWritten(address);
     break;
   case 0x07:
 #ifdef BKPT_SUPPORT
@@ -649,6 +656,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, u32 address, u32 value)
 #endif
       WRITE32LE(((u32 *)&oam[address & 0x3fc]), value);
       //oamUpdated = 1;
+    renderThreadOamWritten(address & 0x3fc);
     break;
   case 0x0D:
     if(cpuEEPROMEnabled) {
@@ -701,6 +709,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, u32 address, u16 value)
     else
 #endif
       WRITE16LE(((u16 *)&cpu.gba->mem.workRAM[address & 0x3FFFE]),value);
+    blockCacheCheckWrite(address);
     break;
   case 3:
 #ifdef BKPT_SUPPORT
@@ -710,6 +719,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, u32 address, u16 value)
     else
 #endif
       WRITE16LE(((u16 *)&cpu.gba->mem.internalRAM[address & 0x7ffe]), value);
+    blockCacheCheckWrite(address);
     break;
   case 4:
     if(address < 0x4000400)
@@ -724,6 +734,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, u32 address, u16 value)
     else
 #endif
       WRITE16LE(((u16 *)&paletteRAM[address & 0x3fe]), value);
+    renderThreadPaletteWritten(address & 0x3fe);
     break;
   case 6:
     address = (address & 0x1fffe);
@@ -738,6 +749,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, u32 address, u16 value)
     else
 #endif
       WRITE16LE(((u16 *)&vram[address]), value);
+    renderThreadVramWritten(address);
     break;
   case 7:
 #ifdef BKPT_SUPPORT
@@ -748,6 +760,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, u32 address, u16 value)
 #endif
       WRITE16LE(((u16 *)&oam[address & 0x3fe]), value);
       //oamUpdated = 1;
+    renderThreadOamWritten(address & 0x3fe);
     break;
   case 8:
   case 9:
@@ -802,6 +815,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, u32 address, u8 b)
     else
 #endif
     	cpu.gba->mem.workRAM[address & 0x3FFFF] = b;
+    blockCacheCheckWrite(address);
     break;
   case 3:
 #ifdef BKPT_SUPPORT
@@ -810,6 +824,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, u32 address, u8 b)
     else
 #endif
     	cpu.gba->mem.internalRAM[address & 0x7fff] = b;
+    blockCacheCheckWrite(address);
     break;
   case 4:
     if(address < 0x4000400) {
@@ -879,6 +894,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, u32 address, u8 b)
   case 5:
     // no need to switch
   	*((uint16a *)&cpu.gba->lcd.paletteRAM[address & 0x3FE]) = (b << 8) | b;
+    renderThreadPaletteWritten(address & 0x3FE);
     break;
   case 6:
     address = (address & 0x1fffe);
@@ -897,6 +913,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, u32 address, u8 b)
       else
 #endif
       	*((uint16a *)&vram[address]) = (b << 8) | b;
+      renderThreadVramWritten(address);
     }
     break;
   case 7:
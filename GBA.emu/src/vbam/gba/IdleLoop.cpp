@@ -0,0 +1,310 @@
+#include "GBA.h"
+#include "IdleLoop.h"
+
+bool idleLoopSkipping = true;
+bool idleLoopTimerRead = false;
+
+static const uint idleLoopMaxInsns = 16;
+
+// register & flag usage, bits 0-15 are r0-r15
+enum
+{
+	USE_N = 1 << 16, USE_Z = 1 << 17, USE_C = 1 << 18, USE_V = 1 << 19,
+	USE_NZ = USE_N | USE_Z, USE_NZCV = USE_NZ | USE_C | USE_V
+};
+
+struct InsnUse
+{
+	u32 read, write;
+};
+
+static u32 condFlagsRead(uint cond)
+{
+	switch(cond)
+	{
+		case 0x0: case 0x1: return USE_Z; // EQ, NE
+		case 0x2: case 0x3: return USE_C; // CS, CC
+		case 0x4: case 0x5: return USE_N; // MI, PL
+		case 0x6: case 0x7: return USE_V; // VS, VC
+		case 0x8: case 0x9: return USE_C | USE_Z; // HI, LS
+		case 0xA: case 0xB: return USE_N | USE_V; // GE, LT
+		case 0xC: case 0xD: return USE_NZ | USE_V; // GT, LE
+		default: return 0;
+	}
+}
+
+// A loop is idle if nothing it writes is read before being written again in
+// the same iteration. Conditional branches may only leave the loop.
+static uint checkLoop(const InsnUse *use, const u32 *exitTarget, uint insns, u32 pc, u32 end)
+{
+	u32 written = 0, carried = 0, everWritten = 0;
+	iterateTimes(insns, i)
+	{
+		carried |= use[i].read & ~written;
+		written |= use[i].write;
+		everWritten |= use[i].write;
+		if(exitTarget[i] && exitTarget[i] >= pc && exitTarget[i] < end)
+			return 0;
+	}
+	if(carried & everWritten)
+		return 0;
+	return insns;
+}
+
+uint thumbIdleLoopInsns(const BlockInsn *insn, uint insns, u32 pc)
+{
+	InsnUse use[idleLoopMaxInsns];
+	u32 exitTarget[idleLoopMaxInsns];
+	if(insns > idleLoopMaxInsns)
+		insns = idleLoopMaxInsns;
+	iterateTimes(insns, i)
+	{
+		u32 op = insn[i].opcode;
+		u32 insnPC = pc + i * 2;
+		uint rd = op & 7, rs = (op >> 3) & 7, rn = (op >> 6) & 7;
+		auto &u = use[i];
+		u.read = u.write = 0;
+		exitTarget[i] = 0;
+		switch(op >> 11)
+		{
+			case 0x00: // LSL imm, C kept for #0
+				u.read = 1 << rs;
+				u.write = (1 << rd) | USE_NZ | ((op & 0x07C0) ? USE_C : 0);
+				break;
+			case 0x01: case 0x02: // LSR/ASR imm
+				u.read = 1 << rs;
+				u.write = (1 << rd) | USE_NZ | USE_C;
+				break;
+			case 0x03: // ADD/SUB reg or imm3
+				u.read = (1 << rs) | ((op & 0x0400) ? 0 : 1 << rn);
+				u.write = (1 << rd) | USE_NZCV;
+				break;
+			case 0x04: // MOV imm8
+				u.write = (1 << ((op >> 8) & 7)) | USE_NZ;
+				break;
+			case 0x05: // CMP imm8
+				u.read = 1 << ((op >> 8) & 7);
+				u.write = USE_NZCV;
+				break;
+			case 0x06: case 0x07: // ADD/SUB imm8
+				u.read = 1 << ((op >> 8) & 7);
+				u.write = u.read | USE_NZCV;
+				break;
+			case 0x08:
+				if(op < 0x4400)
+				{
+					u.read = (1 << rd) | (1 << rs);
+					switch((op >> 6) & 0xF)
+					{
+						case 0x0: case 0x1: case 0xC: case 0xE: // AND, EOR, ORR, BIC
+							u.write = (1 << rd) | USE_NZ;
+							break;
+						case 0x2: case 0x3: case 0x4: case 0x7: // shifts by register, C kept for 0
+							u.read |= USE_C;
+							u.write = (1 << rd) | USE_NZ | USE_C;
+							break;
+						case 0x5: case 0x6: // ADC, SBC
+							u.read |= USE_C;
+							u.write = (1 << rd) | USE_NZCV;
+							break;
+						case 0x8: // TST
+							u.write = USE_NZ;
+							break;
+						case 0x9: // NEG
+							u.read = 1 << rs;
+							u.write = (1 << rd) | USE_NZCV;
+							break;
+						case 0xA: case 0xB: // CMP, CMN
+							u.write = USE_NZCV;
+							break;
+						case 0xF: // MVN
+							u.read = 1 << rs;
+							u.write = (1 << rd) | USE_NZ;
+							break;
+						default: // MUL
+							return 0;
+					}
+				}
+				else
+				{
+					uint hd = rd | ((op >> 4) & 8), hs = (op >> 3) & 0xF;
+					switch((op >> 8) & 3)
+					{
+						case 0: // ADD hi
+							if(hd == 15)
+								return 0;
+							u.read = (1 << hd) | (1 << hs);
+							u.write = 1 << hd;
+							break;
+						case 1: // CMP hi
+							u.read = (1 << hd) | (1 << hs);
+							u.write = USE_NZCV;
+							break;
+						case 2: // MOV hi
+							if(hd == 15)
+								return 0;
+							u.read = 1 << hs;
+							u.write = 1 << hd;
+							break;
+						default: // BX
+							return 0;
+					}
+				}
+				break;
+			case 0x09: // LDR pc-relative
+				u.write = 1 << ((op >> 8) & 7);
+				break;
+			case 0x0A: case 0x0B: // load/store with register offset
+				if((op & 0x0E00) < 0x0600)
+					return 0; // STR, STRH, STRB
+				u.read = (1 << rs) | (1 << rn);
+				u.write = 1 << rd;
+				break;
+			case 0x0D: case 0x0F: case 0x11: // LDR, LDRB, LDRH imm
+				u.read = 1 << rs;
+				u.write = 1 << rd;
+				break;
+			case 0x13: // LDR sp-relative
+				u.read = 1 << 13;
+				u.write = 1 << ((op >> 8) & 7);
+				break;
+			case 0x14: // ADD Rd, pc
+				u.write = 1 << ((op >> 8) & 7);
+				break;
+			case 0x15: // ADD Rd, sp
+				u.read = 1 << 13;
+				u.write = 1 << ((op >> 8) & 7);
+				break;
+			case 0x1A: case 0x1B: // conditional branch
+			{
+				uint cond = (op >> 8) & 0xF;
+				if(cond >= 0xE)
+					return 0; // SWI
+				u.read = condFlagsRead(cond);
+				u32 target = insnPC + 4 + ((s32)(s8)(op & 0xFF) << 1);
+				if(target == pc)
+					return checkLoop(use, exitTarget, i + 1, pc, insnPC + 2);
+				exitTarget[i] = target;
+				break;
+			}
+			case 0x1C: // B
+			{
+				u32 target = insnPC + 4 + (((s32)(op << 21)) >> 20);
+				if(target == pc)
+					return checkLoop(use, exitTarget, i + 1, pc, insnPC + 2);
+				return 0;
+			}
+			default: // stores, stack, multiple transfers, BL
+				return 0;
+		}
+	}
+	return 0;
+}
+
+// carry flag usage of a logical op's shifter, the carry is kept for a
+// zero shift & RRX reads it
+static void armShifterCarryUse(u32 op, bool immOperand, InsnUse &u)
+{
+	if(immOperand)
+	{
+		if(op & 0xF00)
+			u.write |= USE_C;
+	}
+	else if(op & 0x10)
+	{
+		// shift by register, amount may be 0
+		u.read |= USE_C;
+		u.write |= USE_C;
+	}
+	else if((op & 0xFF0) != 0) // not LSL #0
+		u.write |= USE_C;
+}
+
+uint armIdleLoopInsns(const BlockInsn *insn, uint insns, u32 pc)
+{
+	InsnUse use[idleLoopMaxInsns];
+	u32 exitTarget[idleLoopMaxInsns];
+	if(insns > idleLoopMaxInsns)
+		insns = idleLoopMaxInsns;
+	iterateTimes(insns, i)
+	{
+		u32 op = insn[i].opcode;
+		u32 insnPC = pc + i * 4;
+		uint cond = op >> 28;
+		uint rd = (op >> 12) & 0xF, rn = (op >> 16) & 0xF, rm = op & 0xF;
+		auto &u = use[i];
+		u.read = u.write = 0;
+		exitTarget[i] = 0;
+		if(cond == 0xF)
+			return 0;
+		if((op & 0x0E000000) == 0x0A000000)
+		{
+			if(op & 0x01000000)
+				return 0; // BL
+			u.read = condFlagsRead(cond);
+			u32 target = insnPC + 8 + (((s32)(op << 8)) >> 6);
+			if(target == pc)
+				return checkLoop(use, exitTarget, i + 1, pc, insnPC + 4);
+			if(cond == 0xE)
+				return 0;
+			exitTarget[i] = target;
+			continue;
+		}
+		if((op & 0x0C000000) == 0x04000000)
+		{
+			// single data load without writeback
+			if(!(op & 0x00100000) || (op & 0x01200000) != 0x01000000 || rd == 15)
+				return 0;
+			u.read = 1 << rn;
+			if(op & 0x02000000)
+				u.read |= (1 << rm) | ((op & 0xFF0) == 0x060 ? USE_C : 0);
+			u.write = 1 << rd;
+		}
+		else if((op & 0x0E000090) == 0x00000090 && (op & 0x60))
+		{
+			// halfword & signed loads without writeback
+			if(!(op & 0x00100000) || (op & 0x01200000) != 0x01000000 || rd == 15)
+				return 0;
+			u.read = (1 << rn) | ((op & 0x00400000) ? 0 : 1 << rm);
+			u.write = 1 << rd;
+		}
+		else if((op & 0x0C000000) == 0)
+		{
+			// data processing
+			bool imm = op & 0x02000000, s = op & 0x00100000;
+			uint opc = (op >> 21) & 0xF;
+			if(!imm && (op & 0x90) == 0x90)
+				return 0; // multiply, swap
+			if(rd == 15 || (opc >= 0x8 && opc <= 0xB && !s))
+				return 0; // writes pc, MRS/MSR
+			if(!imm)
+				u.read = (1 << rm) | ((op & 0x10) ? 1 << ((op >> 8) & 0xF) : 0)
+					| ((op & 0xFF0) == 0x060 ? USE_C : 0);
+			if(opc != 0xD && opc != 0xF) // not MOV/MVN
+				u.read |= 1 << rn;
+			if(opc < 0x8 || opc >= 0xC) // not a test
+				u.write = 1 << rd;
+			bool logical = opc <= 0x1 || opc == 0x8 || opc == 0x9 || opc >= 0xC;
+			if(opc == 0x5 || opc == 0x6 || opc == 0x7) // ADC, SBC, RSC
+				u.read |= USE_C;
+			if(s)
+			{
+				if(logical)
+				{
+					u.write |= USE_NZ;
+					armShifterCarryUse(op, imm, u);
+				}
+				else
+					u.write |= USE_NZCV;
+			}
+		}
+		else
+			return 0; // stores, multiple transfers, SWI, coprocessor
+		if(cond != 0xE)
+		{
+			// a skipped instruction keeps its old results
+			u.read |= condFlagsRead(cond) | u.write;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef GBA_IDLELOOP_H
+#define GBA_IDLELOOP_H
+
+#include "BlockCache.h"
+
+// Detects blocks that start with a short busy-wait loop, one that only
+// loads from memory & compares without carrying any register or flag
+// between iterations. Since memory can only change at the next event
+// while such a loop runs, each iteration repeats the last one and the
+// CPU can jump straight to the event.
+
+extern bool idleLoopSkipping; // cleared by game-specific settings
+extern bool idleLoopTimerRead; // set when a timer counter is read
+
+// returns the loop's instruction count or 0 if the block isn't an idle loop
+uint thumbIdleLoopInsns(const BlockInsn *insn, uint insns, u32 pc);
+uint armIdleLoopInsns(const BlockInsn *insn, uint insns, u32 pc);
+
+// call after running a block, ranInsns is the number executed
+static inline void idleLoopCheck(ARM7TDMI &cpu, const Block &block, uint ranInsns)
+{
+	// timer counters advance without an event so polling them isn't idle
+	if(block.idleLoopInsns && ranInsns == block.idleLoopInsns
+		&& cpu.armNextPC == block.pc && !idleLoopTimerRead && idleLoopSkipping
+		&& cpu.cpuTotalTicks < cpu.cpuNextEvent)
+	{
+		cpu.cpuTotalTicks = cpu.cpuNextEvent;
+	}
+	idleLoopTimerRead = false;
+}
+
+#endif // GBA_IDLELOOP_H
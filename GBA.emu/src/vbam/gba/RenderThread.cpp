@@ -0,0 +1,284 @@
+#include <string.h>
+#include "GBA.h"
+#include "GBAGfx.h"
+#include "RenderThread.h"
+#include <logger/interface.h>
+#include <util/RingBuffer.hh>
+#include <util/branch.h>
+#include <util/thread/pthread.hh>
+
+bool renderThreadActive = false;
+u8 renderChunkDirty[renderChunks] {0};
+u16 renderDirtyChunk[renderChunks] {0};
+uint renderDirtyChunks = 0;
+
+static const uint renderChunkSize = 1 << renderChunkShift;
+static const uint lcdRegsSize = 0x56; // DISPCNT through COLY
+static const uint WIN0HReg = 0x40 >> 1, WIN1HReg = 0x42 >> 1;
+
+struct LineJob
+{
+	MixColorType *lineMix;
+	GBALCD::RenderLineFunc renderLine;
+	uint layerEnable;
+	int gfxBG2Changed;
+	int gfxBG3Changed;
+	u16 chunks; // dirty chunks following the job, each an index & its data
+	u8 clearLines;
+	bool fxOn;
+	bool windowOn;
+	u16 regs[lcdRegsSize >> 1];
+};
+
+// room for a line with every chunk dirty plus the lines behind it
+static const uint queueSize = 0x40000;
+static_assert(sizeof(LineJob) + renderChunks * (sizeof(u16) + renderChunkSize) < queueSize,
+	"render queue can't hold a line with all video memory dirty");
+
+static GBALCD workerLcd;
+static GBAMem::IoMem workerIoMem;
+static uchar queueBuff[queueSize];
+static RingBuffer<uchar> queue;
+static ThreadPThread thread;
+static MutexPThread mutex;
+static CondVarPThread workCond, doneCond;
+static uint linesQueued = 0, linesDone = 0;
+static bool quitThread = false;
+static uint pendingClearLines = 0;
+
+static u8 *chunkData(GBALCD &lcd, uint chunk)
+{
+	if(chunk < renderPaletteChunk)
+		return &lcd.vram[chunk << renderChunkShift];
+	else if(chunk < renderOamChunk)
+		return &lcd.paletteRAM[(chunk - renderPaletteChunk) << renderChunkShift];
+	else
+		return &lcd.oam[(chunk - renderOamChunk) << renderChunkShift];
+}
+
+// copies what the renderer keeps between lines
+static void copyRendererState(GBALCD &dest, const GBALCD &src)
+{
+#ifndef GBALCD_TEMP_LINE_BUFFER
+	memcpy(dest.line0, src.line0, sizeof(dest.line0));
+	memcpy(dest.line1, src.line1, sizeof(dest.line1));
+	memcpy(dest.line2, src.line2, sizeof(dest.line2));
+	memcpy(dest.line3, src.line3, sizeof(dest.line3));
+	memcpy(dest.lineOBJ, src.lineOBJ, sizeof(dest.lineOBJ));
+#endif
+	memcpy(dest.lineOBJWin, src.lineOBJWin, sizeof(dest.lineOBJWin));
+	memcpy(dest.lineOBJpixleft, src.lineOBJpixleft, sizeof(dest.lineOBJpixleft));
+	dest.gfxBG2Changed = src.gfxBG2Changed;
+	dest.gfxBG3Changed = src.gfxBG3Changed;
+	dest.gfxBG2X = src.gfxBG2X;
+	dest.gfxBG2Y = src.gfxBG2Y;
+	dest.gfxBG3X = src.gfxBG3X;
+	dest.gfxBG3Y = src.gfxBG3Y;
+	dest.gfxLastVCOUNT = src.gfxLastVCOUNT;
+}
+
+static void clearLines(GBALCD &lcd, uint lines)
+{
+	if(lines & 1)
+		gfxClearArray(lcd.line0);
+	if(lines & 2)
+		gfxClearArray(lcd.line1);
+	if(lines & 4)
+		gfxClearArray(lcd.line2);
+	if(lines & 8)
+		gfxClearArray(lcd.line3);
+}
+
+// only called for fully queued lines, so a short read is a bug
+static void readQueue(void *dest, uint bytes)
+{
+	uint read = queue.read((uchar*)dest, bytes);
+	if(read != bytes)
+		bug_exit("read %d of %d queued bytes", read, bytes);
+}
+
+static void drawLine(const LineJob &job)
+{
+	auto &lcd = workerLcd;
+	iterateTimes(job.chunks, i)
+	{
+		u16 chunk;
+		readQueue(&chunk, sizeof(chunk));
+		readQueue(chunkData(lcd, chunk), renderChunkSize);
+	}
+	clearLines(lcd, job.clearLines);
+	auto &ioMem = workerIoMem;
+	// the CPU side updates these on every WINxH write
+	if(ioMem.WIN0H != job.regs[WIN0HReg])
+		gfxUpdateWindow(lcd.gfxInWin0, job.regs[WIN0HReg]);
+	if(ioMem.WIN1H != job.regs[WIN1HReg])
+		gfxUpdateWindow(lcd.gfxInWin1, job.regs[WIN1HReg]);
+	memcpy(ioMem.b, job.regs, lcdRegsSize);
+	lcd.layerEnable = job.layerEnable;
+	lcd.fxOn = job.fxOn;
+	lcd.windowOn = job.windowOn;
+	lcd.gfxBG2Changed |= job.gfxBG2Changed;
+	lcd.gfxBG3Changed |= job.gfxBG3Changed;
+	job.renderLine(job.lineMix, lcd, ioMem);
+}
+
+static ptrsize runThread(ThreadPThread &thread)
+{
+	logMsg("started render thread");
+	for(;;)
+	{
+		mutex.lock();
+		// a line only counts as queued once its chunks are in the ring too
+		while(linesDone == linesQueued && !quitThread)
+			workCond.wait();
+		bool quit = quitThread;
+		mutex.unlock();
+		if(quit)
+			break;
+
+		LineJob job;
+		readQueue(&job, sizeof(job));
+		drawLine(job);
+
+		mutex.lock();
+		linesDone++;
+		doneCond.signal();
+		mutex.unlock();
+	}
+	logMsg("exiting render thread");
+	return 0;
+}
+
+void renderThreadClearLines(uint lines)
+{
+	pendingClearLines |= lines;
+}
+
+void renderThreadMarkAllDirty()
+{
+	iterateTimes(renderChunks, i)
+	{
+		renderThreadMarkChunk(i);
+	}
+}
+
+void renderThreadQueueLine(GBASys &gba)
+{
+	auto &lcd = gba.lcd;
+	LineJob job;
+	job.lineMix = lcd.lineMix;
+	job.renderLine = lcd.renderLine;
+	job.layerEnable = lcd.layerEnable;
+	job.gfxBG2Changed = lcd.gfxBG2Changed;
+	job.gfxBG3Changed = lcd.gfxBG3Changed;
+	lcd.gfxBG2Changed = lcd.gfxBG3Changed = 0;
+	job.chunks = renderDirtyChunks;
+	job.clearLines = pendingClearLines;
+	pendingClearLines = 0;
+	job.fxOn = lcd.fxOn;
+	job.windowOn = lcd.windowOn;
+	memcpy(job.regs, gba.mem.ioMem.b, lcdRegsSize);
+
+	uint bytes = sizeof(job) + renderDirtyChunks * (sizeof(u16) + renderChunkSize);
+	if(queue.writeAvailable() < bytes)
+	{
+		mutex.lock();
+		while(queue.writeAvailable() < bytes)
+			doneCond.wait();
+		mutex.unlock();
+	}
+	queue.write((uchar*)&job, sizeof(job));
+	iterateTimes(renderDirtyChunks, i)
+	{
+		u16 chunk = renderDirtyChunk[i];
+		queue.write((uchar*)&chunk, sizeof(chunk));
+		queue.write(chunkData(lcd, chunk), renderChunkSize);
+		renderChunkDirty[chunk] = 0;
+	}
+	renderDirtyChunks = 0;
+
+	mutex.lock();
+	linesQueued++;
+	workCond.signal();
+	mutex.unlock();
+}
+
+void renderThreadWait()
+{
+	if(!renderThreadActive)
+		return;
+	mutex.lock();
+	while(linesDone != linesQueued)
+		doneCond.wait();
+	mutex.unlock();
+}
+
+void renderThreadResync(GBASys &gba)
+{
+	if(!renderThreadActive)
+		return;
+	renderThreadWait();
+	memcpy(workerLcd.vram, gba.lcd.vram, sizeof(workerLcd.vram));
+	memcpy(workerLcd.paletteRAM, gba.lcd.paletteRAM, sizeof(workerLcd.paletteRAM));
+	memcpy(workerLcd.oam, gba.lcd.oam, sizeof(workerLcd.oam));
+	copyRendererState(workerLcd, gba.lcd);
+	memcpy(workerLcd.gfxInWin0, gba.lcd.gfxInWin0, sizeof(workerLcd.gfxInWin0));
+	memcpy(workerLcd.gfxInWin1, gba.lcd.gfxInWin1, sizeof(workerLcd.gfxInWin1));
+	memcpy(workerIoMem.b, gba.mem.ioMem.b, lcdRegsSize);
+	gba.lcd.gfxBG2Changed = gba.lcd.gfxBG3Changed = 0;
+	iterateTimes(renderDirtyChunks, i)
+	{
+		renderChunkDirty[renderDirtyChunk[i]] = 0;
+	}
+	renderDirtyChunks = 0;
+	pendingClearLines = 0;
+}
+
+bool renderThreadSetActive(GBASys &gba, bool on)
+{
+	if(on == renderThreadActive)
+		return true;
+	if(on)
+	{
+		if(!mutex.create() || !workCond.create(&mutex) || !doneCond.create(&mutex))
+			return false;
+		queue.init(queueBuff, queueSize);
+		linesQueued = linesDone = 0;
+		quitThread = false;
+		renderThreadActive = true;
+		renderThreadResync(gba);
+		if(!thread.create(0, ThreadPThread::EntryDelegate::create<&runThread>()))
+		{
+			renderThreadActive = false;
+			return false;
+		}
+		logMsg("rendering lines on worker thread");
+	}
+	else
+	{
+		renderThreadWait();
+		mutex.lock();
+		quitThread = true;
+		workCond.signal();
+		mutex.unlock();
+		thread.join();
+		workCond.destroy();
+		doneCond.destroy();
+		mutex.destroy();
+		// the synchronous renderer continues from the worker's state
+		int bg2Changed = gba.lcd.gfxBG2Changed, bg3Changed = gba.lcd.gfxBG3Changed;
+		copyRendererState(gba.lcd, workerLcd);
+		gba.lcd.gfxBG2Changed |= bg2Changed;
+		gba.lcd.gfxBG3Changed |= bg3Changed;
+		clearLines(gba.lcd, pendingClearLines);
+		pendingClearLines = 0;
+		iterateTimes(renderDirtyChunks, i)
+		{
+			renderChunkDirty[renderDirtyChunk[i]] = 0;
+		}
+		renderDirtyChunks = 0;
+		renderThreadActive = false;
+		logMsg("rendering lines synchronously");
+	}
+	return true;
+}
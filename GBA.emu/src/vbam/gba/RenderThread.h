@@ -0,0 +1,65 @@
+#ifndef GBA_RENDERTHREAD_H
+#define GBA_RENDERTHREAD_H
+
+#include "GBA.h"
+#include "GBAcpu.h"
+
+// Draws scanlines on a worker thread while the CPU emulation continues.
+// Each line is queued with a copy of the display registers & the LCD state
+// that picks its render function, followed by any 256-byte chunks of VRAM,
+// palette RAM or OAM written since the previous line. The worker applies
+// those chunks to its own copy of video memory before drawing, so each line
+// sees exactly what the synchronous renderer would have.
+
+static const uint renderChunkShift = 8;
+static const uint renderVramChunks = 0x20000 >> renderChunkShift;
+static const uint renderPaletteChunk = renderVramChunks;
+static const uint renderOamChunk = renderPaletteChunk + (0x400 >> renderChunkShift);
+static const uint renderChunks = renderOamChunk + (0x400 >> renderChunkShift);
+
+extern bool renderThreadActive;
+extern u8 renderChunkDirty[renderChunks];
+extern u16 renderDirtyChunk[renderChunks];
+extern uint renderDirtyChunks;
+
+// starts or stops the worker, the LCD state moves to the worker & back
+bool renderThreadSetActive(GBASys &gba, bool on);
+// queues the line at lcd.lineMix in place of calling lcd.renderLine
+void renderThreadQueueLine(GBASys &gba);
+// blocks until all queued lines are drawn
+void renderThreadWait();
+// reloads the worker's state after a reset or state load
+void renderThreadResync(GBASys &gba);
+void renderThreadMarkAllDirty();
+// line buffers the CPU side cleared, bit 0 for lcd.line0
+void renderThreadClearLines(uint lines);
+
+static inline void renderThreadMarkChunk(uint chunk)
+{
+	if(!renderChunkDirty[chunk])
+	{
+		renderChunkDirty[chunk] = 1;
+		renderDirtyChunk[renderDirtyChunks++] = chunk;
+	}
+}
+
+// call after writing video memory at the given offset into each array
+static inline void renderThreadVramWritten(u32 offset)
+{
+	if(UNLIKELY(renderThreadActive))
+		renderThreadMarkChunk(offset >> renderChunkShift);
+}
+
+static inline void renderThreadPaletteWritten(u32 offset)
+{
+	if(UNLIKELY(renderThreadActive))
+		renderThreadMarkChunk(renderPaletteChunk + (offset >> renderChunkShift));
+}
+
+static inline void renderThreadOamWritten(u32 offset)
+{
+	if(UNLIKELY(renderThreadActive))
+		renderThreadMarkChunk(renderOamChunk + (offset >> renderChunkShift));
+}
+
+#endif // GBA_RENDERTHREAD_H
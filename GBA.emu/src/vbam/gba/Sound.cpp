@@ -12,6 +12,7 @@
 
 #include "../common/SoundDriver.h"
 #include <util/number.h>
+#include <util/time/FrameProfiler.hh>
 
 #define NR10 0x60
 #define NR11 0x62
@@ -388,6 +389,7 @@ void flush_samples(Multi_Buffer * buffer, bool renderAudio)
 {
 	// Write one video frame worth of audio
 	{
+		profileZone(ZONE_RESAMPLE);
 		uint samples = buffer->samples_avail();
 		if(likely(renderAudio))
 		{
@@ -437,6 +439,7 @@ static void apply_filtering()
 
 void psoundTickfn(bool renderAudio)
 {
+	profileZone(ZONE_AUDIO);
 	// Run sound hardware to present
 	end_frame( SOUND_CLOCK_TICKS );
 
@@ -612,6 +615,13 @@ void soundSetSampleRate(GBASys &gba, uint sampleRate)
 	}
 }
 
+void soundAdjustSampleRate(uint sampleRate)
+{
+	// the buffers stay at soundSampleRate & only the resampling ratio
+	// changes, so the APU state & buffered samples are kept
+	stereo_buffer.clock_rate( (long)((double)gb_apu.clock_rate * soundSampleRate / sampleRate) );
+}
+
 static int dummy_state [16];
 
 #define SKIP( type, name ) { dummy_state, sizeof (type) }
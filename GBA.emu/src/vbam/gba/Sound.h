@@ -41,6 +41,8 @@ void soundShutdown();
 
 uint soundGetSampleRate();
 void soundSetSampleRate(GBASys &gba, uint sampleRate);
+// small rate changes while running, without resetting the sound hardware
+void soundAdjustSampleRate(uint sampleRate);
 
 // Sound settings
 extern bool &soundInterpolation; // 1 if PCM should have low-pass filtering
@@ -23,6 +23,7 @@
 #include "loadres.h"
 #include "gbint.h"
 #include <string>
+#include <cstddef>
 
 namespace gambatte {
 enum { BG_PALETTE = 0, SP1_PALETTE = 1, SP2_PALETTE = 2 };
@@ -125,6 +126,20 @@ public:
 	  */
 	bool loadState(const std::string &filepath);
 	
+	/** Saves emulator state to the memory at 'buf'.
+	  *
+	  * @param  videoBuf 160x144 RGB32 (native endian) video frame buffer or 0. Used for saving a thumbnail.
+	  * @param  pitch distance in number of pixels (not bytes) from the start of one line to the next in videoBuf.
+	  * @return bytes written, 0 on error or if 'size' is too small, or the size needed when 'buf' is 0
+	  */
+	std::size_t saveState(const gambatte::PixelType *videoBuf, int pitch, char *buf, std::size_t size);
+	
+	/** Loads emulator state from the memory at 'buf', as written by the above.
+	  * Unlike loading from a file, the battery data isn't flushed to disk first.
+	  * @return success
+	  */
+	bool loadState(const char *buf, std::size_t size);
+	
 	/** Selects which state slot to save state to or load state from.
 	  * There are 10 such slots, numbered from 0 to 9 (periodically extended for all n).
 	  */
@@ -41,8 +41,8 @@ enum AsciiChar {
 
 struct Saver {
 	const char *label;
-	void (*save)(std::ofstream &file, const SaveState &state);
-	void (*load)(std::ifstream &file, SaveState &state);
+	void (*save)(std::ostream &file, const SaveState &state);
+	void (*load)(std::istream &file, SaveState &state);
 	unsigned char labelsize;
 };
 
@@ -50,27 +50,27 @@ static inline bool operator<(const Saver &l, const Saver &r) {
 	return std::strcmp(l.label, r.label) < 0;
 }
 
-static void put24(std::ofstream &file, const unsigned long data) {
+static void put24(std::ostream &file, const unsigned long data) {
 	file.put(data >> 16 & 0xFF);
 	file.put(data >> 8 & 0xFF);
 	file.put(data & 0xFF);
 }
 
-static void put32(std::ofstream &file, const unsigned long data) {
+static void put32(std::ostream &file, const unsigned long data) {
 	file.put(data >> 24 & 0xFF);
 	file.put(data >> 16 & 0xFF);
 	file.put(data >> 8 & 0xFF);
 	file.put(data & 0xFF);
 }
 
-static void write(std::ofstream &file, const unsigned char data) {
+static void write(std::ostream &file, const unsigned char data) {
 	static const char inf[] = { 0x00, 0x00, 0x01 };
 	
 	file.write(inf, sizeof(inf));
 	file.put(data & 0xFF);
 }
 
-static void write(std::ofstream &file, const unsigned short data) {
+static void write(std::ostream &file, const unsigned short data) {
 	static const char inf[] = { 0x00, 0x00, 0x02 };
 	
 	file.write(inf, sizeof(inf));
@@ -78,30 +78,30 @@ static void write(std::ofstream &file, const unsigned short data) {
 	file.put(data & 0xFF);
 }
 
-static void write(std::ofstream &file, const unsigned long data) {
+static void write(std::ostream &file, const unsigned long data) {
 	static const char inf[] = { 0x00, 0x00, 0x04 };
 	
 	file.write(inf, sizeof(inf));
 	put32(file, data);
 }
 
-static inline void write(std::ofstream &file, const bool data) {
+static inline void write(std::ostream &file, const bool data) {
 	write(file, static_cast<unsigned char>(data));
 }
 
-static void write(std::ofstream &file, const unsigned char *data, const unsigned long sz) {
+static void write(std::ostream &file, const unsigned char *data, const unsigned long sz) {
 	put24(file, sz);
 	file.write(reinterpret_cast<const char*>(data), sz);
 }
 
-static void write(std::ofstream &file, const bool *data, const unsigned long sz) {
+static void write(std::ostream &file, const bool *data, const unsigned long sz) {
 	put24(file, sz);
 	
 	for (unsigned long i = 0; i < sz; ++i)
 		file.put(data[i]);
 }
 
-static unsigned long get24(std::ifstream &file) {
+static unsigned long get24(std::istream &file) {
 	unsigned long tmp = file.get() & 0xFF;
 	
 	tmp = tmp << 8 | (file.get() & 0xFF);
@@ -109,7 +109,7 @@ static unsigned long get24(std::ifstream &file) {
 	return tmp << 8 | (file.get() & 0xFF);
 }
 
-static unsigned long read(std::ifstream &file) {
+static unsigned long read(std::istream &file) {
 	unsigned long size = get24(file);
 	
 	if (size > 4) {
@@ -129,23 +129,23 @@ static unsigned long read(std::ifstream &file) {
 	return out;
 }
 
-static inline void read(std::ifstream &file, unsigned char &data) {
+static inline void read(std::istream &file, unsigned char &data) {
 	data = read(file) & 0xFF;
 }
 
-static inline void read(std::ifstream &file, unsigned short &data) {
+static inline void read(std::istream &file, unsigned short &data) {
 	data = read(file) & 0xFFFF;
 }
 
-static inline void read(std::ifstream &file, unsigned long &data) {
+static inline void read(std::istream &file, unsigned long &data) {
 	data = read(file);
 }
 
-static inline void read(std::ifstream &file, bool &data) {
+static inline void read(std::istream &file, bool &data) {
 	data = read(file);
 }
 
-static void read(std::ifstream &file, unsigned char *data, unsigned long sz) {
+static void read(std::istream &file, unsigned char *data, unsigned long sz) {
 	const unsigned long size = get24(file);
 	
 	if (size < sz)
@@ -160,7 +160,7 @@ static void read(std::ifstream &file, unsigned char *data, unsigned long sz) {
 	}
 }
 
-static void read(std::ifstream &file, bool *data, unsigned long sz) {
+static void read(std::istream &file, bool *data, unsigned long sz) {
 	const unsigned long size = get24(file);
 	
 	if (size < sz)
@@ -193,8 +193,8 @@ public:
 };
 
 static void pushSaver(SaverList::list_t &list, const char *label,
-		void (*save)(std::ofstream &file, const SaveState &state),
-		void (*load)(std::ifstream &file, SaveState &state), unsigned char labelsize) {
+		void (*save)(std::ostream &file, const SaveState &state),
+		void (*load)(std::istream &file, SaveState &state), unsigned char labelsize) {
 	const Saver saver = { label, save, load, labelsize };
 	list.push_back(saver);
 }
@@ -202,8 +202,8 @@ static void pushSaver(SaverList::list_t &list, const char *label,
 SaverList::SaverList() {
 #define ADD(arg) do { \
 	struct Func { \
-		static void save(std::ofstream &file, const SaveState &state) { write(file, state.arg); } \
-		static void load(std::ifstream &file, SaveState &state) { read(file, state.arg); } \
+		static void save(std::ostream &file, const SaveState &state) { write(file, state.arg); } \
+		static void load(std::istream &file, SaveState &state) { read(file, state.arg); } \
 	}; \
 	\
 	pushSaver(list, label, Func::save, Func::load, sizeof label); \
@@ -211,8 +211,8 @@ SaverList::SaverList() {
 
 #define ADDPTR(arg) do { \
 	struct Func { \
-		static void save(std::ofstream &file, const SaveState &state) { write(file, state.arg.get(), state.arg.getSz()); } \
-		static void load(std::ifstream &file, SaveState &state) { read(file, state.arg.ptr, state.arg.getSz()); } \
+		static void save(std::ostream &file, const SaveState &state) { write(file, state.arg.get(), state.arg.getSz()); } \
+		static void load(std::istream &file, SaveState &state) { read(file, state.arg.ptr, state.arg.getSz()); } \
 	}; \
 	\
 	pushSaver(list, label, Func::save, Func::load, sizeof label); \
@@ -220,8 +220,8 @@ SaverList::SaverList() {
 
 #define ADDARRAY(arg) do { \
 	struct Func { \
-		static void save(std::ofstream &file, const SaveState &state) { write(file, state.arg, sizeof(state.arg)); } \
-		static void load(std::ifstream &file, SaveState &state) { read(file, state.arg, sizeof(state.arg)); } \
+		static void save(std::ostream &file, const SaveState &state) { write(file, state.arg, sizeof(state.arg)); } \
+		static void load(std::istream &file, SaveState &state) { read(file, state.arg, sizeof(state.arg)); } \
 	}; \
 	\
 	pushSaver(list, label, Func::save, Func::load, sizeof label); \
@@ -373,7 +373,7 @@ static void blendPxlPairs(PxlSum *const dst, const PxlSum *const sums) {
 	dst->g  = sums[1].g  * 8 + (sums[0].g  - sums[1].g ) * 3;
 }
 
-static void writeSnapShot(std::ofstream &file, const gambatte::PixelType *pixels, const int pitch) {
+static void writeSnapShot(std::ostream &file, const gambatte::PixelType *pixels, const int pitch) {
 	put24(file, pixels ? StateSaver::SS_WIDTH * StateSaver::SS_HEIGHT * sizeof(gambatte::PixelType) : 0);
 	
 	if (pixels) {
@@ -409,6 +409,34 @@ static SaverList list;
 
 namespace gambatte {
 
+namespace {
+
+// streambuf over a fixed memory area, writes past the end fail the stream
+class MemBuf : public std::streambuf {
+public:
+	MemBuf(char *buf, std::size_t size) {
+		setp(buf, buf + size);
+		setg(buf, buf, buf + size);
+	}
+	
+	std::size_t written() const { return pptr() - pbase(); }
+};
+
+// streambuf that only counts what's written to it
+class CountBuf : public std::streambuf {
+	std::size_t count_;
+	
+protected:
+	int_type overflow(int_type c) { ++count_; return traits_type::not_eof(c); }
+	std::streamsize xsputn(const char *, std::streamsize n) { count_ += n; return n; }
+	
+public:
+	CountBuf() : count_(0) {}
+	std::size_t count() const { return count_; }
+};
+
+}
+
 bool StateSaver::saveState(const SaveState &state,
 		const PixelType *const videoBuf,
 		const int pitch, const std::string &filename) {
@@ -417,6 +445,28 @@ bool StateSaver::saveState(const SaveState &state,
 	if (file.fail())
 		return false;
 	
+	return saveState(state, videoBuf, pitch, file);
+}
+
+std::size_t StateSaver::saveState(const SaveState &state,
+		const PixelType *const videoBuf,
+		const int pitch, char *const buf, const std::size_t size) {
+	if (!buf) {
+		CountBuf count;
+		std::ostream file(&count);
+		saveState(state, videoBuf, pitch, file);
+		return count.count();
+	}
+	
+	MemBuf mem(buf, size);
+	std::ostream file(&mem);
+	
+	return saveState(state, videoBuf, pitch, file) ? mem.written() : 0;
+}
+
+bool StateSaver::saveState(const SaveState &state,
+		const PixelType *const videoBuf,
+		const int pitch, std::ostream &file) {
 	{ static const char ver[] = { 0, 1 }; file.write(ver, sizeof(ver)); }
 	
 	writeSnapShot(file, videoBuf, pitch);
@@ -432,7 +482,21 @@ bool StateSaver::saveState(const SaveState &state,
 bool StateSaver::loadState(SaveState &state, const std::string &filename) {
 	std::ifstream file(filename.c_str(), std::ios_base::binary);
 	
-	if (file.fail() || file.get() != 0)
+	if (file.fail())
+		return false;
+	
+	return loadState(state, file);
+}
+
+bool StateSaver::loadState(SaveState &state, const char *const buf, const std::size_t size) {
+	MemBuf mem(const_cast<char*>(buf), size);
+	std::istream file(&mem);
+	
+	return loadState(state, file);
+}
+
+bool StateSaver::loadState(SaveState &state, std::istream &file) {
+	if (file.get() != 0)
 		return false;
 	
 	file.ignore();
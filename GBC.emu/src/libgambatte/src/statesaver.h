@@ -21,6 +21,8 @@
 
 #include "gbint.h"
 #include <string>
+#include <iosfwd>
+#include <cstddef>
 
 namespace gambatte {
 
@@ -38,6 +40,13 @@ public:
 	static bool saveState(const SaveState &state,
 			const PixelType *videoBuf, int pitch, const std::string &filename);
 	static bool loadState(SaveState &state, const std::string &filename);
+	// memory versions, a null buf makes saveState return the size needed
+	static std::size_t saveState(const SaveState &state,
+			const PixelType *videoBuf, int pitch, char *buf, std::size_t size);
+	static bool loadState(SaveState &state, const char *buf, std::size_t size);
+	static bool saveState(const SaveState &state,
+			const PixelType *videoBuf, int pitch, std::ostream &file);
+	static bool loadState(SaveState &state, std::istream &file);
 };
 
 }
@@ -378,25 +378,35 @@ int EmuSystem::saveState()
 	#ifdef CONFIG_BASE_IOS_SETUID
 		fixFilePermissions(saveStr);
 	#endif
-	if(!gbEmu.saveState(/*screenBuff*/0, 160, saveStr))
-		return STATE_RESULT_IO_ERROR;
-	else
-		return STATE_RESULT_OK;
+	return saveStateFile(saveStr);
 }
 
 int EmuSystem::loadState(int saveStateSlot)
 {
 	FsSys::cPath saveStr;
 	sprintStateFilename(saveStr, saveStateSlot);
-	if(FsSys::fileExists(saveStr))
-	{
-		logMsg("loading state %s", saveStr);
-		if(!gbEmu.loadState(saveStr))
-			return STATE_RESULT_IO_ERROR;
-		else
-			return STATE_RESULT_OK;
-	}
-	return STATE_RESULT_NO_FILE;
+	if(!FsSys::fileExists(saveStr))
+		return STATE_RESULT_NO_FILE;
+	// keep the battery data from before the load like loading through gambatte did
+	gbEmu.saveSavedata();
+	return loadStateFile(saveStr);
+}
+
+uint EmuSystem::stateBufferSize()
+{
+	return gbEmu.saveState(/*screenBuff*/0, 160, nullptr, 0);
+}
+
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size)
+{
+	return gbEmu.saveState(/*screenBuff*/0, 160, (char*)buff, size);
+}
+
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size)
+{
+	if(!gbEmu.loadState((const char*)buff, size))
+		return STATE_RESULT_INVALID_DATA;
+	return STATE_RESULT_OK;
 }
 
 void EmuSystem::saveBackupMem()
@@ -422,7 +432,7 @@ void EmuSystem::saveAutoState()
 		#ifdef CONFIG_BASE_IOS_SETUID
 			fixFilePermissions(saveStr);
 		#endif
-		gbEmu.saveState(/*screenBuff*/0, 160, saveStr);
+		saveStateFile(saveStr, 1);
 	}
 }
 
@@ -460,18 +470,24 @@ void EmuSystem::clearInputBuffers()
 	gbcInput.bits = 0;
 }
 
-void EmuSystem::configAudioRate()
+static long soundOutputRate()
 {
-	pcmFormat.rate = optionSoundRate;
 	#ifdef CONFIG_BASE_IOS
 	long outputRate = (float)optionSoundRate*.99555;
 	#elif defined(CONFIG_BASE_ANDROID)
-	long outputRate = (uint)optionFrameSkip == optionFrameSkipAuto ? (float)optionSoundRate*.99555 : (float)optionSoundRate*.9954;
+	long outputRate = (uint)optionFrameSkip == EmuSystem::optionFrameSkipAuto ? (float)optionSoundRate*.99555 : (float)optionSoundRate*.9954;
 	#elif defined(CONFIG_ENV_WEBOS)
-	long outputRate = (uint)optionFrameSkip == optionFrameSkipAuto ? (float)optionSoundRate*.99555 : (float)optionSoundRate*.963;
+	long outputRate = (uint)optionFrameSkip == EmuSystem::optionFrameSkipAuto ? (float)optionSoundRate*.99555 : (float)optionSoundRate*.963;
 	#else
 	long outputRate = float(optionSoundRate)*.99555;
 	#endif
+	return outputRate * EmuSystem::audioRateScale;
+}
+
+void EmuSystem::configAudioRate()
+{
+	pcmFormat.rate = optionSoundRate;
+	long outputRate = soundOutputRate();
 	audioFramesPerUpdateScaler = outputRate/2097152.;
 	if(optionAudioResampler >= ResamplerInfo::num())
 		optionAudioResampler = IG::min((int)ResamplerInfo::num(), 1);
@@ -484,6 +500,14 @@ void EmuSystem::configAudioRate()
 	}
 }
 
+void EmuSystem::applyAudioRateScale()
+{
+	long outputRate = soundOutputRate();
+	audioFramesPerUpdateScaler = outputRate/2097152.;
+	if(resampler)
+		resampler->adjustRate(2097152, outputRate);
+}
+
 static void writeAudio(const int16 *srcBuff, unsigned srcFrames)
 {
 	#ifdef USE_NEW_AUDIO
@@ -553,7 +577,10 @@ void onInputEvent(const Input::Event &e)
 namespace Base
 {
 
-void onAppMessage(int type, int shortArg, int intArg, int intArg2) { }
+void onAppMessage(int type, int shortArg, int intArg, int intArg2)
+{
+	EmuIoWorker::onAppMessage(type, shortArg, intArg, intArg2);
+}
 
 CallResult onInit(int argc, char** argv)
 {
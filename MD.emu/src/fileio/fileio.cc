@@ -1,176 +1,147 @@
-#define thisModuleName "fileio"
-#include "shared.h"
-#include <unzip.h>
-#include <io/sys.hh>
-
-uint isROMExtension(const char *name);
-
-/*
-    Load a normal file, or ZIP/GZ archive.
-    Returns NULL if an error occured.
-*/
-uint8 *load_archive(char *filename, int *file_size)
-{
-    int size = 0;
-    uint8 *buf = NULL;
-
-    if(check_zip(filename))
-    {
-        unzFile fd = NULL;
-        unz_file_info info;
-        int ret = 0;
-
-        /* Attempt to open the archive */
-        fd = unzOpen(filename);
-        if(!fd) return (NULL);
-
-        /* Go to first file in archive */
-        ret = unzGoToFirstFile(fd);
-        if(ret != UNZ_OK)
-        {
-            unzClose(fd);
-            return (NULL);
-        }
-
-        // Find a valid file
-        bool foundRom = 0;
-        do
-        {
-        	ret = unzGetCurrentFileInfo(fd, &info, filename, 128, NULL, 0, NULL, 0);
-			if(ret != UNZ_OK)
-			{
-				unzClose(fd);
-				return (NULL);
-			}
-
-			if(isROMExtension(filename))
-			{
-				foundRom = 1;
-				break;
-			}
-        }
-        while(unzGoToNextFile(fd) == UNZ_OK);
-
-        if(!foundRom)
-        {
-        	unzClose(fd);
-        	return (NULL);
-        }
-
-        /* Open the file for reading */
-        ret = unzOpenCurrentFile(fd);
-        if(ret != UNZ_OK)
-        {
-            unzClose(fd);
-            return (NULL);
-        }
-
-        /* Allocate file data buffer */
-        size = info.uncompressed_size;
-        buf = (uint8*)malloc(size);
-        if(!buf)
-        {
-            unzClose(fd);
-            return (NULL);
-        }
-
-        /* Read (decompress) the file */
-        ret = unzReadCurrentFile(fd, buf, info.uncompressed_size);
-        if(ret != (int)info.uncompressed_size)
-        {
-            free(buf);
-            unzCloseCurrentFile(fd);
-            unzClose(fd);
-            return (NULL);
-        }
-
-        /* Close the current file */
-        ret = unzCloseCurrentFile(fd);
-        if(ret != UNZ_OK)
-        {
-            free(buf);
-            unzClose(fd);
-            return (NULL);
-        }
-
-        /* Close the archive */
-        ret = unzClose(fd);
-        if(ret != UNZ_OK)
-        {
-            free(buf);
-            return (NULL);
-        }
-
-        /* Update file size and return pointer to file data */
-        *file_size = size;
-        return (buf);
-    }
-    else
-    {
-        Io *gd = NULL;
-
-        /* Open file */
-        gd = IoSys::open(filename);
-        if(!gd) return (0);
-
-        /* Get file size */
-        size = gd->size();
-
-        /* Allocate file data buffer */
-        buf = (uint8*)malloc(size);
-        if(!buf)
-        {
-            delete gd;
-            return (0);
-        }
-
-        /* Read file data */
-        gd->read(buf, size);
-
-        /* Close file */
-        delete gd;
-
-        /* Update file size and return pointer to file data */
-        *file_size = size;
-        return (buf);
-    }
-}
-
-
-/*
-    Verifies if a file is a ZIP archive or not.
-    Returns: 1= ZIP archive, 0= not a ZIP archive
-*/
-int check_zip(char *filename)
-{
-    uint8 buf[2];
-    FILE *fd = NULL;
-    fd = fopen(filename, "rb");
-    if(!fd) return (0);
-    fread(buf, 2, 1, fd);
-    fclose(fd);
-    if(memcmp(buf, "PK", 2) == 0) return (1);
-    return (0);
-}
-
-
-/*
-    Returns the size of a GZ compressed file.
-*/
-int gzsize(gzFile gd)
-{
-    #define CHUNKSIZE   (0x10000)
-    int size = 0, length = 0;
-    unsigned char buffer[CHUNKSIZE];
-    gzrewind(gd);
-    do {
-        size = gzread(gd, buffer, CHUNKSIZE);
-        if(size <= 0) break;
-        length += size;
-    } while (!gzeof(gd));
-    gzrewind(gd);
-    return (length);
-    #undef CHUNKSIZE
-}
-
-#undef thisModuleName
+#define thisModuleName "fileio"
+#include "shared.h"
+#include <unzip.h>
+#include <io/sys.hh>
+#ifdef CONFIG_IO_ARCHIVE
+#include <io/archive/ArchiveCache.hh>
+#endif
+
+uint isROMExtension(const char *name);
+
+#ifdef CONFIG_IO_ARCHIVE
+static bool isROMEntry(const char *name)
+{
+	return isROMExtension(name);
+}
+#else
+/*
+    Reads the first ROM in a ZIP archive, copying its name to filename.
+*/
+static int load_zip(char *filename, uint8 *buffer, int maxsize)
+{
+    unzFile fd = NULL;
+    unz_file_info info;
+    int ret = 0;
+
+    /* Attempt to open the archive */
+    fd = unzOpen(filename);
+    if(!fd) return (0);
+
+    /* Go to first file in archive */
+    ret = unzGoToFirstFile(fd);
+    if(ret != UNZ_OK)
+    {
+        unzClose(fd);
+        return (0);
+    }
+
+    // Find a valid file
+    bool foundRom = 0;
+    do
+    {
+        ret = unzGetCurrentFileInfo(fd, &info, filename, 128, NULL, 0, NULL, 0);
+        if(ret != UNZ_OK)
+        {
+            unzClose(fd);
+            return (0);
+        }
+
+        if(isROMExtension(filename))
+        {
+            foundRom = 1;
+            break;
+        }
+    }
+    while(unzGoToNextFile(fd) == UNZ_OK);
+
+    if(!foundRom)
+    {
+        unzClose(fd);
+        return (0);
+    }
+
+    /* Open the file for reading */
+    ret = unzOpenCurrentFile(fd);
+    if(ret != UNZ_OK)
+    {
+        unzClose(fd);
+        return (0);
+    }
+
+    /* Read (decompress) the file straight into the ROM area */
+    int size = IG::min((int)info.uncompressed_size, maxsize);
+    ret = unzReadCurrentFile(fd, buffer, size);
+    unzCloseCurrentFile(fd);
+    unzClose(fd);
+    if(ret != size)
+        return (0);
+
+    return (size);
+}
+#endif
+
+/*
+    Load a normal file, or the first ROM in a ZIP/7Z archive.
+    The archive's ROM name is copied to filename.
+    Reads at most maxsize bytes into buffer and returns the size read,
+    or 0 if an error occured.
+*/
+int load_archive(char *filename, uint8 *buffer, int maxsize)
+{
+    /* Open file, archives are extracted through the ROM cache */
+    #ifdef CONFIG_IO_ARCHIVE
+    Io *gd = ArchiveCache::openFile(filename, IoArchive::EntryFilter::create<&isROMEntry>(), "md", filename, 128);
+    #else
+    if(check_zip(filename))
+        return load_zip(filename, buffer, maxsize);
+    Io *gd = IoSys::open(filename);
+    #endif
+    if(!gd) return (0);
+
+    /* Copy straight from the mapped file into the ROM area */
+    int size = gd->readUpTo(buffer, maxsize);
+
+    /* Close file */
+    delete gd;
+
+    return (size);
+}
+
+
+/*
+    Verifies if a file is a ZIP archive or not.
+    Returns: 1= ZIP archive, 0= not a ZIP archive
+*/
+int check_zip(char *filename)
+{
+    uint8 buf[2];
+    FILE *fd = NULL;
+    fd = fopen(filename, "rb");
+    if(!fd) return (0);
+    fread(buf, 2, 1, fd);
+    fclose(fd);
+    if(memcmp(buf, "PK", 2) == 0) return (1);
+    return (0);
+}
+
+
+/*
+    Returns the size of a GZ compressed file.
+*/
+int gzsize(gzFile gd)
+{
+    #define CHUNKSIZE   (0x10000)
+    int size = 0, length = 0;
+    unsigned char buffer[CHUNKSIZE];
+    gzrewind(gd);
+    do {
+        size = gzread(gd, buffer, CHUNKSIZE);
+        if(size <= 0) break;
+        length += size;
+    } while (!gzeof(gd));
+    gzrewind(gd);
+    return (length);
+    #undef CHUNKSIZE
+}
+
+#undef thisModuleName
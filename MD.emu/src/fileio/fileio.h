@@ -6,7 +6,7 @@ extern int cart_size;
 extern char cart_name[0x100];
 
 /* Function prototypes */
-uint8 *load_archive(char *filename, int *file_size);
+int load_archive(char *filename, uint8 *buffer, int maxsize);
 int load_cart(char *filename);
 int check_zip(char *filename);
 int gzsize(gzFile *gd);
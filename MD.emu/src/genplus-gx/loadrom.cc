@@ -379,11 +379,8 @@ int load_rom(char *filename)
 {
   int i, size;
  
-  uint8 *ptr;
-  ptr = load_archive(filename, &size);
-  if(!ptr) return (0);
-  memcpy(cart.rom, ptr, size);
-  free(ptr);
+  size = load_archive(filename, cart.rom, sizeof(cart.rom));
+  if(!size) return (0);
 
   /* Minimal ROM size */
   /*if (size < 0x4000)
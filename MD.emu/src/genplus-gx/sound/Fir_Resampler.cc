@@ -152,7 +152,7 @@ void Fir_Resampler_clear()
   }
 }
 
-SysDDec Fir_Resampler_time_ratio( SysDDec new_factor, SysDDec rolloff )
+static SysDDec set_ratio( SysDDec new_factor, SysDDec rolloff )
 {
   ratio = new_factor;
 
@@ -205,8 +205,22 @@ SysDDec Fir_Resampler_time_ratio( SysDDec new_factor, SysDDec rolloff )
     }
   }
 
+  return ratio;
+}
+
+SysDDec Fir_Resampler_time_ratio( SysDDec new_factor, SysDDec rolloff )
+{
+  set_ratio( new_factor, rolloff );
   Fir_Resampler_clear();
+  return ratio;
+}
 
+/* Changes the ratio but keeps the buffered input, so output continues */
+/* without a gap */
+SysDDec Fir_Resampler_set_ratio( SysDDec new_factor, SysDDec rolloff )
+{
+  set_ratio( new_factor, rolloff );
+  imp_phase = 0;
   return ratio;
 }
 
@@ -32,6 +32,7 @@ extern int Fir_Resampler_initialize( int new_size );
 extern void Fir_Resampler_shutdown( void );
 extern void Fir_Resampler_clear( void );
 extern SysDDec Fir_Resampler_time_ratio( SysDDec new_factor, SysDDec rolloff );
+extern SysDDec Fir_Resampler_set_ratio( SysDDec new_factor, SysDDec rolloff );
 extern SysDDec Fir_Resampler_ratio( void );
 extern int Fir_Resampler_max_write( void );
 extern sample_t* Fir_Resampler_buffer( void );
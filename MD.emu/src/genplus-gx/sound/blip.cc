@@ -52,6 +52,11 @@ blip_buffer_t* blip_alloc( SysDDec clock_rate, SysDDec sample_rate, int size )
   return s;
 }
 
+void blip_set_rates( blip_buffer_t* s, SysDDec clock_rate, SysDDec sample_rate )
+{
+  s->factor = (int) (sample_rate / clock_rate * time_unit + 0.5);
+}
+
 void blip_free( blip_buffer_t* s )
 {
   free( s );
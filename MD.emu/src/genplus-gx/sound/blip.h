@@ -15,6 +15,10 @@ sample rate, and size (in samples), or returns NULL if out of memory. */
 typedef struct blip_buffer_t blip_buffer_t;
 blip_buffer_t* blip_alloc( SysDDec clock_rate, SysDDec sample_rate, int size );
 
+/* Changes the input clock and output sample rates, keeping any samples
+already in the buffer. */
+void blip_set_rates( blip_buffer_t*, SysDDec clock_rate, SysDDec sample_rate );
+
 /* Frees memory used by a blip_buffer. No effect if NULL is passed. */
 void blip_free( blip_buffer_t* );
 
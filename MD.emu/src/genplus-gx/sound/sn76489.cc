@@ -90,6 +90,11 @@ void SN76489_Init(SysDDec PSGClockValue, int SamplingRate)
   blip = blip_alloc(PSGClockValue, SamplingRate * 16.0, SamplingRate / 4);
 }
 
+void SN76489_SetRate(SysDDec PSGClockValue, int SamplingRate)
+{
+  if (blip) blip_set_rates(blip, PSGClockValue, SamplingRate * 16.0);
+}
+
 void SN76489_Reset()
 {
   int i;
@@ -179,6 +179,28 @@ void sound_init(void)
 #endif
 }
 
+/* Apply a new snd.sample_rate without resetting the sound chips */
+void sound_update_rate(void)
+{
+  if (!config_hq_fm)
+  {
+    /* FM chips run at the output rate */
+    sound_restore();
+    return;
+  }
+
+  SysDDec mclk = MCYCLES_PER_LINE * lines_per_frame * snd.frame_rate;
+  psg_cycles_ratio = (unsigned int)(mclk / (SysDDec) snd.sample_rate * 2048.0);
+  SN76489_SetRate(mclk/15.0,snd.sample_rate);
+
+  #ifndef NO_SYSTEM_PBC
+  if (system_hw == SYSTEM_PBC)
+	Fir_Resampler_set_ratio(mclk / (SysDDec)snd.sample_rate / (72.0 * 15.0), config_rolloff);
+  else
+  #endif
+	Fir_Resampler_set_ratio(mclk / (SysDDec)snd.sample_rate / (144.0 * 7.0), config_rolloff);
+}
+
 /* Reset sound chips emulation */
 void sound_reset(void)
 {
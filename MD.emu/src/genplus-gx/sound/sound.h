@@ -28,6 +28,7 @@
 extern void sound_init(void);
 extern void sound_reset(void);
 extern void sound_restore(void);
+extern void sound_update_rate(void);
 extern int sound_context_save(uint8 *state);
 extern int sound_context_load(uint8 *state, char *version);
 extern int sound_update(unsigned int cycles);
@@ -30,9 +30,6 @@ int state_load(const unsigned char *buffer)
 	if(!state)
 		return -1;
 
-  /* buffer size */
-  int bufferptr = 0;
-
   /* uncompress savestate */
   unsigned long inbytes, outbytes;
   memcpy(&inbytes, buffer, 4);
@@ -43,20 +40,30 @@ int state_load(const unsigned char *buffer)
     return -1;
   }
 
+  int ret = state_load_uncompressed(state);
+  free(state);
+  return ret;
+}
+
+int state_load_uncompressed(const unsigned char *buffer)
+{
+  unsigned char *state = (unsigned char*)buffer;
+
+  /* buffer size */
+  int bufferptr = 0;
+
   /* signature check (GENPLUS-GX x.x.x) */
   char version[17];
   load_param(version,16);
   version[16] = 0;
   if (strncmp(version,STATE_VERSION,11))
   {
-  	free(state);
     return -1;
   }
 
   /* version check (1.5.0 and above) */
   if ((version[11] < 0x31) || ((version[11] == 0x31) && (version[13] < 0x35)))
   {
-  	free(state);
     return -1;
   }
 
@@ -176,7 +183,6 @@ int state_load(const unsigned char *buffer)
 	}
 	#endif
 
-	free(state);
   return 1;
 }
 
@@ -186,6 +192,21 @@ int state_save(unsigned char *buffer)
 	if(!state)
 		return -1;
 
+  /* compress state file */
+  unsigned long inbytes   = state_save_uncompressed(state);
+  unsigned long outbytes  = STATE_SIZE;
+  logMsg("compressing %d bytes to buffer of %d size", (int)inbytes, (int)outbytes);
+  int ret = compress2 ((Bytef *)(buffer + 4), &outbytes, (Bytef *)state, inbytes, 9);
+  logMsg("compress2 returned %d", ret);
+  free(state);
+  memcpy(buffer, &outbytes, 4);
+
+  /* return total size */
+  return (outbytes + 4);
+}
+
+int state_save_uncompressed(unsigned char *state)
+{
   /* buffer size */
   int bufferptr = 0;
 
@@ -280,15 +301,6 @@ int state_save(unsigned char *buffer)
 	}
 	#endif
 
-  /* compress state file */
-  unsigned long inbytes   = bufferptr;
-  unsigned long outbytes  = STATE_SIZE;
-  logMsg("compressing %d bytes to buffer of %d size", (int)inbytes, (int)outbytes);
-  int ret = compress2 ((Bytef *)(buffer + 4), &outbytes, (Bytef *)state, inbytes, 9);
-  logMsg("compress2 returned %d", ret);
-  free(state);
-  memcpy(buffer, &outbytes, 4);
-
-  /* return total size */
-  return (outbytes + 4);
+  /* return uncompressed size */
+  return bufferptr;
 }
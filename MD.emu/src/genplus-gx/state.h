@@ -42,5 +42,7 @@
 /* Function prototypes */
 extern int state_load(const unsigned char *buffer);
 extern int state_save(unsigned char *buffer);
+extern int state_load_uncompressed(const unsigned char *state);
+extern int state_save_uncompressed(unsigned char *state);
 
 #endif
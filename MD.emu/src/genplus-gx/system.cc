@@ -92,6 +92,36 @@ int audio_init (int samplerate, float framerate)
   return (0);
 }
 
+/* Change the output rate while running, sound chips & buffered samples are kept */
+int audio_set_rate (int samplerate)
+{
+  int buffer_size = (int)(samplerate / snd.frame_rate) + 32;
+  if (buffer_size > snd.buffer_size)
+  {
+    int psg_offset = snd.psg.pos - snd.psg.buffer;
+    int fm_offset = snd.fm.pos - snd.fm.buffer;
+    int16 *psg_buffer = (int16 *) realloc(snd.psg.buffer, buffer_size * sizeof(int16));
+    if (!psg_buffer) return (-1);
+    snd.psg.buffer = psg_buffer;
+    snd.psg.pos = psg_buffer + psg_offset;
+    FMSampleType *fm_buffer = (FMSampleType*) realloc(snd.fm.buffer, buffer_size * sizeof(FMSampleType) * 2);
+    if (!fm_buffer) return (-1);
+    snd.fm.buffer = fm_buffer;
+    snd.fm.pos = fm_buffer + fm_offset;
+    snd.buffer_size = buffer_size;
+  }
+
+  snd.sample_rate = samplerate;
+  snd.cddaRatio = 44100./snd.sample_rate;
+
+	#ifndef NO_SCD
+		scd_pcm_setRate(samplerate);
+	#endif
+
+  sound_update_rate();
+  return (0);
+}
+
 void audio_reset(void)
 {
   /* Low-Pass filter */
@@ -86,6 +86,7 @@ extern uint8 system_hw;
 
 /* Function prototypes */
 extern int audio_init(int samplerate,float framerate);
+extern int audio_set_rate(int samplerate);
 extern void audio_reset(void);
 extern void audio_shutdown(void);
 extern int audio_update(int16 *sb);
@@ -21,6 +21,9 @@
 #include <audio/Audio.hh>
 #include <fs/sys.hh>
 #include <io/sys.hh>
+#ifdef CONFIG_IO_ARCHIVE
+#include <io/archive/IoArchive.hh>
+#endif
 #include <gui/View.hh>
 #include <util/strings.h>
 #include <util/time/sys.hh>
@@ -59,7 +62,11 @@ uint isROMExtension(const char *name)
 
 static bool isMDExtension(const char *name)
 {
+	#ifdef CONFIG_IO_ARCHIVE
+	return isROMExtension(name) || IoArchive::hasArchiveExtension(name);
+	#else
 	return isROMExtension(name) || string_hasDotExtension(name, "zip");
+	#endif
 }
 
 static bool isMDCDExtension(const char *name)
@@ -358,66 +365,6 @@ static void sprintBRAMSaveFilename(char (&str)[S])
 	snprintf(str, S, "%s/%s.brm", EmuSystem::savePath(), EmuSystem::gameName);
 }
 
-static const uint maxSaveStateSize = STATE_SIZE+4;
-
-static int saveMDState(const char *path)
-{
-	//static uchar stateData[maxSaveStateSize] ATTRS(aligned(4));
-	uchar *stateData = (uchar*)malloc(maxSaveStateSize);
-	if(!stateData)
-		return STATE_RESULT_IO_ERROR;
-	logMsg("saving state data");
-	int size = state_save(stateData);
-	logMsg("writing to file");
-	CallResult ret;
-	if((ret = IoSys::writeToNewFile(path, stateData, size)) != OK)
-	{
-		free(stateData);
-		logMsg("error writing state file");
-		switch(ret)
-		{
-			case PERMISSION_DENIED: return STATE_RESULT_NO_FILE_ACCESS;
-			default: return STATE_RESULT_IO_ERROR;
-		}
-	}
-	free(stateData);
-	logMsg("wrote %d byte state", size);
-	return STATE_RESULT_OK;
-}
-
-static int loadMDState(const char *path)
-{
-	CallResult ret;
-	Io *f = IoSys::open(path, 0, &ret);
-	if(!f)
-	{
-		switch(ret)
-		{
-			case PERMISSION_DENIED: return STATE_RESULT_NO_FILE_ACCESS;
-			case NOT_FOUND: return STATE_RESULT_NO_FILE;
-			default: return STATE_RESULT_IO_ERROR;
-		}
-	}
-
-	const uchar *stateData = f->mmapConst();
-	if(!stateData)
-	{
-		delete f;
-		return STATE_RESULT_IO_ERROR;
-	}
-	if(state_load(stateData) <= 0)
-	{
-		delete f;
-		logMsg("invalid state file");
-		return STATE_RESULT_INVALID_DATA;
-	}
-
-	delete f;
-
-	//sound_restore();
-	return STATE_RESULT_OK;
-}
-
 int EmuSystem::saveState()
 {
 	FsSys::cPath saveStr;
@@ -425,16 +372,37 @@ int EmuSystem::saveState()
 	#ifdef CONFIG_BASE_IOS_SETUID
 		fixFilePermissions(saveStr);
 	#endif
-	logMsg("saving state %s", saveStr);
-	return saveMDState(saveStr);
+	return saveStateFile(saveStr);
 }
 
 int EmuSystem::loadState(int saveStateSlot)
 {
 	FsSys::cPath saveStr;
 	sprintStateFilename(saveStr, saveStateSlot);
-	logMsg("loading state %s", saveStr);
-	return loadMDState(saveStr);
+	return loadStateFile(saveStr);
+}
+
+uint EmuSystem::stateBufferSize()
+{
+	return STATE_SIZE;
+}
+
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size)
+{
+	if(size < STATE_SIZE)
+		return 0;
+	return state_save_uncompressed(buff);
+}
+
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size)
+{
+	// older state files hold a zlib stream preceded by its length
+	bool compressed = size < 11 || strncmp((const char*)buff, STATE_VERSION, 11);
+	if(compressed && size <= 4)
+		return STATE_RESULT_INVALID_DATA;
+	if((compressed ? state_load(buff) : state_load_uncompressed(buff)) <= 0)
+		return STATE_RESULT_INVALID_DATA;
+	return STATE_RESULT_OK;
 }
 
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
@@ -475,19 +443,22 @@ void EmuSystem::saveBackupMem() // for manually saving when not closing game
 
 		logMsg("saving SRAM%s", optionBigEndianSram ? ", byte-swapped" : "");
 
-		uchar sramTemp[0x10000];
-		uchar *sramPtr = sram.sram;
-		if(optionBigEndianSram)
+		// snapshot for the I/O worker, which frees it after writing
+		auto sramCopy = (uchar*)mem_alloc(0x10000);
+		if(!sramCopy)
+			logMsg("out of memory for sram copy");
+		else
 		{
-			memcpy(sramTemp, sram.sram, 0x10000); // make a temp copy to byte-swap
-			for(uint i = 0; i < 0x10000; i += 2)
+			memcpy(sramCopy, sram.sram, 0x10000);
+			if(optionBigEndianSram)
 			{
-				IG::swap(sramTemp[i], sramTemp[i+1]);
+				for(uint i = 0; i < 0x10000; i += 2)
+				{
+					IG::swap(sramCopy[i], sramCopy[i+1]);
+				}
 			}
-			sramPtr = sramTemp;
+			EmuIoWorker::write(saveStr, sramCopy, 0x10000, EmuIoWorker::JOB_BACKUP_MEM);
 		}
-		if(IoSys::writeToNewFile(saveStr, sramPtr, 0x10000) == IO_ERROR)
-			logMsg("error creating sram file");
 	}
 	writeCheatFile();
 }
@@ -501,7 +472,7 @@ void EmuSystem::saveAutoState()
 		#ifdef CONFIG_BASE_IOS_SETUID
 			fixFilePermissions(saveStr);
 		#endif
-		saveMDState(saveStr);
+		saveStateFile(saveStr, 1);
 	}
 }
 
@@ -612,7 +583,7 @@ static void doAudioInit()
 		if(!vdp_pal) fps = 62;
 	}
 	#endif
-	audio_init(optionSoundRate, fps);
+	audio_init(optionSoundRate * EmuSystem::audioRateScale, fps);
 }
 
 static uint detectISORegion(uint8 bootSector[0x800])
@@ -824,6 +795,12 @@ void EmuSystem::configAudioRate()
 	logMsg("md sound buffer size %d", snd.buffer_size);
 }
 
+void EmuSystem::applyAudioRateScale()
+{
+	if(audio_set_rate(optionSoundRate * audioRateScale) != 0)
+		logErr("out of memory for md sound buffers");
+}
+
 void EmuSystem::savePathChanged() { }
 
 namespace Input
@@ -859,7 +836,10 @@ void onInputEvent(const Input::Event &e)
 namespace Base
 {
 
-void onAppMessage(int type, int shortArg, int intArg, int intArg2) { }
+void onAppMessage(int type, int shortArg, int intArg, int intArg2)
+{
+	EmuIoWorker::onAppMessage(type, shortArg, intArg, intArg2);
+}
 
 CallResult onInit(int argc, char** argv)
 {
@@ -845,6 +845,11 @@ int EmuSystem::loadState(int saveStateSlot)
 	return STATE_RESULT_NO_FILE;
 }
 
+// in-memory states not supported yet
+uint EmuSystem::stateBufferSize() { return 0; }
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size) { return 0; }
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size) { return STATE_RESULT_OTHER_ERROR; }
+
 void EmuSystem::saveBackupMem()
 {
 	if(gameIsRunning())
@@ -1025,7 +1030,13 @@ void EmuSystem::clearInputBuffers()
 void EmuSystem::configAudioRate()
 {
 	pcmFormat.rate = 44100; // TODO: not all sound chips handle non-44100Hz sample rate
-	float rate = (float)pcmFormat.rate * .999;
+	applyAudioRateScale();
+}
+
+// the mixer & chips only store the new rate
+void EmuSystem::applyAudioRateScale()
+{
+	float rate = (float)pcmFormat.rate * .999 * audioRateScale;
 	#if defined(CONFIG_ENV_WEBOS)
 	if(optionFrameSkip != optionFrameSkipAuto)
 		rate *= 42660./44100.; // better sync with Pre's refresh rate
@@ -0,0 +1,5 @@
+EMU_BENCH := 1
+O_RELEASE := 1
+-include config.mk
+include $(IMAGINE_PATH)/make/linux-x86_64-gcc.mk
+include build.mk
@@ -455,6 +455,8 @@ static void make_stateName(char *game,int slot,char *st_name_out)
 	sprintf(st_name_out,"%s%s.%03d",getGngeoDir(),game,slot);
 }
 
+static const char *stateSig = "GNGST3";
+
 static gzFile open_state(/*char *game,int slot,*/char *st_name,int mode) {
 	/*char *st_name;
 //    char *st_name_len;
@@ -477,8 +479,6 @@ static gzFile open_state(/*char *game,int slot,*/char *st_name,int mode) {
 		return NULL;
     }
 
-	static const char *stateSig = "GNGST3";
-
 	if(mode==STREAD) {
 
 		memset(string, 0, 20);
@@ -512,7 +512,27 @@ static gzFile open_state(/*char *game,int slot,*/char *st_name,int mode) {
 	return open_stateWithName(st_name, mode);
 }*/
 
+/* memory stream used by mkstate_data() when gzf is NULL, with a NULL
+ * mem_st only the size of the written data is counted */
+static Uint8 *mem_st;
+static Uint32 mem_st_size, mem_st_pos;
+static bool mem_st_overflow;
+
 int mkstate_data(gzFile gzf,void *data,int size,int mode) {
+	if (!gzf) {
+		if (mem_st && mem_st_pos + size > mem_st_size) {
+			mem_st_overflow = true;
+			return 0;
+		}
+		if (mem_st) {
+			if (mode==STREAD)
+				memcpy(data, mem_st + mem_st_pos, size);
+			else
+				memcpy(mem_st + mem_st_pos, data, size);
+		}
+		mem_st_pos += size;
+		return size;
+	}
 	if (mode==STREAD)
 		return gzread(gzf,data,size);
 	return gzwrite(gzf,data,size);
@@ -580,8 +600,7 @@ int save_state(char *game,int slot) {
 	return save_stateWithName(st_name);
 }
 
-int load_stateWithName(char *name) {
-	gzFile gzf;
+static void neogeo_load_mkstate(gzFile gzf) {
 	/* Save pointers */
 	Uint8 *ng_lo = memory.ng_lo;
 	Uint8 *fix_game_usage=memory.fix_game_usage;
@@ -589,9 +608,6 @@ int load_stateWithName(char *name) {
 	int *bksw_offset=memory.bksw_offset;
 //	GAME_ROMS r;
 //	memcpy(&r,&memory.rom,sizeof(GAME_ROMS));
-	
-	if ((gzf = open_state(name, STREAD))==NULL)
-		return false;
 
 	//gzread(gzf,state_img_tmp->pixels,304*224*2);
 
@@ -626,11 +642,53 @@ int load_stateWithName(char *name) {
 		current_fix = memory.rom.bios_sfix.p;
 		fix_usage = memory.fix_board_usage;
 	}
+}
+
+int load_stateWithName(char *name) {
+	gzFile gzf;
+
+	if ((gzf = open_state(name, STREAD))==NULL)
+		return false;
+
+	neogeo_load_mkstate(gzf);
 
 	gzclose(gzf);
 	return true;
 }
 
+Uint32 save_stateToMem(Uint8 *buf,Uint32 size) {
+	int flags=m68k_flag | z80_flag | endian_flag;
+	mem_st = buf;
+	mem_st_size = size;
+	mem_st_pos = 0;
+	mem_st_overflow = false;
+	mkstate_data(NULL, (void*)stateSig, 6, STWRITE);
+	mkstate_data(NULL, &flags, sizeof(int), STWRITE);
+	neogeo_mkstate(NULL,STWRITE);
+	mem_st = NULL;
+	return mem_st_overflow ? 0 : mem_st_pos;
+}
+
+int load_stateFromMem(const Uint8 *buf,Uint32 size) {
+	if (size < 6 + sizeof(int) || memcmp(buf, stateSig, 6)) {
+		logMsg("not a valid gngeo state");
+		return false;
+	}
+	int flags;
+	memcpy(&flags, buf + 6, sizeof(int));
+	if (flags != (m68k_flag | z80_flag | endian_flag)) {
+		logMsg("state comes from a different endian architecture");
+		return false;
+	}
+	mem_st = (Uint8*)buf;
+	mem_st_size = size;
+	mem_st_pos = 6 + sizeof(int);
+	mem_st_overflow = false;
+	neogeo_load_mkstate(NULL);
+	mem_st = NULL;
+	return !mem_st_overflow;
+}
+
 int load_state(char *game,int slot) {
 	char *st_name=(char*)alloca(strlen(getGngeoDir())+strlen(game)+5);
 	make_stateName(game,slot,st_name);
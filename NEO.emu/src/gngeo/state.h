@@ -97,6 +97,10 @@ int load_state(char *game,int slot);
 int save_state(char *game,int slot);
 int save_stateWithName(char *name);
 int load_stateWithName(char *name);
+/* in-memory states in the same format as the files, a NULL buf makes
+ * save_stateToMem return the size needed */
+Uint32 save_stateToMem(Uint8 *buf,Uint32 size);
+int load_stateFromMem(const Uint8 *buf,Uint32 size);
 Uint32 how_many_slot(char *game);
 int mkstate_data(gzFile gzf,void *data,int size,int mode);
 
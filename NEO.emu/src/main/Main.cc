@@ -361,25 +361,31 @@ int EmuSystem::saveState()
 	#ifdef CONFIG_BASE_IOS_SETUID
 		fixFilePermissions(saveStr);
 	#endif
-	if(!save_stateWithName(saveStr))
-		return STATE_RESULT_IO_ERROR;
-	else
-		return STATE_RESULT_OK;
+	return saveStateFile(saveStr);
 }
 
 int EmuSystem::loadState(int saveStateSlot)
 {
 	FsSys::cPath saveStr;
 	sprintStateFilename(saveStr, saveStateSlot);
-	if(FsSys::fileExists(saveStr))
-	{
-		logMsg("loading state %s", saveStr);
-		if(load_stateWithName(saveStr))
-			return STATE_RESULT_OK;
-		else
-			return STATE_RESULT_IO_ERROR;
-	}
-	return STATE_RESULT_NO_FILE;
+	return loadStateFile(saveStr);
+}
+
+uint EmuSystem::stateBufferSize()
+{
+	return save_stateToMem(nullptr, 0);
+}
+
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size)
+{
+	return save_stateToMem(buff, size);
+}
+
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size)
+{
+	if(!load_stateFromMem(buff, size))
+		return STATE_RESULT_INVALID_DATA;
+	return STATE_RESULT_OK;
 }
 
 void EmuSystem::saveBackupMem()
@@ -400,8 +406,7 @@ void EmuSystem::saveAutoState()
 		#ifdef CONFIG_BASE_IOS_SETUID
 			fixFilePermissions(saveStr);
 		#endif
-		if(!save_stateWithName(saveStr))
-			logMsg("error saving state %s", saveStr);
+		saveStateFile(saveStr, 1);
 	}
 }
 
@@ -653,7 +658,13 @@ static uint audioFramesPerUpdate;
 void EmuSystem::configAudioRate()
 {
 	pcmFormat.rate = optionSoundRate;
-	conf.sample_rate = optionSoundRate;
+	applyAudioRateScale();
+}
+
+// YM2610ChangeSamplerate() only recalculates the chip's steps
+void EmuSystem::applyAudioRateScale()
+{
+	conf.sample_rate = optionSoundRate * audioRateScale;
 	#ifdef CONFIG_ENV_WEBOS
 	if(optionFrameSkip != optionFrameSkipAuto)
 		conf.sample_rate *= 42660./44100.; // better sync with Pre's refresh rate
@@ -712,6 +723,8 @@ namespace Base
 
 void onAppMessage(int type, int shortArg, int intArg, int intArg2)
 {
+	if(EmuIoWorker::onAppMessage(type, shortArg, intArg, intArg2))
+		return;
 	switch(type)
 	{
 		bcase MSG_LOAD_FAILED:
@@ -146,6 +146,7 @@ void FCEUI_SetPaletteArray(uint8 *pal);
 //per second.  Only sample rates of 44100, 48000, and 96000 are currently supported.
 //If "Rate" equals 0, sound is disabled.
 void FCEUI_Sound(int Rate);
+void FCEUI_SetSoundRate(int Rate);
 void FCEUI_SetSoundVolume(uint32 volume);
 void FCEUI_SetTriangleVolume(uint32 volume);
 void FCEUI_SetSquare1Volume(uint32 volume);
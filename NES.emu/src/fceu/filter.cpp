@@ -168,6 +168,12 @@ int32 NeoFilterSound(FCEU_SoundSample2 *in, FCEU_SoundSample2 *out, uint32 inlen
 	return(count);
 }
 
+//Only changes the resampling ratio, the coefficients and position are kept
+void SetFilterRate(int32 rate)
+{
+ mrratio=(PAL?(int64)(PAL_CPU*65536):(int64)(NTSC_CPU*65536))/rate;
+}
+
 void MakeFilters(int32 rate)
 {
  const int32 *tabs[6]={C44100NTSC,C44100PAL,C48000NTSC,C48000PAL,C96000NTSC,
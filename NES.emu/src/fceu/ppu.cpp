@@ -39,6 +39,7 @@
 #include  "video.h"
 #include  "input.h"
 #include "driver.h"
+#include <pixmap/PixmapConv.hh>
 
 
 #define VBlankON  (PPU[0]&0x80)   //Generate VBlank NMI
@@ -1430,26 +1431,11 @@ static void DoLine(void)
 		assert(y*nesPixX < nesPixX*nesVisiblePixY);
 		NATIVE_PIX_TYPE *outLine = &nativePixBuff[(y*nesPixX)];
 		if((PPU[1]>>5)==0x7)
-		{
-			//for(x=63;x>=0;x--)
-			for(x=0;x<=255;x++)
-			{
-				//*(uint32 *)&target[x<<2]=((*(uint32*)&target[x<<2])&0x3f3f3f3f)|0xc0c0c0c0;
-				outLine[x] = nativeCol[(target[x]&0x3f)|0xc0];
-			}
-		}
+			PixmapConv::lookup(outLine, target, 256, nativeCol, 0x3f, 0xc0);
 		else if(PPU[1]&0xE0)
-			for(x=0;x<=255;x++)
-			{
-				//*(uint32 *)&target[x<<2]=(*(uint32*)&target[x<<2])|0x40404040;
-				outLine[x] = nativeCol[(target[x])|0x40];
-			}
+			PixmapConv::lookup(outLine, target, 256, nativeCol, 0xff, 0x40);
 		else
-			for(x=0;x<=255;x++)
-			{
-				//*(uint32 *)&target[x<<2]=((*(uint32*)&target[x<<2])&0x3f3f3f3f)|0x80808080;
-				outLine[x] = nativeCol[(target[x]&0x3f)|0x80];
-			}
+			PixmapConv::lookup(outLine, target, 256, nativeCol, 0x3f, 0x80);
 	}
 
 	sphitx=0x100;
@@ -1284,6 +1284,21 @@ void FCEUI_Sound(int Rate)
 	SetSoundVariables();
 }
 
+//Changes the output rate without resetting the channels, for the small
+//adjustments made while a game runs
+void FCEUI_SetSoundRate(int Rate)
+{
+	if(!FSettings.SndRate || !Rate)
+	{
+		FCEUI_Sound(Rate);
+		return;
+	}
+	FSettings.SndRate=Rate;
+	SetFilterRate(Rate);
+	nesincsize=(int64)(((int64)1<<17)*(SysDDec)(PAL?PAL_CPU:NTSC_CPU)/(FSettings.SndRate * 16));
+	soundtsinc=(uint32)((uint64)(PAL?(SysLDDec)PAL_CPU*65536:(SysLDDec)NTSC_CPU*65536)/(FSettings.SndRate * 16));
+}
+
 void FCEUI_SetLowPass(int q)
 {
 	FSettings.lowpass=q;
@@ -35,6 +35,8 @@ static uint fceuCheats = 0;
 #include <fceu/ppu.h>
 #include <fceu/fds.h>
 #include <fceu/input.h>
+#include <fceu/emufile.h>
+#include <zlib.h>
 
 static bool isFDSBIOSExtension(const char *name)
 {
@@ -236,30 +238,44 @@ void EmuSystem::sprintStateFilename(char *str, size_t size, int slot, const char
 int EmuSystem::saveState()
 {
 	FsSys::cPath saveStr;
+	sprintStateFilename(saveStr, saveStateSlot);
 	#ifdef CONFIG_BASE_IOS_SETUID
 		fixFilePermissions(saveStr);
 	#endif
-	sprintStateFilename(saveStr, saveStateSlot);
-	if(!FCEUI_SaveState(saveStr))
-		return STATE_RESULT_IO_ERROR;
-	else
-		return STATE_RESULT_OK;
+	return saveStateFile(saveStr);
 }
 
 int EmuSystem::loadState(int saveStateSlot)
 {
 	FsSys::cPath saveStr;
 	sprintStateFilename(saveStr, saveStateSlot);
-	if(FsSys::fileExists(saveStr))
-	{
-		logMsg("loading state %s", saveStr);
-		if(!FCEUI_LoadState(saveStr))
-			return STATE_RESULT_IO_ERROR;
-		else
-			return STATE_RESULT_OK;
-	}
-	else
-		return STATE_RESULT_NO_FILE;
+	// FCEUSS_LoadFP() also reads the compressed files older versions wrote
+	return loadStateFile(saveStr);
+}
+
+uint EmuSystem::stateBufferSize()
+{
+	EMUFILE_MEMORY ms;
+	if(!FCEUSS_SaveMS(&ms, Z_NO_COMPRESSION))
+		return 0;
+	return ms.size();
+}
+
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size)
+{
+	EMUFILE_MEMORY ms;
+	if(!FCEUSS_SaveMS(&ms, Z_NO_COMPRESSION) || (uint)ms.size() > size)
+		return 0;
+	memcpy(buff, ms.buf(), ms.size());
+	return ms.size();
+}
+
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size)
+{
+	EMUFILE_MEMORY ms((void*)buff, size);
+	if(!FCEUSS_LoadFP(&ms, SSLOADPARAM_NOBACKUP))
+		return STATE_RESULT_INVALID_DATA;
+	return STATE_RESULT_OK;
 }
 
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
@@ -284,7 +300,7 @@ void EmuSystem::saveAutoState()
 		#ifdef CONFIG_BASE_IOS_SETUID
 			fixFilePermissions(saveStr);
 		#endif
-		FCEUI_SaveState(saveStr);
+		saveStateFile(saveStr, 1);
 	}
 }
 
@@ -439,19 +455,28 @@ void EmuSystem::clearInputBuffers()
 	mem_zero(padData);
 }
 
-void EmuSystem::configAudioRate()
+static float soundRate()
 {
-	pcmFormat.rate = optionSoundRate;
-	bool usingTimer = (uint)optionFrameSkip == optionFrameSkipAuto || PAL;
-	float rate = (float)optionSoundRate * (PAL ? 1. : 1.0016);
+	float rate = (float)optionSoundRate * (PAL ? 1. : 1.0016) * EmuSystem::audioRateScale;
 	#if defined(CONFIG_ENV_WEBOS)
-	if(optionFrameSkip != optionFrameSkipAuto)
+	if(optionFrameSkip != EmuSystem::optionFrameSkipAuto)
 		rate *= 42660./44100.; // better sync with Pre's refresh rate
 	#endif
-	FCEUI_Sound(rate);
+	return rate;
+}
+
+void EmuSystem::configAudioRate()
+{
+	pcmFormat.rate = optionSoundRate;
+	FCEUI_Sound(soundRate());
 	logMsg("set NES audio rate %d", FSettings.SndRate);
 }
 
+void EmuSystem::applyAudioRateScale()
+{
+	FCEUI_SetSoundRate(soundRate());
+}
+
 
 #if 0
 void FCEUD_RenderPPULine(uint8 *line, uint y)
@@ -567,7 +592,10 @@ void EmuSystem::savePathChanged()
 namespace Base
 {
 
-void onAppMessage(int type, int shortArg, int intArg, int intArg2) { }
+void onAppMessage(int type, int shortArg, int intArg, int intArg2)
+{
+	EmuIoWorker::onAppMessage(type, shortArg, intArg, intArg2);
+}
 
 CallResult onInit(int argc, char** argv)
 {
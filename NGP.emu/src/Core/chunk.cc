@@ -20,6 +20,8 @@
 #define SIZE_ROMH	64
 #define SIZE_TIME	4
 
+static size_t chunk_read(void *, size_t, FILE *);
+static size_t chunk_write(const void *, size_t, FILE *);
 static uint8 read1(const uint8 *);
 static uint16 read2(const uint8 *);
 static uint32 read4(const uint8 *);
@@ -40,11 +42,58 @@ static bool write_ROMH(FILE *);
 static bool write_TIME(FILE *);
 
 
+static uint8 *mem_st;
+static uint32 mem_st_size, mem_st_pos;
+static bool mem_st_overflow;
+
+void chunk_mem_open(uint8 *buf, uint32 size)
+{
+	mem_st = buf;
+	mem_st_size = size;
+	mem_st_pos = 0;
+	mem_st_overflow = FALSE;
+}
+
+/* returns the bytes used or 0 if the buffer was too small */
+uint32 chunk_mem_close(void)
+{
+	mem_st = NULL;
+	return mem_st_overflow ? 0 : mem_st_pos;
+}
+
+static size_t chunk_read(void *data, size_t size, FILE *fp)
+{
+	if (fp)
+		return fread(data, 1, size, fp);
+	if (mem_st_pos + size > mem_st_size) {
+		mem_st_overflow = TRUE;
+		return 0;
+	}
+	memcpy(data, mem_st+mem_st_pos, size);
+	mem_st_pos += size;
+	return size;
+}
+
+static size_t chunk_write(const void *data, size_t size, FILE *fp)
+{
+	if (fp)
+		return fwrite(data, 1, size, fp);
+	if (mem_st) {
+		if (mem_st_pos + size > mem_st_size) {
+			mem_st_overflow = TRUE;
+			return 0;
+		}
+		memcpy(mem_st+mem_st_pos, data, size);
+	}
+	mem_st_pos += size;
+	return size;
+}
+
 bool read_chunk(FILE *fp, uint32 *tagp, uint32 *sizep)
 {
 	uint8 buf[SIZE_CHUNK];
 	
-	if (fread(buf, 1, SIZE_CHUNK, fp) != SIZE_CHUNK)
+	if (chunk_read(buf, SIZE_CHUNK, fp) != SIZE_CHUNK)
 		return FALSE;
 	
 	*tagp = read4(buf);
@@ -57,7 +106,7 @@ bool read_header(FILE *fp)
 {
 	uint8 buf[HEADER_SIZE];
 
-	if (fread(buf, 1, HEADER_SIZE, fp) != HEADER_SIZE)
+	if (chunk_read(buf, HEADER_SIZE, fp) != HEADER_SIZE)
 		return FALSE;
 
 	if (memcmp(buf, HEADER, HEADER_SIZE) != 0)
@@ -180,7 +229,7 @@ bool read_SNAP(FILE *fp, uint32 size)
 
 bool write_header(FILE *fp)
 {
-	if (fwrite(HEADER, 1, HEADER_SIZE, fp) != HEADER_SIZE)
+	if (chunk_write(HEADER, HEADER_SIZE, fp) != HEADER_SIZE)
 		return FALSE;
 
 	return TRUE;
@@ -258,7 +307,7 @@ static uint8 *read_chunk_data(FILE *fp, uint32 size)
 	if ((data=(uint8*)malloc(size)) == NULL)
 		return NULL;
 
-	if (fread(data, 1, size, fp) != size) {
+	if (chunk_read(data, size, fp) != size) {
 		free(data);
 		return NULL;
 	}
@@ -374,10 +423,10 @@ static bool write_chunk(FILE *fp, uint32 name, const uint8 *data, uint32 size)
 	write4(p, name), p+=4;
 	write4(p, size);
 
-	ret = fwrite(buf, 1, SIZE_CHUNK, fp) == SIZE_CHUNK;
+	ret = chunk_write(buf, SIZE_CHUNK, fp) == SIZE_CHUNK;
 
 	if (data && size > 0)
-	    ret &= fwrite(data, 1, size, fp) == size;
+	    ret &= chunk_write(data, size, fp) == size;
 
 	return ret;
 }
@@ -26,6 +26,11 @@ bool read_chunk(FILE *, uint32 *, uint32 *);
 bool read_header(FILE *);
 bool read_SNAP(FILE *, uint32);
 
+/* a NULL FILE reads & writes the buffer given to chunk_mem_open() instead,
+ * with a NULL buffer writes are only counted */
+void chunk_mem_open(uint8 *, uint32);
+uint32 chunk_mem_close(void);
+
 bool write_header(FILE *);
 bool write_EOD(FILE *);
 bool write_SNAP(FILE *, int);
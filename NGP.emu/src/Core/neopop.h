@@ -330,6 +330,10 @@ RomHeader;
 	
 	void sound_init(int SampleRate);
 
+/*! Changes the SampleRate without resetting the sound chips */
+
+	void sound_set_rate(int SampleRate);
+
 		//=========================================
 
 /*! Callback for "sound_init" with the system sound frequency */
@@ -347,6 +351,10 @@ RomHeader;
 
 	bool state_restore(const char* filename);
 	bool state_store(const char* filename);
+	// in-memory states in the file format, a NULL buffer makes
+	// state_store_mem() return the size needed
+	uint32 state_store_mem(uint8* buffer, uint32 size);
+	bool state_restore_mem(const uint8* buffer, uint32 size);
 
 		//=========================================
 
@@ -376,6 +384,11 @@ RomHeader;
 	bool system_io_rom_read(char* filename, uint8* buffer, uint32 bufferLength);
 
 
+/*! Releases rom.data, which is allocated by the system code. */
+
+	void system_io_rom_free(void);
+
+
 /*! Reads the "appropriate" (system specific) flash data into the given
 	preallocated buffer. The emulation core doesn't care where from. */
 
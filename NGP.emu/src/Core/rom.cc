@@ -280,7 +280,7 @@ void rom_unload(void)
 
 		flash_commit();
 
-		free(rom.data);
+		system_io_rom_free();
 		rom.data = NULL;
 		rom.length = 0;
 		rom_header = 0;
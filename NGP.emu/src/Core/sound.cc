@@ -502,4 +502,23 @@ void sound_init(int SampleRate)
 	dacBufferWrite = 0;
 }
 
+//Changes the sample rate without resetting the sound chips
+void sound_set_rate(int SampleRate)
+{
+	int i;
+	uint32 oldStep = UpdateStep;
+	UpdateStep = (uint32)(((SysDDec)STEP * SampleRate * 16) / SOUNDCHIPCLOCK);
+	if (!oldStep || UpdateStep == oldStep)
+		return;
+
+	//Periods and counts are in steps, so rescale them to the new step size
+	for (i = 0;i < 4;i++)
+	{
+		toneChip.Period[i] = (int)((SysDDec)toneChip.Period[i] * UpdateStep / oldStep);
+		toneChip.Count[i] = (int)((SysDDec)toneChip.Count[i] * UpdateStep / oldStep);
+		noiseChip.Period[i] = (int)((SysDDec)noiseChip.Period[i] * UpdateStep / oldStep);
+		noiseChip.Count[i] = (int)((SysDDec)noiseChip.Count[i] * UpdateStep / oldStep);
+	}
+}
+
 //=============================================================================
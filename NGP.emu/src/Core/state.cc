@@ -54,6 +54,7 @@
 
 static bool read_state_0050(const char* filename);
 static bool read_state_0060(const char* filename);
+static void apply_state_0050(const NEOPOPSTATE0050 &state);
 
 //-----------------------------------------------------------------------------
 // state_restore()
@@ -115,12 +116,50 @@ bool state_store(const char* filename)
 	return ret;
 }
 
+uint32 state_store_mem(uint8* buffer, uint32 size)
+{
+	chunk_mem_open(buffer, size);
+	bool ret = write_header(NULL);
+	ret &= write_SNAP(NULL, OPT_ROMH);
+	ret &= write_EOD(NULL);
+	uint32 written = chunk_mem_close();
+	return ret ? written : 0;
+}
+
+bool state_restore_mem(const uint8* buffer, uint32 size)
+{
+	uint16 version;
+	if (size < sizeof(uint16))
+		return FALSE;
+	memcpy(&version, buffer, sizeof(uint16));
+	if (version == 0x0050)
+	{
+		NEOPOPSTATE0050	state;
+		if (size < sizeof(NEOPOPSTATE0050))
+			return FALSE;
+		memcpy(&state, buffer, sizeof(NEOPOPSTATE0050));
+		if (memcmp(rom_header, &state.header, sizeof(RomHeader)) != 0)
+		{
+			system_message(system_get_string(IDS_WRONGROM));
+			return FALSE;
+		}
+		apply_state_0050(state);
+		return TRUE;
+	}
+
+	uint32 tag, snapSize;
+	chunk_mem_open((uint8*)buffer, size);
+	bool ret = read_header(NULL) && read_chunk(NULL, &tag, &snapSize)
+		&& tag == TAG_SNAP && read_SNAP(NULL, snapSize);
+	chunk_mem_close();
+	return ret;
+}
+
 //=============================================================================
 
 static bool read_state_0050(const char* filename)
 {
 	NEOPOPSTATE0050	state;
-	int i,j;
 
 	if (system_io_state_read(filename, (uint8*)&state, sizeof(NEOPOPSTATE0050)))
 	{
@@ -131,59 +170,66 @@ static bool read_state_0050(const char* filename)
 			return FALSE;
 		}
 
-		//Apply state description
-		reset();
+		apply_state_0050(state);
+		return TRUE;
+	}
 
-		eepromStatusEnable = state.eepromStatusEnable;
+	return FALSE;
+}
 
-		//TLCS-900h Registers
-		pc = state.pc;
-		sr = state.sr;				changedSP();
-		f_dash = state.f_dash;
+static void apply_state_0050(const NEOPOPSTATE0050 &state)
+{
+	int i,j;
 
-		eepromStatusEnable = state.eepromStatusEnable;
+	//Apply state description
+	reset();
 
-		for (i = 0; i < 4; i++)
-		{
-			gpr[i] = state.gpr[i];
-			for (j = 0; j < 4; j++)
-				gprBank[i][j] = state.gprBank[i][j];
-		}
+	eepromStatusEnable = state.eepromStatusEnable;
 
-		//Timers
-		timer_hint = state.timer_hint;
+	//TLCS-900h Registers
+	pc = state.pc;
+	sr = state.sr;				changedSP();
+	f_dash = state.f_dash;
 
-		for (i = 0; i < 4; i++)	//Up-counters
-			timer[i] = state.timer[i];
+	eepromStatusEnable = state.eepromStatusEnable;
 
-		timer_clock0 = state.timer_clock0;
-		timer_clock1 = state.timer_clock1;
-		timer_clock2 = state.timer_clock2;
-		timer_clock3 = state.timer_clock3;
+	for (i = 0; i < 4; i++)
+	{
+		gpr[i] = state.gpr[i];
+		for (j = 0; j < 4; j++)
+			gprBank[i][j] = state.gprBank[i][j];
+	}
 
-		//Z80 Registers
-		memcpy(&Z80_regs, &state.Z80_regs, sizeof(Z80));
+	//Timers
+	timer_hint = state.timer_hint;
 
-		//Sound Chips
-		memcpy(&toneChip, &state.toneChip, sizeof(SoundChip));
-		memcpy(&noiseChip, &state.noiseChip, sizeof(SoundChip));
+	for (i = 0; i < 4; i++)	//Up-counters
+		timer[i] = state.timer[i];
 
-		//DMA
-		for (i = 0; i < 4; i++)
-		{
-			dmaS[i] = state.dmaS[i];
-			dmaD[i] = state.dmaD[i];
-			dmaC[i] = state.dmaC[i];
-			dmaM[i] = state.dmaM[i];
-		}
+	timer_clock0 = state.timer_clock0;
+	timer_clock1 = state.timer_clock1;
+	timer_clock2 = state.timer_clock2;
+	timer_clock3 = state.timer_clock3;
 
-		//Memory
-		memcpy(ram, &state.ram, 0xC000);
-		system_sound_chipreset(); // reset sound chip again or sample_chip_noise() can hang
-		return TRUE;
+	//Z80 Registers
+	memcpy(&Z80_regs, &state.Z80_regs, sizeof(Z80));
+
+	//Sound Chips
+	memcpy(&toneChip, &state.toneChip, sizeof(SoundChip));
+	memcpy(&noiseChip, &state.noiseChip, sizeof(SoundChip));
+
+	//DMA
+	for (i = 0; i < 4; i++)
+	{
+		dmaS[i] = state.dmaS[i];
+		dmaD[i] = state.dmaD[i];
+		dmaC[i] = state.dmaC[i];
+		dmaM[i] = state.dmaM[i];
 	}
 
-	return FALSE;
+	//Memory
+	memcpy(ram, &state.ram, 0xC000);
+	system_sound_chipreset(); // reset sound chip again or sample_chip_noise() can hang
 }
 
 static bool read_state_0060(const char* filename)
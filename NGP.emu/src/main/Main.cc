@@ -12,7 +12,10 @@
 #include <gui/View.hh>
 #include <util/strings.h>
 #include <util/time/sys.hh>
+#include <RomImage.hh>
+#ifndef CONFIG_IO_ARCHIVE
 #include <unzip.h>
+#endif
 #include <EmuSystem.hh>
 #include <CommonFrameworkIncludes.hh>
 
@@ -76,7 +79,11 @@ static bool isROMExtension(const char *name)
 
 static bool isNGPExtension(const char *name)
 {
+	#ifdef CONFIG_IO_ARCHIVE
+	return isROMExtension(name) || IoArchive::hasArchiveExtension(name);
+	#else
 	return isROMExtension(name) || string_hasDotExtension(name, "zip");
+	#endif
 }
 
 static int ngpFsFilter(const char *name, int type)
@@ -173,28 +180,31 @@ int EmuSystem::saveState()
 	#ifdef CONFIG_BASE_IOS_SETUID
 		fixFilePermissions(saveStr);
 	#endif
-	if(!state_store(saveStr))
-		return STATE_RESULT_IO_ERROR;
-	else
-		return STATE_RESULT_OK;
+	return saveStateFile(saveStr);
 }
 
 int EmuSystem::loadState(int saveStateSlot)
 {
 	FsSys::cPath saveStr;
 	sprintStateFilename(saveStr, saveStateSlot);
-	if(FsSys::fileExists(saveStr))
-	{
-		logMsg("loading state %s", saveStr);
-		if(!state_restore(saveStr))
-			return STATE_RESULT_IO_ERROR;
-		else
-		{
-			//EmuSystem::configAudioRate();
-			return STATE_RESULT_OK;
-		}
-	}
-	return STATE_RESULT_NO_FILE;
+	return loadStateFile(saveStr);
+}
+
+uint EmuSystem::stateBufferSize()
+{
+	return state_store_mem(nullptr, 0);
+}
+
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size)
+{
+	return state_store_mem(buff, size);
+}
+
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size)
+{
+	if(!state_restore_mem(buff, size))
+		return STATE_RESULT_INVALID_DATA;
+	return STATE_RESULT_OK;
 }
 
 bool system_io_state_read(const char* filename, uchar* buffer, uint32 bufferLength)
@@ -222,11 +232,11 @@ bool system_io_flash_write(uchar* buffer, uint32 len)
 	FsSys::cPath saveStr;
 	sprintSaveFilename(saveStr);
 	logMsg("writing flash %s", saveStr);
-	CallResult ret;
-	if((ret = IoSys::writeToNewFile(saveStr, buffer, len)) == OK)
-		return 1;
-	else
+	auto flashData = (uchar*)mem_alloc(len);
+	if(!flashData)
 		return 0;
+	memcpy(flashData, buffer, len);
+	return EmuIoWorker::write(saveStr, flashData, len, EmuIoWorker::JOB_BACKUP_MEM);
 }
 
 void EmuSystem::saveBackupMem()
@@ -245,7 +255,7 @@ void EmuSystem::saveAutoState()
 		#ifdef CONFIG_BASE_IOS_SETUID
 			fixFilePermissions(saveStr);
 		#endif
-		state_store(saveStr);
+		saveStateFile(saveStr, 1);
 	}
 }
 
@@ -258,75 +268,81 @@ void EmuSystem::closeSystem()
 bool EmuSystem::vidSysIsPAL() { return 0; }
 bool touchControlsApplicable() { return 1; }
 
-#define HAVE_LIBZ
-static bool romLoad(const char *filename)
+static RomImage romImage;
+
+void system_io_rom_free()
+{
+	romImage.close();
+}
+
+#ifndef CONFIG_IO_ARCHIVE
+static bool zipRomLoad(const char *filename, uint minSize)
 {
-#ifdef HAVE_LIBZ
 	unzFile z;
-	if ((z=unzOpen(filename)) != 0)
+	if ((z=unzOpen(filename)) == 0)
+		return 0;
+	for (int err=unzGoToFirstFile(z); err==0; err=unzGoToNextFile(z))
 	{
-		for (int err=unzGoToFirstFile(z); err==0; err=unzGoToNextFile(z))
+		char name[1024];
+		unz_file_info zfi;
+		if (unzGetCurrentFileInfo(z, &zfi, name, sizeof(name), NULL, 0, NULL, 0) != UNZ_OK)
+			continue;
+		if (zfi.size_filename > sizeof(name))
+			continue;
+		if (isROMExtension(name))
 		{
-			char name[1024];
-			unz_file_info zfi;
-			if (unzGetCurrentFileInfo(z, &zfi, name, sizeof(name), NULL, 0, NULL, 0) != UNZ_OK)
-				continue;
-			if (zfi.size_filename > sizeof(name))
-				continue;
-			int l = strlen(name);
-			if (l < 4)
-				continue;
-			if (strcasecmp(name+l-4, ".ngp") == 0 || strcasecmp(name+l-4, ".ngc") == 0
-					|| strcasecmp(name+l-4, ".npc") == 0)
+			uchar *data = romImage.allocate(zfi.uncompressed_size, minSize);
+			if (!data || (unzOpenCurrentFile(z) != UNZ_OK)
+			|| (unzReadCurrentFile(z, data, zfi.uncompressed_size)
+			!= (int)zfi.uncompressed_size))
 			{
-				rom.length = zfi.uncompressed_size;
-				rom.data = (uchar*)calloc(rom.length, 1);
-
-				if ((unzOpenCurrentFile(z) != UNZ_OK)
-				|| (unzReadCurrentFile(z, rom.data, rom.length)
-				!= (int)rom.length))
-				{
-					free(rom.data);
-					rom.data = NULL;
-					logMsg("error in unzOpenCurrentFile: %s", filename);
-					unzCloseCurrentFile(z);
-					unzClose(z);
-					return 0;
-				}
-				if (unzCloseCurrentFile(z) != UNZ_OK)
-				{
-					free(rom.data);
-					rom.data = NULL;
-					logMsg("error in unzCloseCurrentFile: %s", filename);
-					unzClose(z);
-					return 0;
-				}
+				romImage.close();
+				logMsg("error in unzOpenCurrentFile: %s", filename);
+				unzCloseCurrentFile(z);
 				unzClose(z);
-				logMsg("read 0x%X byte rom", rom.length);
-				return 1;
+				return 0;
 			}
+			unzCloseCurrentFile(z);
+			unzClose(z);
+			return 1;
 		}
-		unzClose(z);
-		logMsg("`%s': no rom found", filename);
-		return 0;
 	}
+	unzClose(z);
+	logMsg("`%s': no rom found", filename);
+	return 0;
+}
 #endif
 
-	const uint maxRomSize = 0x400000;
-	rom.data = (uchar*)calloc(maxRomSize, 1);
+static bool romOpen(const char *filename, uint minSize)
+{
+	#ifndef CONFIG_IO_ARCHIVE
+	if(string_hasDotExtension(filename, "zip"))
+		return zipRomLoad(filename, minSize);
+	#endif
+	return romImage.open(filename, IoArchive::EntryFilter::create<&isROMExtension>(), "ngp",
+		RomImage::FLAG_WRITABLE, minSize);
+}
 
-	uint readSize = IoSys::readFromFile(filename, rom.data, maxRomSize);
-	if(readSize)
+static bool romLoad(const char *filename)
+{
+	// the core patches the header & writes flash data into the rom,
+	// and memory accesses assume at least 4MB are mapped
+	const uint maxRomSize = 0x400000;
+	if(!romOpen(filename, maxRomSize))
+	{
+		logMsg("%s `%s'", "error opening rom", filename);
+		return 0;
+	}
+	if(!romImage.size())
 	{
-    	logMsg("read 0x%X byte rom", readSize);
-    	rom.length = readSize;
-    	return 1;
+		logMsg("%s `%s'", "error reading rom", filename);
+		romImage.close();
+		return 0;
 	}
-
-	logMsg("%s `%s'", "error reading rom", filename);
-	free(rom.data);
-	rom.data = NULL;
-	return 0;
+	rom.data = romImage.writableData();
+	rom.length = romImage.size();
+	logMsg("loaded 0x%X byte rom", rom.length);
+	return 1;
 }
 
 #include "TLCS900h_interpret.h"
@@ -363,19 +379,32 @@ void EmuSystem::clearInputBuffers()
 
 static uint audioFramesPerUpdate;
 
-void EmuSystem::configAudioRate()
+static float soundRate()
 {
-	pcmFormat.rate = optionSoundRate;
-	//logMsg("set audio rate %d", Audio::pPCM.rate);
-	float rate = optionSoundRate;
+	float rate = optionSoundRate * EmuSystem::audioRateScale;
 	#ifdef CONFIG_ENV_WEBOS
-	if(optionFrameSkip != optionFrameSkipAuto)
+	if(optionFrameSkip != EmuSystem::optionFrameSkipAuto)
 		rate *= 42660./44100.; // better sync with Pre's refresh rate
 	#endif
+	return rate;
+}
+
+void EmuSystem::configAudioRate()
+{
+	pcmFormat.rate = optionSoundRate;
+	//logMsg("set audio rate %d", Audio::pPCM.rate);
+	float rate = soundRate();
 	sound_init(rate);
 	audioFramesPerUpdate = rate/60.;
 }
 
+void EmuSystem::applyAudioRateScale()
+{
+	float rate = soundRate();
+	sound_set_rate(rate);
+	audioFramesPerUpdate = rate/60.;
+}
+
 void system_sound_chipreset(void)
 {
 	EmuSystem::configAudioRate();
@@ -502,7 +531,10 @@ void EmuSystem::savePathChanged() { }
 namespace Base
 {
 
-void onAppMessage(int type, int shortArg, int intArg, int intArg2) { }
+void onAppMessage(int type, int shortArg, int intArg, int intArg2)
+{
+	EmuIoWorker::onAppMessage(type, shortArg, intArg, intArg2);
+}
 
 CallResult onInit(int argc, char** argv)
 {
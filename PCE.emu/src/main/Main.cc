@@ -36,6 +36,7 @@ namespace PCE_Fast
 	void HuCDumpSave(void);
 	void applyVideoFormat(EmulateSpecStruct *espec);
 	void applySoundFormat(EmulateSpecStruct *espec);
+	void adjustSoundRate(EmulateSpecStruct *espec);
 	extern bool AVPad6Enabled[5];
 	extern vce_t vce;
 }
@@ -168,16 +169,27 @@ static void initVideoFormat()
 
 static uint16 inputBuff[5] = { 0 }; // 5 gamepad buffers
 
+// state files keep the MDFNSVST header & version so they still load after
+// the core changes, rewind & run-ahead buffers use the smaller data-only form
+static bool saveFullState = 0;
+
+static int saveFullStateFile(const char *path, bool async = 0)
+{
+	saveFullState = 1;
+	int ret = EmuSystem::saveStateFile(path, async);
+	saveFullState = 0;
+	return ret;
+}
+
 void EmuSystem::saveAutoState()
 {
 	if(gameIsRunning() && optionAutoSaveState)
 	{
 		std::string statePath = MDFN_MakeFName(MDFNMKF_STATE, 0, "ncq");
-		logMsg("saving autosave-state %s", statePath.c_str());
 		#ifdef CONFIG_BASE_IOS_SETUID
 			fixFilePermissions(statePath.c_str());
 		#endif
-		MDFNI_SaveState(statePath.c_str(), 0, 0, 0, 0);
+		saveFullStateFile(statePath.c_str(), 1);
 	}
 }
 
@@ -346,20 +358,31 @@ void EmuSystem::clearInputBuffers()
 	mem_zero(inputBuff);
 }
 
-void EmuSystem::configAudioRate()
+static void setSoundRate()
 {
-	pcmFormat.rate = optionSoundRate;
-	espec.SoundRate = (float)optionSoundRate * (vce.lc263 ? 0.99702 : 1.001);
+	espec.SoundRate = (float)optionSoundRate * (vce.lc263 ? 0.99702 : 1.001) * EmuSystem::audioRateScale;
 	#ifdef CONFIG_ENV_WEBOS
-		if(optionFrameSkip != optionFrameSkipAuto)
+		if(optionFrameSkip != EmuSystem::optionFrameSkipAuto)
 			espec.SoundRate *= 42660./44100.; // better sync with Pre's refresh rate
 	#elif defined(CONFIG_BASE_PS3)
 		espec.SoundRate *= 1.0011;
 	#endif
+}
+
+void EmuSystem::configAudioRate()
+{
+	pcmFormat.rate = optionSoundRate;
+	setSoundRate();
 	logMsg("emu sound rate %d, 262 lines %d, fskip %d", (int)espec.SoundRate, !vce.lc263, (int)optionFrameSkip);
 	PCE_Fast::applySoundFormat(&espec);
 }
 
+void EmuSystem::applyAudioRateScale()
+{
+	setSoundRate();
+	PCE_Fast::adjustSoundRate(&espec);
+}
+
 static const uint audioMaxFramesPerUpdate = (Audio::maxRate/59)*2;
 
 static bool renderToScreen = 0;
@@ -523,14 +546,10 @@ int EmuSystem::saveState()
 	char ext[] = { "nc0" };
 	ext[2] = saveSlotChar(saveStateSlot);
 	std::string statePath = MDFN_MakeFName(MDFNMKF_STATE, 0, ext);
-	logMsg("saving state %s", statePath.c_str());
 	#ifdef CONFIG_BASE_IOS_SETUID
 		fixFilePermissions(statePath.c_str());
 	#endif
-	if(!MDFNI_SaveState(statePath.c_str(), 0, 0, 0, 0))
-		return STATE_RESULT_IO_ERROR;
-	else
-		return STATE_RESULT_OK;
+	return saveFullStateFile(statePath.c_str());
 }
 
 int EmuSystem::loadState(int saveStateSlot)
@@ -538,15 +557,43 @@ int EmuSystem::loadState(int saveStateSlot)
 	char ext[] = { "nc0" };
 	ext[2] = saveSlotChar(saveStateSlot);
 	std::string statePath = MDFN_MakeFName(MDFNMKF_STATE, 0, ext);
-	if(FsSys::fileExists(statePath.c_str()))
-	{
-		logMsg("loading state %s", statePath.c_str());
-		if(!MDFNI_LoadState(statePath.c_str(), 0))
-			return STATE_RESULT_IO_ERROR;
-		else
-			return STATE_RESULT_OK;
-	}
-	return STATE_RESULT_NO_FILE;
+	return loadStateFile(statePath.c_str());
+}
+
+// keeps its allocation between saves so capturing doesn't realloc each time
+static StateMem memState {0};
+
+static bool saveMemState()
+{
+	memState.loc = memState.len = 0;
+	return MDFNSS_SaveSM(&memState, 0, !saveFullState);
+}
+
+uint EmuSystem::stateBufferSize()
+{
+	if(!saveMemState())
+		return 0;
+	return memState.len;
+}
+
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size)
+{
+	if(!saveMemState() || memState.len > size)
+		return 0;
+	memcpy(buff, memState.data, memState.len);
+	return memState.len;
+}
+
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size)
+{
+	StateMem sm {0};
+	sm.data = (uint8*)buff;
+	sm.len = sm.malloced = size;
+	// state files are a full state with the MDFNSVST header
+	bool fullState = size >= 8 && !memcmp(buff, "MDFNSVST", 8);
+	if(!MDFNSS_LoadSM(&sm, fullState, !fullState))
+		return STATE_RESULT_INVALID_DATA;
+	return STATE_RESULT_OK;
 }
 
 void EmuSystem::savePathChanged() { }
@@ -562,7 +609,10 @@ void onInputEvent(const Input::Event &e)
 namespace Base
 {
 
-void onAppMessage(int type, int shortArg, int intArg, int intArg2) { }
+void onAppMessage(int type, int shortArg, int intArg, int intArg2)
+{
+	EmuIoWorker::onAppMessage(type, shortArg, intArg, intArg2);
+}
 
 CallResult onInit(int argc, char** argv)
 {
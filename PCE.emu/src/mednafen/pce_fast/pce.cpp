@@ -488,6 +488,15 @@ void applySoundFormat(EmulateSpecStruct *espec)
 	}
 }
 
+// only changes the resampling ratio, so buffered samples are kept
+void adjustSoundRate(EmulateSpecStruct *espec)
+{
+	for(int y = 0; y < 2; y++)
+	{
+		sbuf[y].clock_rate((long)(PCE_MASTER_CLOCK / 3 * ((double)sbuf[y].sample_rate() / espec->SoundRate)));
+	}
+}
+
 static void Emulate(EmulateSpecStruct *espec)
 {
  INPUT_Frame();
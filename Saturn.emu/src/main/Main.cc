@@ -453,6 +453,11 @@ int EmuSystem::loadState(int saveStateSlot)
 	return STATE_RESULT_NO_FILE;
 }
 
+// in-memory states not supported yet
+uint EmuSystem::stateBufferSize() { return 0; }
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size) { return 0; }
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size) { return STATE_RESULT_OTHER_ERROR; }
+
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
 	if(gameIsRunning())
@@ -528,6 +533,11 @@ void EmuSystem::configAudioRate()
 	pcmFormat.rate = optionSoundRate;
 }
 
+void EmuSystem::applyAudioRateScale()
+{
+	// the sound rate isn't adjustable
+}
+
 void EmuSystem::runFrame(bool renderGfx, bool processGfx, bool renderAudio)
 {
 	if(renderGfx)
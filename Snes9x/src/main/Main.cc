@@ -354,16 +354,23 @@ int EmuSystem::saveState()
 	#ifdef CONFIG_BASE_IOS_SETUID
 		fixFilePermissions(saveStr);
 	#endif
+	#ifndef SNES9X_VERSION_1_4
+	return saveStateFile(saveStr);
+	#else
 	if(!S9xFreezeGame(saveStr))
 		return STATE_RESULT_IO_ERROR;
 	else
 		return STATE_RESULT_OK;
+	#endif
 }
 
 int EmuSystem::loadState(int saveStateSlot)
 {
 	FsSys::cPath saveStr;
 	sprintStateFilename(saveStr, saveStateSlot);
+	#ifndef SNES9X_VERSION_1_4
+	return loadStateFile(saveStr);
+	#else
 	if(FsSys::fileExists(saveStr))
 	{
 		logMsg("loading state %s", saveStr);
@@ -376,8 +383,46 @@ int EmuSystem::loadState(int saveStateSlot)
 			return STATE_RESULT_IO_ERROR;
 	}
 	return STATE_RESULT_NO_FILE;
+	#endif
+}
+
+#ifndef SNES9X_VERSION_1_4
+
+// S9xFreezeSize() does a full dummy save, cache it while the game is loaded
+static uint freezeSize = 0;
+
+uint EmuSystem::stateBufferSize()
+{
+	if(!freezeSize)
+		freezeSize = S9xFreezeSize();
+	return freezeSize;
+}
+
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size)
+{
+	uint stateSize = stateBufferSize();
+	if(stateSize > size || !S9xFreezeGameMem(buff, stateSize))
+		return 0;
+	return stateSize;
+}
+
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size)
+{
+	if(S9xUnfreezeGameMem(buff, size) != SUCCESS)
+		return STATE_RESULT_INVALID_DATA;
+	IPPU.RenderThisFrame = TRUE;
+	return STATE_RESULT_OK;
 }
 
+#else
+
+// 1.43 has no memory stream support, its files go straight through gz streams
+uint EmuSystem::stateBufferSize() { return 0; }
+uint EmuSystem::saveStateToBuffer(uchar *buff, uint size) { return 0; }
+int EmuSystem::loadStateFromBuffer(const uchar *buff, uint size) { return STATE_RESULT_OTHER_ERROR; }
+
+#endif
+
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
 	if(gameIsRunning() && CPU.SRAMModified)
@@ -401,8 +446,12 @@ void EmuSystem::saveAutoState()
 		#ifdef CONFIG_BASE_IOS_SETUID
 			fixFilePermissions(saveStr);
 		#endif
+		#ifndef SNES9X_VERSION_1_4
+		saveStateFile(saveStr, 1);
+		#else
 		if(!S9xFreezeGame(saveStr))
 			logMsg("error saving state %s", saveStr);
+		#endif
 	}
 }
 
@@ -414,6 +463,9 @@ void S9xAutoSaveSRAM (void)
 void EmuSystem::closeSystem()
 {
 	saveBackupMem();
+	#ifndef SNES9X_VERSION_1_4
+	freezeSize = 0;
+	#endif
 }
 
 bool EmuSystem::vidSysIsPAL() { return 0; }
@@ -595,7 +647,13 @@ void EmuSystem::clearInputBuffers()
 void EmuSystem::configAudioRate()
 {
 	pcmFormat.rate = optionSoundRate;
-	Settings.SoundPlaybackRate = optionSoundRate;
+	applyAudioRateScale();
+}
+
+// both cores only recalculate their resampling steps for a new rate
+void EmuSystem::applyAudioRateScale()
+{
+	Settings.SoundPlaybackRate = optionSoundRate * audioRateScale;
 	#if defined(CONFIG_ENV_WEBOS)
 	if(optionFrameSkip != optionFrameSkipAuto)
 		Settings.SoundPlaybackRate = (float)optionSoundRate * (42660./44100.); // better sync with Pre's refresh rate
@@ -825,7 +883,10 @@ void onInputEvent(const Input::Event &e)
 namespace Base
 {
 
-void onAppMessage(int type, int shortArg, int intArg, int intArg2) { }
+void onAppMessage(int type, int shortArg, int intArg, int intArg2)
+{
+	EmuIoWorker::onAppMessage(type, shortArg, intArg, intArg2);
+}
 
 CallResult onInit(int argc, char** argv)
 {
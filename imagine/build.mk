@@ -18,6 +18,10 @@ include $(imagineSrcDir)/bluetooth/system.mk
 ifeq ($(ENV), android)
  include $(imagineSrcDir)/io/zip/build.mk
 endif
+# zip/7z through libarchive & the ROM cache, cores fall back to their own zip code without it
+ifdef config_ioArchive
+ include $(imagineSrcDir)/io/archive/build.mk
+endif
 include $(imagineSrcDir)/gui/GuiTable1D/build.mk
 include $(imagineSrcDir)/gui/MenuItem/build.mk
 include $(imagineSrcDir)/gui/FSPicker/build.mk
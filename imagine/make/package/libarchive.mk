@@ -0,0 +1,12 @@
+ifndef inc_pkg_libarchive
+inc_pkg_libarchive := 1
+
+ifeq ($(CROSS_COMPILE), 1)
+ CPPFLAGS += $(shell PKG_CONFIG_PATH=$(system_externalSysroot)/lib/pkgconfig PKG_CONFIG_SYSTEM_INCLUDE_PATH=$(system_externalSysroot)/include pkg-config libarchive --cflags --static --define-variable=prefix=$(system_externalSysroot))
+ LDLIBS += $(shell PKG_CONFIG_PATH=$(system_externalSysroot)/lib/pkgconfig PKG_CONFIG_SYSTEM_LIBRARY_PATH=$(system_externalSysroot)/lib pkg-config libarchive --libs --static --define-variable=prefix=$(system_externalSysroot))
+else
+ CPPFLAGS += $(shell pkg-config libarchive --cflags)
+ LDLIBS += $(shell pkg-config libarchive --libs)
+endif
+
+endif
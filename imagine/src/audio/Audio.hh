@@ -14,6 +14,11 @@
 	#define CONFIG_AUDIO_CAN_USE_MAX_BUFFERS_HINT
 #endif
 
+#if defined CONFIG_AUDIO_SDL || defined CONFIG_AUDIO_ALSA
+	// a dedicated audio thread pulls samples from a ring that writePcm() fills
+	#define CONFIG_AUDIO_PULL_STATS
+#endif
+
 namespace Audio
 {
 
@@ -24,6 +29,18 @@ struct BufferContext
 	uframes frames = 0;
 };
 
+// counters kept by the audio thread of pull-model backends
+struct PullStats
+{
+	uint periods = 0; // device periods filled
+	uint underruns = 0; // periods padded with silence because the ring ran dry
+	uint xruns = 0; // times the device itself ran dry & was restarted
+	uint reopens = 0; // times the device was lost & opened again
+	uint droppedFrames = 0; // frames writePcm() couldn't fit in the ring
+	uint periodFrames = 0;
+	uint lastPeriodUSecs = 0, maxPeriodUSecs = 0; // time between period callbacks
+};
+
 static const PcmFormat maxFormat { maxRate, &SampleFormats::s16, 2 };
 
 #if !defined(CONFIG_AUDIO)
@@ -63,6 +80,9 @@ void setHintPcmMaxBuffers(uint buffers);
 uint hintPcmMaxBuffers();
 void setHintStrictUnderrunCheck(bool on);
 bool hintStrictUnderrunCheck();
+#ifdef CONFIG_AUDIO_PULL_STATS
+void pullStats(PullStats &stats);
+#endif
 
 #endif
 
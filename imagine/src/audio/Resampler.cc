@@ -0,0 +1,337 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "resampler"
+#include <audio/Resampler.hh>
+#include <logger/interface.h>
+#include <mem/interface.h>
+#include <util/number.h>
+#include <string.h>
+#include <math.h>
+#if defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+namespace Audio
+{
+
+static const uint phaseBits = 8;
+static const uint phases = 1 << phaseBits;
+static const uint sincBaseTaps = 32, sincMaxTaps = 128; // multiples of 8
+static const double passband = .91; // fraction of the output Nyquist rate kept
+static const double kaiserBeta = 8.; // ~80dB stopband
+
+static double besselI0(double x)
+{
+	double sum = 1, term = 1;
+	for(uint k = 1; k < 32; k++)
+	{
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+		if(term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+// sum of samples[i] * coeff[i] in Q15, taps is a multiple of 8
+static int dot(const int16 *samples, const int16 *coeff, uint taps)
+{
+	#if defined __SSE2__
+	__m128i acc = _mm_setzero_si128();
+	for(uint i = 0; i < taps; i += 8)
+	{
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)&samples[i]),
+			_mm_loadu_si128((const __m128i*)&coeff[i])));
+	}
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(acc);
+	#elif defined __ARM_NEON__
+	int32x4_t acc = vdupq_n_s32(0);
+	for(uint i = 0; i < taps; i += 8)
+	{
+		acc = vmlal_s16(acc, vld1_s16(&samples[i]), vld1_s16(&coeff[i]));
+		acc = vmlal_s16(acc, vld1_s16(&samples[i+4]), vld1_s16(&coeff[i+4]));
+	}
+	int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+	return vget_lane_s32(vpadd_s32(sum, sum), 0);
+	#else
+	int acc = 0;
+	for(uint i = 0; i < taps; i += 4)
+	{
+		acc += samples[i] * coeff[i] + samples[i+1] * coeff[i+1]
+			+ samples[i+2] * coeff[i+2] + samples[i+3] * coeff[i+3];
+	}
+	return acc;
+	#endif
+}
+
+static int16 clampSample(int s)
+{
+	if(unlikely(s > 32767))
+		return 32767;
+	if(unlikely(s < -32768))
+		return -32768;
+	return s;
+}
+
+CallResult Resampler::init(uint channels, double inRate, double outRate, Quality quality)
+{
+	deinit();
+	if(channels < 1 || channels > 2 || inRate <= 0 || outRate <= 0)
+	{
+		logErr("invalid format: %d channels, %f -> %fHz", channels, inRate, outRate);
+		return INVALID_PARAMETER;
+	}
+	this->channels = channels;
+	quality_ = quality;
+	switch(quality)
+	{
+		bcase LINEAR: taps_ = 2;
+		bcase CUBIC: taps_ = 4;
+		bdefault: makeFilter(inRate / outRate);
+	}
+	step = (inRate / outRate) * 4294967296.;
+	if(!reserve(taps_ + 1024))
+	{
+		deinit();
+		return OUT_OF_MEMORY;
+	}
+	clear();
+	logMsg("%f -> %fHz, %d channels, %d taps", inRate, outRate, channels, taps_);
+	return OK;
+}
+
+void Resampler::deinit()
+{
+	mem_freeSafe(buff);
+	buff = nullptr;
+	mem_freeSafe(coeff);
+	coeff = nullptr;
+	buffFrames = buffCapacity = skip = 0;
+	channels = 0;
+	taps_ = 0;
+	cutoff = 0;
+}
+
+void Resampler::makeFilter(double ratio)
+{
+	uint taps = sincBaseTaps;
+	if(ratio > 1.)
+	{
+		// downsampling, widen the filter as the cutoff drops
+		taps = IG::min(((uint)ceil(sincBaseTaps * ratio) + 7) & ~7U, sincMaxTaps);
+	}
+	cutoff = IG::min(1., 1. / ratio) * passband;
+	if(!coeff || taps != taps_)
+	{
+		mem_freeSafe(coeff);
+		coeff = (int16*)mem_alloc(phases * taps * sizeof(int16));
+	}
+	taps_ = taps;
+	double halfTaps = taps / 2;
+	double window0 = besselI0(kaiserBeta);
+	iterateTimes(phases, p)
+	{
+		double h[sincMaxTaps];
+		double sum = 0;
+		iterateTimes(taps, k)
+		{
+			// distance of this tap from the output point
+			double x = (double)k - (halfTaps - 1.) - (double)p / phases;
+			double r = x / halfTaps;
+			double window = r <= -1. || r >= 1. ? 0. : besselI0(kaiserBeta * sqrt(1. - r * r)) / window0;
+			double y = cutoff * x;
+			double sinc = y == 0. ? 1. : sin(M_PI * y) / (M_PI * y);
+			h[k] = cutoff * sinc * window;
+			sum += h[k];
+		}
+		// quantize with unity gain, putting the rounding error in the biggest tap
+		int16 *c = &coeff[p * taps];
+		int total = 0;
+		uint biggest = 0;
+		iterateTimes(taps, k)
+		{
+			c[k] = lround(h[k] / sum * 32768.);
+			total += c[k];
+			if(abs(c[k]) > abs(c[biggest]))
+				biggest = k;
+		}
+		c[biggest] += 32768 - total;
+	}
+}
+
+bool Resampler::reserve(uint frames)
+{
+	if(frames <= buffCapacity)
+		return 1;
+	uint newCapacity = IG::max(frames, buffCapacity * 2);
+	auto newBuff = (int16*)mem_alloc(newCapacity * channels * sizeof(int16));
+	if(!newBuff)
+	{
+		logErr("out of memory for %d frames", newCapacity);
+		return 0;
+	}
+	if(buff)
+	{
+		iterateTimes(channels, ch)
+		{
+			memcpy(&newBuff[ch * newCapacity], &buff[ch * buffCapacity], buffFrames * sizeof(int16));
+		}
+		mem_free(buff);
+	}
+	buff = newBuff;
+	buffCapacity = newCapacity;
+	return 1;
+}
+
+void Resampler::setRates(double inRate, double outRate)
+{
+	assert(isInit());
+	double ratio = inRate / outRate;
+	step = ratio * 4294967296.;
+	if(quality_ == SINC && fabs(IG::min(1., 1. / ratio) * passband - cutoff) > cutoff * .01)
+	{
+		// keep the same center tap so buffered input stays aligned
+		uint oldCenter = taps_ / 2;
+		makeFilter(ratio);
+		uint center = taps_ / 2;
+		if(center > oldCenter)
+		{
+			uint pad = center - oldCenter;
+			if(!reserve(buffFrames + pad))
+			{
+				clear();
+				return;
+			}
+			iterateTimes(channels, ch)
+			{
+				int16 *b = &buff[ch * buffCapacity];
+				memmove(&b[pad], b, buffFrames * sizeof(int16));
+				memset(b, 0, pad * sizeof(int16));
+			}
+			buffFrames += pad;
+		}
+		else if(center < oldCenter)
+		{
+			uint drop = IG::min(oldCenter - center, buffFrames);
+			iterateTimes(channels, ch)
+			{
+				int16 *b = &buff[ch * buffCapacity];
+				memmove(b, &b[drop], (buffFrames - drop) * sizeof(int16));
+			}
+			buffFrames -= drop;
+		}
+	}
+}
+
+void Resampler::clear()
+{
+	assert(isInit());
+	// pre-roll so the first input frame lines up with the first output frame
+	buffFrames = taps_ / 2 - 1;
+	iterateTimes(channels, ch)
+	{
+		memset(&buff[ch * buffCapacity], 0, buffFrames * sizeof(int16));
+	}
+	frac = 0;
+	skip = 0;
+}
+
+uint Resampler::maxOutFrames(uint inFrames) const
+{
+	return (((uint64)(buffFrames + inFrames) << 32) / step) + 1;
+}
+
+uint Resampler::process(const int16 *in, uint inFrames, int16 *out, uint maxOutFrames)
+{
+	assert(isInit());
+	if(!reserve(buffFrames + inFrames))
+		return 0;
+	iterateTimes(channels, ch)
+	{
+		int16 *b = &buff[ch * buffCapacity + buffFrames];
+		iterateTimes(inFrames, i)
+		{
+			b[i] = in[i * channels + ch];
+		}
+	}
+	buffFrames += inFrames;
+	dropSkipped();
+
+	uint pos = 0, written = 0;
+	uint64 f = frac;
+	while(written < maxOutFrames && pos + taps_ <= buffFrames)
+	{
+		iterateTimes(channels, ch)
+		{
+			const int16 *s = &buff[ch * buffCapacity + pos];
+			int sample;
+			switch(quality_)
+			{
+				bcase LINEAR:
+				{
+					sample = s[0] + (int)(((int64)(s[1] - s[0]) * (int64)f) >> 32);
+				}
+				bcase CUBIC:
+				{
+					float t = f * (1. / 4294967296.);
+					float p0 = s[0], p1 = s[1], p2 = s[2], p3 = s[3];
+					float c1 = .5f * (p2 - p0);
+					float c2 = p0 - 2.5f * p1 + 2.f * p2 - .5f * p3;
+					float c3 = .5f * (p3 - p0) + 1.5f * (p1 - p2);
+					sample = lrintf(((c3 * t + c2) * t + c1) * t + p1);
+				}
+				bdefault:
+				{
+					const int16 *c = &coeff[(f >> (32 - phaseBits)) * taps_];
+					sample = (dot(s, c, taps_) + 16384) >> 15;
+				}
+			}
+			out[written * channels + ch] = clampSample(sample);
+		}
+		written++;
+		f += step;
+		pos += f >> 32;
+		f &= 0xFFFFFFFF;
+	}
+	frac = f;
+
+	skip = pos;
+	dropSkipped();
+	return written;
+}
+
+void Resampler::dropSkipped()
+{
+	// input before the window is no longer needed, a step past the end
+	// of the buffer carries over to the next input
+	uint drop = IG::min(skip, buffFrames);
+	if(drop)
+	{
+		iterateTimes(channels, ch)
+		{
+			int16 *b = &buff[ch * buffCapacity];
+			memmove(b, &b[drop], (buffFrames - drop) * sizeof(int16));
+		}
+		buffFrames -= drop;
+		skip -= drop;
+	}
+}
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <engine-globals.h>
+
+namespace Audio
+{
+
+// Sample rate converter for interleaved 16-bit audio with 1 or 2 channels.
+// The rate ratio can be changed between calls without clicks, so output
+// can be kept in step with the device by small rate adjustments.
+class Resampler
+{
+public:
+	enum Quality
+	{
+		LINEAR, // 2 point
+		CUBIC, // 4 point Hermite
+		SINC // windowed sinc polyphase FIR, uses SSE2/NEON when built for it
+	};
+
+	constexpr Resampler() { }
+
+	CallResult init(uint channels, double inRate, double outRate, Quality quality = SINC);
+	void deinit();
+	bool isInit() const { return channels; }
+
+	// change the conversion ratio, keeping buffered input
+	void setRates(double inRate, double outRate);
+
+	// drop buffered input, as after a seek or a pause
+	void clear();
+
+	// converts all input frames, writing at most maxOutFrames & returning the
+	// number written, input beyond what fits in the output is kept for the next call
+	uint process(const int16 *in, uint inFrames, int16 *out, uint maxOutFrames);
+
+	// most frames process() can write for the given input
+	uint maxOutFrames(uint inFrames) const;
+
+	Quality quality() const { return quality_; }
+	uint taps() const { return taps_; }
+
+private:
+	int16 *buff = nullptr; // per channel input history, channel blocks of buffCapacity frames
+	int16 *coeff = nullptr; // SINC filter bank, phases x taps
+	uint buffFrames = 0, buffCapacity = 0;
+	uint skip = 0; // input frames to drop once they arrive
+	uint channels = 0;
+	uint taps_ = 0;
+	uint64 step = 0; // input frames per output frame, 32.32 fixed point
+	uint32 frac = 0; // position between buff[taps_/2 - 1] & buff[taps_/2]
+	double cutoff = 0;
+	Quality quality_ = SINC;
+
+	void makeFilter(double ratio);
+	bool reserve(uint frames);
+	void dropSkipped();
+};
+
+}
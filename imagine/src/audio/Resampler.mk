@@ -0,0 +1,6 @@
+ifndef inc_audio_resampler
+inc_audio_resampler := 1
+
+SRC += audio/Resampler.cc
+
+endif
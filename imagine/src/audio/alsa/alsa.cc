@@ -16,6 +16,10 @@
 #include <mem/interface.h>
 
 #include <audio/alsa/alsautils.h>
+#include <util/RingBuffer.hh>
+#include <util/thread/pthread.hh>
+#include <util/time/sys.hh>
+#include <unistd.h>
 
 namespace Audio
 {
@@ -23,12 +27,30 @@ namespace Audio
 PcmFormat preferredPcmFormat { 48000, &SampleFormats::s16, 2 };
 PcmFormat pcmFormat;
 static snd_output_t *debugOutput = nullptr;
-static snd_pcm_t *pcmHnd = 0;
+static snd_pcm_t *pcmHnd = 0; // null while the pcm thread reopens a lost device
+static bool pcmOpen = 0;
 static snd_pcm_uframes_t bufferSize, periodSize;
 static bool useMmap;
 static uint bufferFrames = 800;
 static uint buffers = 8;
 
+// The device only holds a few short periods, the rest of the latency comes
+// from the ring writePcm() fills, which a dedicated thread drains into the
+// device a period at a time. The ring is sized from the negotiated device
+// buffer plus one write, so the user buffer count doesn't apply here.
+static const uint devicePeriods = 3;
+static const uint devicePeriodUSecs = 3333;
+static const uint maxWaitErrors = 10;
+static const uint maxReopenUSecs = 500000;
+static uchar *localBuff = nullptr;
+static RingBuffer<uchar> rBuff;
+static ThreadPThread pcmThread;
+static bool quitPcmThread = 0;
+static PullStats stats;
+static int deviceDelay = 0; // frames queued in the device, updated by the pcm thread
+
+static CallResult openAlsaPcm(const PcmFormat &format);
+
 void setHintPcmFramesPerWrite(uint frames)
 {
 	logMsg("setting queue buffer frames to %d", frames);
@@ -72,35 +94,6 @@ static snd_pcm_format_t pcmFormatToAlsa(const SampleFormat &format)
 	}
 }
 
-int frameDelay()
-{
-	snd_pcm_sframes_t delay;
-	snd_pcm_delay(pcmHnd, &delay);
-	return delay;
-}
-
-int framesFree()
-{
-	return snd_pcm_avail_update(pcmHnd);
-}
-
-static void startPlaybackIfNeeded()
-{
-	auto state = snd_pcm_state(pcmHnd);
-	//logMsg("pcm state: %s", alsaPcmStateToString(state));
-	if(state == SND_PCM_STATE_XRUN)
-	{
-		logMsg("recovering from xrun");
-		snd_pcm_recover(pcmHnd, -EPIPE, 0);
-	}
-	else if(state == SND_PCM_STATE_PREPARED && framesFree() < (int)bufferFrames)
-	{
-		// start playback when one "buffer" of audio is left to write
-		logMsg("starting prepared pcm with %d frames free", framesFree());
-		snd_pcm_start(pcmHnd);
-	}
-}
-
 class AlsaMmapContext : public BufferContext
 {
 public:
@@ -152,82 +145,266 @@ public:
 	}
 };
 
-void writePcm(uchar *samples, uint framesToWrite)
+// copies frames from the ring, padding with silence if it runs dry,
+// returns false in that case
+static bool readRing(uchar *dest, uint frames)
 {
-	if(unlikely(!pcmHnd))
-		return;
-	auto framesFreeOnHW = framesFree();
-	if((uint)framesFreeOnHW < framesToWrite)
+	uint bytes = pcmFormat.framesToBytes(frames);
+	uint read = rBuff.read(dest, bytes);
+	if(read != bytes)
 	{
-		logWarn("sending %d frames but only %d free", framesToWrite, framesFreeOnHW);
-		framesToWrite = framesFreeOnHW;
+		memset(&dest[read], pcmFormat.sample->isSigned ? 0 : 0x80, bytes - read);
+		return 0;
 	}
+	return 1;
+}
+
+// fills frames on the device from the ring, returns false if it underran
+static bool fillDevice(uint frames)
+{
+	bool filled = 1;
 	if(useMmap)
 	{
 		AlsaMmapContext ctx;
-		//logMsg("starting mmap loop");
-		for(snd_pcm_uframes_t frames; framesToWrite; framesToWrite -= frames)
+		for(snd_pcm_uframes_t chunk; frames; frames -= chunk)
+		{
+			chunk = frames;
+			if(ctx.begin(pcmHnd, &chunk) != OK)
+				break;
+			filled &= readRing((uchar*)ctx.data, chunk);
+			if(ctx.commit(chunk) != OK)
+				break;
+		}
+	}
+	else
+	{
+		uchar buff[4096];
+		uint maxFrames = pcmFormat.bytesToFrames(sizeof(buff));
+		for(uint chunk; frames; frames -= chunk)
 		{
-			frames = framesToWrite;
-			if(ctx.begin(pcmHnd, &frames) != OK)
-				return;
-			assert(frames <= framesToWrite);
+			chunk = IG::min(frames, maxFrames);
+			filled &= readRing(buff, chunk);
+			auto written = snd_pcm_writei(pcmHnd, buff, chunk);
+			if(written != (snd_pcm_sframes_t)chunk)
+			{
+				if(written < 0)
+					logWarn("error writing %d frames", chunk);
+				break;
+			}
+		}
+	}
+	return filled;
+}
 
-			memcpy(ctx.data, samples, pcmFormat.framesToBytes(frames));
-			samples += pcmFormat.framesToBytes(frames);
+// hold playback until the ring can fill the whole device buffer
+static uint startBytes()
+{
+	return IG::min(pcmFormat.framesToBytes(bufferSize), rBuff.size());
+}
 
-			if(ctx.commit(frames) != OK)
-				return;
+// closes a lost device & keeps trying to open it again, writePcm() drops
+// what doesn't fit in the ring meanwhile, returns false if asked to quit first
+static bool reopenDevice()
+{
+	logErr("lost pcm device, reopening");
+	__atomic_add_fetch(&stats.reopens, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&deviceDelay, 0, __ATOMIC_RELAXED);
+	snd_pcm_close(pcmHnd);
+	pcmHnd = nullptr;
+	uint retryUSecs = devicePeriodUSecs * 30;
+	while(!__atomic_load_n(&quitPcmThread, __ATOMIC_ACQUIRE))
+	{
+		if(openAlsaPcm(pcmFormat) == OK)
+		{
+			logMsg("reopened pcm device");
+			__atomic_store_n(&stats.periodFrames, (uint)periodSize, __ATOMIC_RELAXED);
+			return 1;
 		}
+		usleep(retryUSecs);
+		retryUSecs = IG::min(retryUSecs * 2, maxReopenUSecs);
 	}
-	else
+	return 0;
+}
+
+static ptrsize runPcmThread(ThreadPThread &thread)
+{
+	logMsg("started pcm thread");
+	TimeSys lastPeriod;
+	bool hasLastPeriod = 0;
+	uint waitErrors = 0;
+	while(!__atomic_load_n(&quitPcmThread, __ATOMIC_ACQUIRE))
 	{
-		auto written = snd_pcm_writei(pcmHnd, samples, framesToWrite);
-		if(written != (snd_pcm_sframes_t)framesToWrite)
+		auto state = snd_pcm_state(pcmHnd);
+		if(state == SND_PCM_STATE_DISCONNECTED)
+		{
+			logErr("device disconnected");
+			if(!reopenDevice())
+				break;
+			hasLastPeriod = 0;
+			waitErrors = 0;
+			continue;
+		}
+		if(state == SND_PCM_STATE_XRUN || state == SND_PCM_STATE_SUSPENDED)
+		{
+			logMsg("recovering from %s", alsaPcmStateToString(state));
+			__atomic_add_fetch(&stats.xruns, 1, __ATOMIC_RELAXED);
+			snd_pcm_recover(pcmHnd, state == SND_PCM_STATE_XRUN ? -EPIPE : -ESTRPIPE, 1);
+			hasLastPeriod = 0;
+			continue;
+		}
+		if(state == SND_PCM_STATE_PREPARED)
+		{
+			if(rBuff.readAvailable() < startBytes())
+			{
+				usleep(devicePeriodUSecs);
+				continue;
+			}
+			auto avail = snd_pcm_avail_update(pcmHnd);
+			if(avail > 0)
+				fillDevice(avail);
+			logMsg("starting prepared pcm");
+			snd_pcm_start(pcmHnd);
+			hasLastPeriod = 0;
+			continue;
+		}
+
+		int err = snd_pcm_wait(pcmHnd, 100);
+		if(err < 0 && err != -EPIPE && err != -ESTRPIPE)
 		{
-			if(written < 0)
-				logWarn("error writing %d frames", framesToWrite);
-			else
-				logWarn("only %ld of %d frames written", written, framesToWrite);
+			// xruns are handled on the next pass, anything else may repeat forever
+			logErr("error waiting on pcm: %s", snd_strerror(err));
+			if(++waitErrors == maxWaitErrors)
+			{
+				if(!reopenDevice())
+					break;
+				hasLastPeriod = 0;
+				waitErrors = 0;
+				continue;
+			}
+			usleep(devicePeriodUSecs * waitErrors);
+			continue;
 		}
+		waitErrors = 0;
+		if(err <= 0)
+			continue;
+		auto avail = snd_pcm_avail_update(pcmHnd);
+		if(avail < (snd_pcm_sframes_t)periodSize)
+			continue;
+
+		TimeSys now;
+		now.setTimeNow();
+		if(hasLastPeriod)
+		{
+			auto gap = now;
+			gap -= lastPeriod;
+			uint usecs = gap.divByUSecs(1);
+			__atomic_store_n(&stats.lastPeriodUSecs, usecs, __ATOMIC_RELAXED);
+			if(usecs > __atomic_load_n(&stats.maxPeriodUSecs, __ATOMIC_RELAXED))
+				__atomic_store_n(&stats.maxPeriodUSecs, usecs, __ATOMIC_RELAXED);
+		}
+		lastPeriod = now;
+		hasLastPeriod = 1;
+
+		// only whole periods so the device wakes us at a steady rate
+		uint periods = avail / periodSize;
+		if(!fillDevice(periods * periodSize))
+		{
+			//logMsg("underrun, ring had %d bytes", rBuff.readAvailable());
+			__atomic_add_fetch(&stats.underruns, 1, __ATOMIC_RELAXED);
+		}
+		__atomic_add_fetch(&stats.periods, periods, __ATOMIC_RELAXED);
+		snd_pcm_sframes_t delay;
+		if(snd_pcm_delay(pcmHnd, &delay) == 0)
+			__atomic_store_n(&deviceDelay, (int)IG::max(delay, (snd_pcm_sframes_t)0), __ATOMIC_RELAXED);
 	}
-	startPlaybackIfNeeded();
+	__atomic_store_n(&deviceDelay, 0, __ATOMIC_RELAXED);
+	logMsg("exiting pcm thread");
+	return 0;
+}
+
+int frameDelay()
+{
+	return pcmFormat.bytesToFrames(rBuff.readAvailable()) + __atomic_load_n(&deviceDelay, __ATOMIC_RELAXED);
+}
+
+int framesFree()
+{
+	return pcmFormat.bytesToFrames(rBuff.writeAvailable());
+}
+
+void writePcm(uchar *samples, uint framesToWrite)
+{
+	if(unlikely(!pcmOpen))
+		return;
+	uint bytes = pcmFormat.framesToBytes(framesToWrite), written;
+	if((written = rBuff.write(samples, bytes)) != bytes)
+	{
+		//logMsg("overrun, wrote %d out of %d bytes", written, bytes);
+		__atomic_add_fetch(&stats.droppedFrames, pcmFormat.bytesToFrames(bytes - written), __ATOMIC_RELAXED);
+	}
+}
+
+void pullStats(PullStats &s)
+{
+	s.periods = __atomic_load_n(&stats.periods, __ATOMIC_RELAXED);
+	s.underruns = __atomic_load_n(&stats.underruns, __ATOMIC_RELAXED);
+	s.xruns = __atomic_load_n(&stats.xruns, __ATOMIC_RELAXED);
+	s.reopens = __atomic_load_n(&stats.reopens, __ATOMIC_RELAXED);
+	s.droppedFrames = __atomic_load_n(&stats.droppedFrames, __ATOMIC_RELAXED);
+	s.periodFrames = __atomic_load_n(&stats.periodFrames, __ATOMIC_RELAXED);
+	s.lastPeriodUSecs = __atomic_load_n(&stats.lastPeriodUSecs, __ATOMIC_RELAXED);
+	s.maxPeriodUSecs = __atomic_load_n(&stats.maxPeriodUSecs, __ATOMIC_RELAXED);
 }
 
 static int setupPcm(const PcmFormat &format, snd_pcm_access_t access)
 {
-	int alsalibResample = 1;
-	uint wantedBufferFrames = bufferFrames*buffers;
-	auto wantedLatency = format.framesToUSecs(wantedBufferFrames);
-	logMsg("requesting pcm latency %fus from %d frames", (double)wantedLatency, wantedBufferFrames);
+	snd_pcm_hw_params_t *hwParams;
+	snd_pcm_hw_params_alloca(&hwParams);
 	int err;
-	if ((err = snd_pcm_set_params(pcmHnd,
-		pcmFormatToAlsa(*format.sample),
-		access,
-		format.channels,
-		format.rate,
-		alsalibResample,
-		wantedLatency)) < 0)
+	if((err = snd_pcm_hw_params_any(pcmHnd, hwParams)) < 0
+		|| (err = snd_pcm_hw_params_set_rate_resample(pcmHnd, hwParams, 1)) < 0
+		|| (err = snd_pcm_hw_params_set_access(pcmHnd, hwParams, access)) < 0
+		|| (err = snd_pcm_hw_params_set_format(pcmHnd, hwParams, pcmFormatToAlsa(*format.sample))) < 0
+		|| (err = snd_pcm_hw_params_set_channels(pcmHnd, hwParams, format.channels)) < 0
+		|| (err = snd_pcm_hw_params_set_rate(pcmHnd, hwParams, format.rate, 0)) < 0)
 	{
 		logErr("Error setting pcm parameters: %s", snd_strerror(err));
 		return err;
 	}
+	snd_pcm_uframes_t wantedPeriod = (uint64)format.rate * devicePeriodUSecs / 1000000;
+	uint periods = devicePeriods;
+	int dir = 0;
+	snd_pcm_hw_params_set_period_size_near(pcmHnd, hwParams, &wantedPeriod, &dir);
+	snd_pcm_hw_params_set_periods_near(pcmHnd, hwParams, &periods, &dir);
+	if((err = snd_pcm_hw_params(pcmHnd, hwParams)) < 0)
+	{
+		logErr("Error applying pcm parameters: %s", snd_strerror(err));
+		return err;
+	}
+	snd_pcm_hw_params_get_period_size(hwParams, &periodSize, &dir);
+	snd_pcm_hw_params_get_buffer_size(hwParams, &bufferSize);
+
+	// wake the pcm thread every period, it starts the stream itself
+	snd_pcm_sw_params_t *swParams;
+	snd_pcm_sw_params_alloca(&swParams);
+	snd_pcm_uframes_t boundary;
+	if((err = snd_pcm_sw_params_current(pcmHnd, swParams)) < 0
+		|| (err = snd_pcm_sw_params_get_boundary(swParams, &boundary)) < 0
+		|| (err = snd_pcm_sw_params_set_avail_min(pcmHnd, swParams, periodSize)) < 0
+		|| (err = snd_pcm_sw_params_set_start_threshold(pcmHnd, swParams, boundary)) < 0
+		|| (err = snd_pcm_sw_params(pcmHnd, swParams)) < 0)
+	{
+		logErr("Error setting pcm software parameters: %s", snd_strerror(err));
+		return err;
+	}
 
 	if(access == SND_PCM_ACCESS_MMAP_INTERLEAVED)
 		useMmap = 1;
 	else
 		useMmap = 0;
 
-	if((err = snd_pcm_get_params(pcmHnd, &bufferSize, &periodSize) < 0))
-	{
-		logErr("Error getting pcm buffer/period size parameters");
-		return err;
-	}
-	else
-	{
-		logMsg("buffer size %u, period size %u, mmap %d", (uint)bufferSize, (uint)periodSize, useMmap);
-		return 0;
-	}
+	logMsg("buffer size %u, period size %u, mmap %d", (uint)bufferSize, (uint)periodSize, useMmap);
+	return 0;
 }
 
 static CallResult openAlsaPcm(const PcmFormat &format)
@@ -241,6 +418,7 @@ static CallResult openAlsaPcm(const PcmFormat &format)
 	if ((err = snd_pcm_open(&pcmHnd, name, SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK)) < 0)
 	{
 		logErr("Playback open error: %s", snd_strerror(err));
+		pcmHnd = 0;
 		return INVALID_PARAMETER;
 	}
 
@@ -285,28 +463,64 @@ static CallResult openAlsaPcm(const PcmFormat &format)
 
 static void closeAlsaPcm()
 {
+	if(localBuff)
+	{
+		__atomic_store_n(&quitPcmThread, 1, __ATOMIC_RELEASE);
+		pcmThread.join();
+		rBuff.reset();
+		mem_free(localBuff);
+		localBuff = nullptr;
+	}
 	if(pcmHnd)
 	{
 		logDMsg("closing pcm");
 		snd_pcm_close(pcmHnd);
 		pcmHnd = 0;
 	}
+	pcmOpen = 0;
 }
 
 CallResult openPcm(const PcmFormat &format)
 {
-	if(pcmHnd)
+	if(pcmOpen)
 	{
 		logMsg("audio already open");
 		return OK;
 	}
 	pcmFormat = format;
-	return openAlsaPcm(format);
+	auto ret = openAlsaPcm(format);
+	if(ret != OK)
+		return ret;
+	// room for one write on top of the device buffer, so EmuPacing's half-full
+	// target stays near the device latency instead of many writes deep
+	uint ringSize = format.framesToBytes(bufferFrames + bufferSize);
+	localBuff = (uchar*)mem_alloc(ringSize);
+	if(!localBuff)
+	{
+		logErr("error allocating audio buffer");
+		closeAlsaPcm();
+		return OUT_OF_MEMORY;
+	}
+	rBuff.init(localBuff, ringSize);
+	stats = PullStats();
+	stats.periodFrames = periodSize;
+	deviceDelay = 0;
+	quitPcmThread = 0;
+	if(!pcmThread.create(0, ThreadPThread::EntryDelegate::create<&runPcmThread>()))
+	{
+		logErr("error creating pcm thread");
+		mem_free(localBuff);
+		localBuff = nullptr;
+		closeAlsaPcm();
+		return INVALID_PARAMETER;
+	}
+	pcmOpen = 1;
+	return OK;
 }
 
 void closePcm()
 {
-	if(!pcmHnd)
+	if(!pcmOpen)
 	{
 		logMsg("audio already closed");
 		return;
@@ -316,7 +530,7 @@ void closePcm()
 
 bool isOpen()
 {
-	return pcmHnd;
+	return pcmOpen;
 }
 
 CallResult init()
@@ -19,6 +19,7 @@
 #include <logger/interface.h>
 #include <SDL.h>
 #include <util/RingBuffer.hh>
+#include <util/time/sys.hh>
 
 namespace Audio
 {
@@ -29,21 +30,43 @@ static uint bufferFrames = 800;
 static uint buffers = 8;
 static int startPlaybackBytes = 0;
 static uchar *localBuff = nullptr;
-static RingBuffer<int> rBuff;
+static RingBuffer<uchar> rBuff;
+static BufferContext audioBuffLockCtx;
 static bool isPlaying = 0;
+static PullStats stats;
+static TimeSys lastCallback;
+// callback period in frames, a power of 2 as SDL 1.2 requires, ~10ms at 44.1KHz
+static const uint periodFrames = 512;
 
+// runs on SDL's audio thread, the ring needs no locking with writePcm()
 static void audioCallback(void *userdata, Uint8 *buf, int bytes)
 {
-	int read;
-	if((read = rBuff.read(buf, bytes)) != bytes)
+	TimeSys now;
+	now.setTimeNow();
+	if(stats.periods)
+	{
+		auto gap = now;
+		gap -= lastCallback;
+		uint usecs = gap.divByUSecs(1);
+		__atomic_store_n(&stats.lastPeriodUSecs, usecs, __ATOMIC_RELAXED);
+		if(usecs > __atomic_load_n(&stats.maxPeriodUSecs, __ATOMIC_RELAXED))
+			__atomic_store_n(&stats.maxPeriodUSecs, usecs, __ATOMIC_RELAXED);
+	}
+	lastCallback = now;
+	__atomic_add_fetch(&stats.periods, 1, __ATOMIC_RELAXED);
+
+	uint read;
+	if((read = rBuff.read(buf, bytes)) != (uint)bytes)
 	{
 		//logMsg("underrun, read %d out of %d bytes", read, bytes);
+		__atomic_add_fetch(&stats.underruns, 1, __ATOMIC_RELAXED);
+		memset(&buf[read], pcmFmt.sample->bits == 16 ? 0 : 0x80, bytes - read);
 	}
 
 	static int debugCount = 0;
 	if(countToValueLooped(debugCount, 120))
 	{
-		//logMsg("%d bytes in buffer", rBuff.written);
+		//logMsg("%d bytes in buffer", rBuff.readAvailable());
 	}
 }
 
@@ -84,7 +107,7 @@ CallResult openPcm(const PcmFormat &format)
 	spec.freq = format.rate;
 	spec.format = (format.sample->bits == 16) ? AUDIO_S16SYS : AUDIO_U8;
 	spec.channels = format.channels;
-	spec.samples = 1024;
+	spec.samples = periodFrames;
 	spec.callback = audioCallback;
 	//spec.userdata = 0;
 	uint bufferSize = format.framesToBytes(bufferFrames) * buffers;
@@ -103,24 +126,51 @@ CallResult openPcm(const PcmFormat &format)
 		return INVALID_PARAMETER;
 	}
 	pcmFmt = format;
+	stats = PullStats();
+	stats.periodFrames = spec.samples;
 	logMsg("opened audio %dHz with buffer %d samples %d size", spec.freq, spec.samples, spec.size);
 	return OK;
 }
 
+static void startPlaybackIfNeeded()
+{
+	if(!isPlaying && (int)rBuff.readAvailable() >= startPlaybackBytes)
+	{
+		startPcm();
+	}
+}
+
 void writePcm(uchar *buffer, uint framesToWrite)
 {
 	assert(isOpen());
-	int bytes = pcmFmt.framesToBytes(framesToWrite), written;
-	SDL_LockAudio();
+	uint bytes = pcmFmt.framesToBytes(framesToWrite), written;
 	if((written = rBuff.write(buffer, bytes)) != bytes)
 	{
 		//logMsg("overrun, wrote %d out of %d bytes", written, bytes);
+		stats.droppedFrames += pcmFmt.bytesToFrames(bytes - written);
 	}
-	SDL_UnlockAudio();
-	if(!isPlaying && rBuff.written >= startPlaybackBytes)
-	{
-		startPcm();
-	}
+	startPlaybackIfNeeded();
+}
+
+BufferContext *getPlayBuffer(uint wantedFrames)
+{
+	if(unlikely(!isOpen()))
+		return nullptr;
+	// writes go straight into the ring, up to its wrap point
+	uint bytes = pcmFmt.framesToBytes(wantedFrames);
+	auto data = rBuff.reserve(bytes);
+	if(!data)
+		return nullptr;
+	audioBuffLockCtx.data = data;
+	audioBuffLockCtx.frames = pcmFmt.bytesToFrames(bytes);
+	return &audioBuffLockCtx;
+}
+
+void commitPlayBuffer(BufferContext *buffer, uint frames)
+{
+	assert(frames <= buffer->frames);
+	rBuff.commit(pcmFmt.framesToBytes(frames));
+	startPlaybackIfNeeded();
 }
 
 void closePcm()
@@ -128,7 +178,7 @@ void closePcm()
 	if(isOpen()/*SDL_GetAudioStatus() != SDL_AUDIO_STOPPED*/)
 	{
 		isPlaying = 0;
-		SDL_CloseAudio();
+		SDL_CloseAudio(); // stops the callback thread before the ring is reset
 		rBuff.reset();
 		mem_free(localBuff);
 		localBuff = nullptr;
@@ -141,6 +191,18 @@ bool isOpen()
 	return pcmFmt.rate != 0;//SDL_GetAudioStatus() == SDL_AUDIO_PLAYING;
 }
 
+void pullStats(PullStats &s)
+{
+	s.periods = __atomic_load_n(&stats.periods, __ATOMIC_RELAXED);
+	s.underruns = __atomic_load_n(&stats.underruns, __ATOMIC_RELAXED);
+	s.xruns = 0;
+	s.reopens = 0;
+	s.droppedFrames = stats.droppedFrames;
+	s.periodFrames = stats.periodFrames;
+	s.lastPeriodUSecs = __atomic_load_n(&stats.lastPeriodUSecs, __ATOMIC_RELAXED);
+	s.maxPeriodUSecs = __atomic_load_n(&stats.maxPeriodUSecs, __ATOMIC_RELAXED);
+}
+
 int frameDelay()
 {
 	return 0; // TODO
@@ -148,7 +210,7 @@ int frameDelay()
 
 int framesFree()
 {
-	return pcmFmt.bytesToFrames(rBuff.freeSpace());
+	return pcmFmt.bytesToFrames(rBuff.writeAvailable());
 }
 
 CallResult init()
@@ -1,3 +1,5 @@
+include $(imagineSrcDir)/audio/Resampler.mk
+
 ifdef config_audioModule
 
 ifneq ($(config_audioModule), none)
@@ -20,6 +20,7 @@
 #include <util/bits.h>
 #include <util/rectangle2.h>
 #include <util/Delegate.hh>
+#include <util/time/sys.hh>
 
 #if defined (CONFIG_BASE_X11) || (defined(CONFIG_BASE_ANDROID) && CONFIG_ENV_ANDROID_MINSDK < 9)
 	#include <sys/epoll.h>
@@ -71,7 +72,7 @@ void abort() ATTRS(noreturn);
 // Worker thread -> Main thread messages
 
 static const ushort MSG_START = 127, MSG_BT_SCAN_STATUS_DELEGATE = 130, MSG_ORIENTATION_CHANGE = 131,
-		MSG_USER = 255;
+		MSG_FS_DIR_SCAN = 132, MSG_USER = 255;
 void sendMessageToMain(ThreadPThread &thread, int type, int shortArg, int intArg, int intArg2);
 // version used when thread context isn't needed
 void sendMessageToMain(int type, int shortArg, int intArg, int intArg2);
@@ -120,6 +121,16 @@ void sleepUs(int us);
 // display refresh rate
 uint refreshRate();
 
+// presentation timing of the last frame shown, passed to Gfx::onDraw()
+struct FrameTime
+{
+	constexpr FrameTime() { }
+	TimeSys timestamp; // when the frame reached the display
+	double interval = 0; // refresh period in seconds
+	uint refreshes = 0; // refreshes since the frame before it, 0 if unknown
+	bool fromDisplay = 0; // reported by the display instead of measured after the swap
+};
+
 // external services
 #if defined (CONFIG_BASE_IOS)
 	void openURL(const char *url);
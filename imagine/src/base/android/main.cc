@@ -246,6 +246,7 @@ void openGLUpdateScreen()
 {
 	//if(!gfxUpdate) logMsg("sleeping after this frame");
 	jSwapBuffers(aEnv(), gfxUpdate);
+	generic_updateFrameTime();
 }
 
 #ifdef CONFIG_BLUETOOTH
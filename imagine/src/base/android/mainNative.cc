@@ -354,6 +354,7 @@ void openGLUpdateScreen()
 	/*TimeSys postTime;
 	postTime.setTimeNow();
 	logMsg("swap took %f", double(postTime - preTime));*/
+	generic_updateFrameTime();
 }
 
 bool surfaceTextureSupported()
@@ -4,6 +4,9 @@
 
 #ifdef CONFIG_FS
 	#include <fs/Fs.hh>
+	#ifdef CONFIG_FS_POSIX
+	#include <fs/posix/DirScanner.hh>
+	#endif
 #endif
 
 #ifdef CONFIG_INPUT
@@ -28,6 +31,7 @@
 
 #if defined(__unix__) || defined(__APPLE__)
 #include <unistd.h>
+#include <math.h>
 
 #include <sys/resource.h>
 #endif
@@ -42,6 +46,70 @@ namespace Base
 	uint refreshRate() { return refreshRate_; }
 #endif
 
+static FrameTime frameTime_;
+static bool hasFrameTime = 0;
+// consecutive swaps that came well before the estimated period
+static uint shortIntervals = 0;
+static double shortIntervalSum = 0;
+static const uint reseedIntervals = 8;
+
+const FrameTime &frameTime() { return frameTime_; }
+
+// records when a frame reached the display, a zero refreshes or interval
+// means the display didn't report it & it's estimated from the timestamps
+static void generic_setFrameTime(TimeSys timestamp, uint refreshes = 0, double interval = 0, bool fromDisplay = 0)
+{
+	double lastInterval = frameTime_.interval ? frameTime_.interval
+		: refreshRate() ? 1. / refreshRate() : 1. / 60.;
+	if(hasFrameTime)
+	{
+		double elapsed = timestamp - frameTime_.timestamp;
+		if(!interval)
+		{
+			interval = lastInterval;
+			if(elapsed > 1. / 400. && elapsed < lastInterval * .75)
+			{
+				// the estimate may be a multiple of the real period, only re-seed once
+				// enough consecutive short swaps agree so one early swap can't halve it
+				double shortAvg = shortIntervals ? shortIntervalSum / shortIntervals : elapsed;
+				if(fabs(elapsed - shortAvg) > shortAvg * .1)
+					shortIntervals = shortIntervalSum = 0;
+				shortIntervals++;
+				shortIntervalSum += elapsed;
+				if(shortIntervals == reseedIntervals)
+				{
+					interval = shortIntervalSum / shortIntervals;
+					shortIntervals = shortIntervalSum = 0;
+				}
+			}
+			else
+			{
+				shortIntervals = shortIntervalSum = 0;
+				if(elapsed < lastInterval * 1.5)
+					interval += (elapsed - lastInterval) * .02; // follow the average, ignoring missed refreshes
+			}
+		}
+		if(!refreshes)
+			refreshes = IG::max(1, int(elapsed / interval + .5));
+	}
+	else if(!interval)
+		interval = lastInterval;
+	frameTime_.timestamp = timestamp;
+	frameTime_.interval = interval;
+	frameTime_.refreshes = refreshes;
+	frameTime_.fromDisplay = fromDisplay;
+	hasFrameTime = 1;
+}
+
+// for displays without presentation timestamps, call right after a swap
+// that waits for vsync
+static void generic_updateFrameTime()
+{
+	TimeSys now;
+	now.setTimeNow();
+	generic_setFrameTime(now);
+}
+
 static bool triggerGfxResize = 0;
 static Window mainWin, currWin;
 bool gfxUpdate = 0;
@@ -190,6 +258,12 @@ static void processAppMsg(int type, int shortArg, int intArg, int intArg2)
 		}
 		#endif
 		#endif
+		#ifdef CONFIG_FS_POSIX
+		bcase MSG_FS_DIR_SCAN:
+		{
+			DirScanner::processMessage(intArg);
+		}
+		#endif
 		#if CONFIG_ENV_WEBOS_OS >= 3
 		bcase MSG_ORIENTATION_CHANGE:
 		{
@@ -135,6 +135,7 @@ void openGLUpdateScreen()
 	//logMsg("doing swap");
 	//glBindRenderbufferOES(GL_RENDERBUFFER_OES, viewRenderbuffer);
 	[Base::mainContext presentRenderbuffer:GL_RENDERBUFFER_OES];
+	generic_updateFrameTime();
 }
 
 void startAnimation()
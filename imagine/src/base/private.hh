@@ -3,4 +3,5 @@
 namespace Base
 {
 	void openGLUpdateScreen();
+	const FrameTime &frameTime();
 }
@@ -56,6 +56,7 @@ static void updateFrame()
 void openGLUpdateScreen()
 {
 	updateFrame();
+	generic_updateFrameTime();
 }
 
 static void exitApp() ATTRS(noreturn);
@@ -88,6 +88,7 @@ CallResult openGLSetMultisampleVideoMode(const Base::Window &win)
 void openGLUpdateScreen()
 {
 	SDL_GL_SwapBuffers();
+	generic_updateFrameTime();
 }
 
 void exitVal(int returnVal)
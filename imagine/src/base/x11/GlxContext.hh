@@ -49,6 +49,8 @@ class GlxContext
 	bool doubleBuffered = 0;
 	int (*glXSwapIntervalSGI)(int interval) = nullptr;
 	int (*glXSwapIntervalMESA)(unsigned int interval) = nullptr;
+	int (*glXGetSyncValuesOML)(Display *dpy, GLXDrawable drawable, int64_t *ust, int64_t *msc, int64_t *sbc) = nullptr;
+	int (*glXGetMscRateOML)(Display *dpy, GLXDrawable drawable, int32_t *numerator, int32_t *denominator) = nullptr;
 
 	bool createContext(XVisualInfo *vi)
 	{
@@ -208,6 +210,17 @@ public:
 		{
 			logWarn("no glXSwapInterval support");
 		}
+		if(strstr(extensions, "GLX_OML_sync_control"))
+		{
+			glXGetSyncValuesOML = (int (*)(Display*, GLXDrawable, int64_t*, int64_t*, int64_t*))
+				glXGetProcAddress((const GLubyte*) "glXGetSyncValuesOML");
+			glXGetMscRateOML = (int (*)(Display*, GLXDrawable, int32_t*, int32_t*))
+				glXGetProcAddress((const GLubyte*) "glXGetMscRateOML");
+			if(glXGetSyncValuesOML)
+			{
+				logMsg("has glXGetSyncValuesOML");
+			}
+		}
 		return win;
 	}
 
@@ -228,6 +241,23 @@ public:
 		}
 	}
 
+	// time in microseconds & count of the latest vertical retrace,
+	// returns false if the driver can't report them
+	bool syncValues(int64_t &ust, int64_t &msc)
+	{
+		int64_t sbc;
+		return glXGetSyncValuesOML && glXGetSyncValuesOML(dpy, win, &ust, &msc, &sbc);
+	}
+
+	// refresh period in seconds, 0 if unknown
+	double refreshInterval()
+	{
+		int32_t num, den;
+		if(!glXGetMscRateOML || !glXGetMscRateOML(dpy, win, &num, &den) || !num || !den)
+			return 0;
+		return double(den) / num;
+	}
+
 	void deinit()
 	{
 		if(!glXMakeCurrent(dpy, None, 0))
@@ -41,6 +41,7 @@
 
 #include <sys/epoll.h>
 #include <time.h>
+#include <math.h>
 #include <errno.h>
 
 namespace Base
@@ -198,20 +199,44 @@ CallResult openGLSetMultisampleVideoMode(const Base::Window &win)
 	return setupGLWindow(win.w, win.h, 1);
 }
 
-/*static bool isTrackingFrameTime = 0;
+#ifndef CONFIG_GFX_OPENGL_ES
+static int64_t lastMsc = 0;
+static double omlInterval = -1; // queried on the first frame, it's a server round-trip
 
-void trackFrameTime(uint on)
+// uses GLX_OML_sync_control's retrace timestamp, returns false if not available
+static bool updateFrameTimeOML()
 {
-	isTrackingFrameTime = on;
-	if(on)
-		gfx_initFrameClockTime();
-}*/
+	int64_t ust, msc;
+	if(!glCtx.syncValues(ust, msc) || !ust)
+		return 0;
+	TimeSys timestamp {(struct timespec){ time_t(ust / 1000000), long(ust % 1000000) * 1000 }};
+	TimeSys now;
+	now.setTimeNow();
+	if(fabs(double(now - timestamp)) > 1.)
+	{
+		// UST isn't on CLOCK_MONOTONIC with this driver
+		return 0;
+	}
+	uint refreshes = lastMsc && msc > lastMsc ? msc - lastMsc : 0;
+	lastMsc = msc;
+	if(omlInterval < 0)
+	{
+		omlInterval = glCtx.refreshInterval();
+		logMsg("display refresh interval %fs from GLX_OML_sync_control", omlInterval);
+	}
+	generic_setFrameTime(timestamp, refreshes, omlInterval, 1);
+	return 1;
+}
+#endif
 
 void openGLUpdateScreen()
 {
 	glCtx.swap();
-	/*if(isTrackingFrameTime)
-		gfx_updateFrameClockTime();*/
+	#ifndef CONFIG_GFX_OPENGL_ES
+	if(updateFrameTimeOML())
+		return;
+	#endif
+	generic_updateFrameTime();
 }
 
 void setVideoInterval(uint interval)
@@ -583,6 +608,8 @@ int msgFdHandler(int events)
 
 }
 
+#ifndef CONFIG_BASE_NO_MAIN // app supplies its own main(), e.g. for headless tools
+
 static int epollWaitWrapper(int epfd, struct epoll_event *events,
 	int maxevents, int timeout)
 {
@@ -731,3 +758,5 @@ int main(int argc, char** argv)
 	}
 	return 0;
 }
+
+#endif
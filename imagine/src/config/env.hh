@@ -125,3 +125,9 @@ static const uint ENV_ANDROID_MINSDK =
 		#define CONFIG_GFX_OPENGL_BUFFER_IMAGE_MULTI_IMPL 1
 	#endif
 #endif
+
+#if defined CONFIG_BASE_X11 && !defined CONFIG_GFX_OPENGL_ES
+	// pixel buffer object texture streaming
+	#define CONFIG_GFX_OPENGL_BUFFER_STREAM 1
+	#define CONFIG_GFX_OPENGL_BUFFER_IMAGE_MULTI_IMPL 1
+#endif
@@ -0,0 +1,432 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "dirScanner"
+#include "DirScanner.hh"
+#include <fs/sys.hh>
+#include <io/sys.hh>
+#include <base/Base.hh>
+#include <logger/interface.h>
+#include <mem/interface.h>
+#include <util/strings.h>
+#include <util/time/sys.hh>
+#include <stdlib.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#ifdef __APPLE__
+	#include <util/apple/string.h>
+#endif
+
+static FsSys::cPath indexDir {0};
+static DirScanner *activeScanner = nullptr;
+static int lastId = 0;
+static const uint nameBlockSize = 32 * 1024;
+
+// index file layout: header, then per entry an IndexEntry followed by its name
+struct IndexHeader
+{
+	char magic[4];
+	uint32 entries;
+	int64 dirMTime, scanTime;
+};
+
+struct IndexEntry
+{
+	int64 mTime;
+	uint64 size;
+	uint16 nameSize;
+	uint8 type;
+};
+
+static const char indexMagic[4] {'D', 'I', 'X', '1'};
+
+static bool addEntry(DirScanner::Entry *&list, uint &size, uint &capacity, const DirScanner::Entry &e)
+{
+	if(size == capacity)
+	{
+		uint newCapacity = capacity ? capacity * 2 : 256;
+		auto newList = (DirScanner::Entry*)mem_realloc(list, newCapacity * sizeof(DirScanner::Entry));
+		if(!newList)
+		{
+			logErr("out of memory for %d entries", newCapacity);
+			return 0;
+		}
+		list = newList;
+		capacity = newCapacity;
+	}
+	list[size++] = e;
+	return 1;
+}
+
+static int compareEntryName(const void *e1, const void *e2)
+{
+	return strcmp(((const DirScanner::Entry*)e1)->name, ((const DirScanner::Entry*)e2)->name);
+}
+
+static int compareNameToEntry(const void *name, const void *e)
+{
+	return strcmp((const char*)name, ((const DirScanner::Entry*)e)->name);
+}
+
+// returns false if the index directory is too long to hold the file name
+static bool makeIndexPath(FsSys::cPath &indexPath, const char *path)
+{
+	// FNV-1a of the directory's path
+	uint64 hash = 0xCBF29CE484222325ULL;
+	for(const char *c = path; *c; c++)
+	{
+		hash = (hash ^ (uchar)*c) * 0x100000001B3ULL;
+	}
+	if(!string_printf(indexPath, "%s/%016llx.idx", indexDir, (unsigned long long)hash))
+	{
+		logWarn("index path too long for %s", path);
+		return 0;
+	}
+	return 1;
+}
+
+void DirScanner::setIndexPath(const char *path)
+{
+	string_copy(indexDir, path);
+	FsSys::mkdir(path);
+	logMsg("index path %s", path);
+}
+
+const char *DirScanner::addName(const char *name)
+{
+	uint size = strlen(name) + 1;
+	if(!nameBlocks || nameBlockUsed + size > nameBlockSize)
+	{
+		auto newNameBlock = (char**)mem_realloc(nameBlock, (nameBlocks + 1) * sizeof(char*));
+		if(!newNameBlock)
+			return nullptr;
+		nameBlock = newNameBlock;
+		nameBlock[nameBlocks] = (char*)mem_alloc(nameBlockSize);
+		if(!nameBlock[nameBlocks])
+			return nullptr;
+		nameBlocks++;
+		nameBlockUsed = 0;
+	}
+	char *str = &nameBlock[nameBlocks-1][nameBlockUsed];
+	memcpy(str, name, size);
+	nameBlockUsed += size;
+	return str;
+}
+
+bool DirScanner::loadIndex(const char *indexPath, bool &current)
+{
+	current = 0;
+	Io *io = IoSys::open(indexPath);
+	if(!io)
+		return 0;
+	auto data = io->mmapConst();
+	size_t size = io->size();
+	IndexHeader header;
+	if(!data || size < sizeof(header))
+	{
+		delete io;
+		return 0;
+	}
+	memcpy(&header, data, sizeof(header));
+	if(memcmp(header.magic, indexMagic, sizeof(indexMagic)) != 0
+		|| !(index = (Entry*)mem_alloc(IG::max(header.entries, 1U) * sizeof(Entry))))
+	{
+		delete io;
+		return 0;
+	}
+	size_t pos = sizeof(header);
+	iterateTimes(header.entries, i)
+	{
+		IndexEntry e;
+		char name[NAME_MAX + 1];
+		if(pos + sizeof(e) > size)
+			break;
+		memcpy(&e, &data[pos], sizeof(e));
+		pos += sizeof(e);
+		if(pos + e.nameSize > size || e.nameSize > NAME_MAX)
+			break;
+		memcpy(name, &data[pos], e.nameSize);
+		name[e.nameSize] = 0;
+		pos += e.nameSize;
+		auto nameStr = addName(name);
+		if(!nameStr)
+			break;
+		index[indexEntries++] = Entry{nameStr, (long)e.mTime, (ulong)e.size, e.type};
+	}
+	delete io;
+	if(indexEntries != header.entries)
+	{
+		logWarn("index %s is truncated", indexPath);
+		return 1;
+	}
+	// the directory's m-time only has second resolution, so an index written
+	// within the same second as the last change may be missing entries
+	current = header.dirMTime == dirMTime && header.scanTime > dirMTime;
+	return 1;
+}
+
+void DirScanner::writeIndex(const char *indexPath, long scanTime, const Entry *list, uint listEntries)
+{
+	FsSys::cPath tempPath;
+	if(!string_printf(tempPath, "%s.tmp", indexPath))
+	{
+		logWarn("index path too long for %s", indexPath);
+		return;
+	}
+	size_t size = sizeof(IndexHeader);
+	iterateTimes(listEntries, i)
+	{
+		size += sizeof(IndexEntry) + strlen(list[i].name);
+	}
+	auto data = (uchar*)mem_alloc(size);
+	if(!data)
+		return;
+	IndexHeader header {{0}, listEntries, dirMTime, scanTime};
+	memcpy(header.magic, indexMagic, sizeof(indexMagic));
+	memcpy(data, &header, sizeof(header));
+	size_t pos = sizeof(header);
+	iterateTimes(listEntries, i)
+	{
+		IndexEntry e {list[i].mTime, list[i].size, (uint16)strlen(list[i].name), list[i].type};
+		memcpy(&data[pos], &e, sizeof(e));
+		pos += sizeof(e);
+		memcpy(&data[pos], list[i].name, e.nameSize);
+		pos += e.nameSize;
+	}
+	if(IoSys::writeToNewFile(tempPath, data, size) != OK
+		|| FsSys::rename(tempPath, indexPath) != OK)
+	{
+		logErr("error writing %s", tempPath);
+		FsSys::remove(tempPath);
+	}
+	mem_free(data);
+}
+
+const DirScanner::Entry *DirScanner::findInIndex(const char *name) const
+{
+	if(!indexEntries)
+		return nullptr;
+	return (const Entry*)bsearch(name, index, indexEntries, sizeof(Entry), compareNameToEntry);
+}
+
+CallResult DirScanner::openDir(const char *path, FsDirFilterFunc filter, OnUpdateDelegate onUpdate)
+{
+	closeDir();
+	logMsg("opening directory %s", path);
+	struct stat s;
+	if(stat(path, &s) != 0 || !S_ISDIR(s.st_mode))
+	{
+		logErr("unable to open directory %s", path);
+		return INVALID_PARAMETER;
+	}
+	this->path = string_dup(path);
+	if(!this->path)
+		return OUT_OF_MEMORY;
+	var_selfs(filter);
+	var_selfs(onUpdate);
+	dirMTime = s.st_mtime;
+	id = ++lastId;
+	activeScanner = this;
+
+	FsSys::cPath indexPath;
+	bool indexIsCurrent = 0;
+	if(strlen(indexDir) && makeIndexPath(indexPath, path))
+	{
+		loadIndex(indexPath, indexIsCurrent);
+	}
+	if(indexIsCurrent)
+	{
+		logMsg("using index with %d entries", indexEntries);
+		iterateTimes(indexEntries, i)
+		{
+			if(!filter || filter(index[i].name, index[i].type))
+				addEntry(entry, entries, entryCapacity, index[i]);
+		}
+		mem_freeSafe(index);
+		index = nullptr;
+		indexEntries = 0;
+		return OK;
+	}
+
+	scanDone = notifyPosted = cancelScan = 0;
+	mutex.create();
+	if(!thread.create(0, ThreadPThread::EntryDelegate::create<DirScanner, &DirScanner::scan>(this)))
+	{
+		mutex.destroy();
+		return IO_ERROR;
+	}
+	scanning = 1;
+	return OK;
+}
+
+void DirScanner::closeDir()
+{
+	if(scanning)
+	{
+		__atomic_store_n(&cancelScan, 1, __ATOMIC_RELAXED);
+		thread.join();
+		scanning = 0;
+	}
+	mutex.destroy();
+	if(activeScanner == this)
+		activeScanner = nullptr;
+	mem_freeSafe(pending); pending = nullptr;
+	pendingEntries = pendingCapacity = 0;
+	mem_freeSafe(entry); entry = nullptr;
+	entries = entryCapacity = 0;
+	mem_freeSafe(index); index = nullptr;
+	indexEntries = 0;
+	iterateTimes(nameBlocks, i)
+	{
+		mem_free(nameBlock[i]);
+	}
+	mem_freeSafe(nameBlock); nameBlock = nullptr;
+	nameBlocks = nameBlockUsed = 0;
+	mem_freeSafe(path); path = nullptr;
+}
+
+ptrsize DirScanner::scan(ThreadPThread &thread)
+{
+	long scanTime = time(nullptr);
+	Entry *found = nullptr;
+	uint foundEntries = 0, foundCapacity = 0;
+	TimeSys lastPost;
+	lastPost.setTimeNow();
+	bool complete = 0;
+	if(DIR *dir = opendir(path))
+	{
+		struct dirent *d = nullptr;
+		complete = 1;
+		while(!__atomic_load_n(&cancelScan, __ATOMIC_RELAXED) && (d = readdir(dir)))
+		{
+			const char *name = d->d_name;
+			if(string_equal(name, ".") || string_equal(name, ".."))
+				continue;
+			#ifdef __APPLE__
+			// Precompose all strings for text renderer
+			char composedName[sizeof(d->d_name)];
+			precomposeUnicodeString(name, composedName, sizeof(composedName));
+			name = composedName;
+			#endif
+			Entry e;
+			if(auto cached = findInIndex(name))
+			{
+				e = *cached;
+			}
+			else
+			{
+				e.name = addName(name);
+				if(!e.name)
+				{
+					complete = 0;
+					break;
+				}
+				FsSys::cPath entryPath;
+				string_printf(entryPath, "%s/%s", path, d->d_name);
+				struct stat s;
+				if(stat(entryPath, &s) == 0)
+				{
+					e.type = S_ISDIR(s.st_mode) ? Fs::TYPE_DIR : Fs::TYPE_FILE;
+					e.size = s.st_size;
+					e.mTime = s.st_mtime;
+				}
+				else
+				{
+					logMsg("error in stat");
+					e.type = d->d_type == DT_DIR ? Fs::TYPE_DIR : Fs::TYPE_FILE;
+					e.size = 0;
+					e.mTime = 0;
+				}
+			}
+			addEntry(found, foundEntries, foundCapacity, e);
+			if(filter && !filter(e.name, e.type))
+				continue;
+
+			// batch entries so the UI isn't re-laid out for each one
+			TimeSys now;
+			now.setTimeNow();
+			bool post = 0;
+			mutex.lock();
+			addEntry(pending, pendingEntries, pendingCapacity, e);
+			if(!notifyPosted && double(now - lastPost) > 0.1)
+			{
+				notifyPosted = post = 1;
+				lastPost = now;
+			}
+			mutex.unlock();
+			if(post)
+				Base::sendMessageToMain(thread, Base::MSG_FS_DIR_SCAN, 0, id, 0);
+		}
+		if(__atomic_load_n(&cancelScan, __ATOMIC_RELAXED))
+			complete = 0;
+		closedir(dir);
+	}
+	else
+		logErr("unable to open directory %s", path);
+
+	if(complete && strlen(indexDir))
+	{
+		qsort(found, foundEntries, sizeof(Entry), compareEntryName);
+		FsSys::cPath indexPath;
+		if(makeIndexPath(indexPath, path))
+		{
+			writeIndex(indexPath, scanTime, found, foundEntries);
+			logMsg("indexed %d entries", foundEntries);
+		}
+	}
+	mem_freeSafe(found);
+
+	mutex.lock();
+	scanDone = 1;
+	mutex.unlock();
+	if(!__atomic_load_n(&cancelScan, __ATOMIC_RELAXED))
+		Base::sendMessageToMain(thread, Base::MSG_FS_DIR_SCAN, 0, id, 0);
+	return 0;
+}
+
+void DirScanner::update()
+{
+	mutex.lock();
+	bool done = scanDone;
+	uint newEntries = pendingEntries;
+	iterateTimes(pendingEntries, i)
+	{
+		addEntry(entry, entries, entryCapacity, pending[i]);
+	}
+	pendingEntries = 0;
+	notifyPosted = 0;
+	mutex.unlock();
+	if(done && scanning)
+	{
+		thread.join();
+		scanning = 0;
+		mem_freeSafe(index);
+		index = nullptr;
+		indexEntries = 0;
+		// entries keep their order until the scan completes, so existing ones don't move
+		qsort(entry, entries, sizeof(Entry), compareEntryName);
+	}
+	else if(!newEntries)
+		return;
+	onUpdate.invokeSafe(*this);
+}
+
+void DirScanner::processMessage(int id)
+{
+	if(activeScanner && activeScanner->id == id)
+		activeScanner->update();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <engine-globals.h>
+#include <fs/Fs.hh>
+#include <util/Delegate.hh>
+#include <util/thread/pthread.hh>
+
+// Directory listing that's read on a worker thread so large or slow
+// directories don't block the UI. Entries arrive in batches through the
+// update delegate on the main thread. Each directory's entries are saved
+// in an index file, so if the directory hasn't changed since the last
+// visit it's listed right away, and otherwise only new entries are stat'ed.
+class DirScanner : public Fs
+{
+public:
+	constexpr DirScanner() { }
+
+	struct Entry
+	{
+		const char *name;
+		long mTime;
+		ulong size;
+		uchar type;
+	};
+
+	// called on the main thread after new entries were added by update(),
+	// they're appended while scanning & all entries are sorted by name
+	// in the final update, when isScanning() returns false
+	typedef Delegate<void (DirScanner &scanner)> OnUpdateDelegate;
+
+	// index files are only used once a directory is set, it's created if needed
+	static void setIndexPath(const char *path);
+
+	// starts listing the absolute path, if the index is current all entries
+	// are available on return and no update will be sent
+	CallResult openDir(const char *path, FsDirFilterFunc filter, OnUpdateDelegate onUpdate);
+	void closeDir() override;
+	bool isScanning() const { return scanning; }
+
+	uint numEntries() const override { return entries; }
+	const char *entryFilename(uint index) const override { return entry[index].name; }
+	int entryType(uint index) const { return entry[index].type; }
+
+	// called by the Base message handler
+	static void processMessage(int id);
+
+private:
+	ThreadPThread thread;
+	MutexPThread mutex;
+	FsDirFilterFunc filter = nullptr;
+	OnUpdateDelegate onUpdate;
+	char *path = nullptr;
+	long dirMTime = 0;
+	// names are stored in fixed blocks so entry pointers stay valid as more are added
+	char **nameBlock = nullptr;
+	uint nameBlocks = 0, nameBlockUsed = 0;
+	Entry *entry = nullptr;
+	uint entries = 0, entryCapacity = 0;
+	// previous contents of the directory, sorted by name
+	Entry *index = nullptr;
+	uint indexEntries = 0;
+	// filled by the worker, guarded by mutex
+	Entry *pending = nullptr;
+	uint pendingEntries = 0, pendingCapacity = 0;
+	bool scanDone = 0, notifyPosted = 0;
+	bool scanning = 0, cancelScan = 0;
+	int id = 0;
+
+	const char *addName(const char *name);
+	bool loadIndex(const char *indexPath, bool &current);
+	void writeIndex(const char *indexPath, long scanTime, const Entry *list, uint listEntries);
+	const Entry *findInIndex(const char *name) const;
+	void update();
+	ptrsize scan(ThreadPThread &thread);
+};
@@ -6,6 +6,6 @@ include $(imagineSrcDir)/gui/GuiTable1D/build.mk
 
 configDefs += CONFIG_FS_POSIX
 
-SRC +=  fs/posix/FsPosix.cc
+SRC +=  fs/posix/FsPosix.cc fs/posix/DirScanner.cc
 
 endif
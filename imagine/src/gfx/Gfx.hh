@@ -98,6 +98,16 @@ static void shadeModAlpha()
 	setBlendMode(BLEND_MODE_ALPHA);
 }
 
+// draw list
+
+// Quads & sprites are queued and drawn together at the next state change the
+// list can't track, or when the frame ends. Between begin/endUnorderedDraws()
+// the caller promises the queued quads don't overlap so they may be drawn
+// sorted by texture & blend state instead of in submission order.
+void flushDrawList();
+void beginUnorderedDraws();
+void endUnorderedDraws();
+
 // transforms
 
 enum TransformTargetEnum { TARGET_WORLD, TARGET_TEXTURE };
@@ -155,7 +165,7 @@ struct GfxViewState
 
 // callbacks
 
-void onDraw();
+void onDraw(const Base::FrameTime &frameTime);
 void onViewChange(GfxViewState *oldState);
 
 }
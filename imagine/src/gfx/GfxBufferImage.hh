@@ -84,6 +84,7 @@ class BufferImage: public BufferImageImpl
 private:
 	uint hints = 0;
 	bool hasMipmaps_ = 0;
+	bool isSubImage = 0;
 	UsableImage *backingImg = nullptr;
 	void testMipmapSupport(uint x, uint y);
 	bool setupTexture(Pixmap &pix, bool upload, uint internalFormat, int xWrapType, int yWrapType,
@@ -107,11 +108,16 @@ public:
 	//CallResult subInit(ResourceImage &img, int x, int y, int xSize, int ySize);
 	#endif
 
+	// shares a region of parent's texture, deinit() leaves the texture alone
+	CallResult initSubImage(const BufferImage &parent, GTexC leftTexU, GTexC topTexV, GTexC rightTexU, GTexC bottomTexV);
+
 	void removeBacker() { backingImg = 0; }
 	void setFilter(uint filter);
 	void setRepeatMode(uint xMode, uint yMode);
 	void deinit();
 	void write(Pixmap &p);
+	// writes p with its top-left corner at texel x,y, images created with HINT_STREAM aren't supported
+	void writeSubImage(Pixmap &p, uint x, uint y);
 	void replace(Pixmap &p);
 	void unlock(Pixmap *p);
 };
@@ -165,6 +165,8 @@ void Text::draw(GC xPos, GC yPos, _2DOrigin o, _2DOrigin align) const
 	setBlendMode(BLEND_MODE_INTENSITY);
 	Sprite spr;
 	spr.init(0, 0, 1, 1);
+	// glyphs are blended additively so their draw order doesn't matter
+	beginUnorderedDraws();
 
 	xPos = o.adjustX(xPos, xSize, LT2DO);
 	//logMsg("aligned to %f, converted to %d", Gfx::alignYToPixel(yPos), toIYPos(Gfx::alignYToPixel(yPos)));
@@ -194,6 +196,7 @@ void Text::draw(GC xPos, GC yPos, _2DOrigin o, _2DOrigin align) const
 			if(res != OK)
 			{
 				logWarn("failed char conversion while drawing line %d, char %d, result %d", l, i, res);
+				endUnorderedDraws();
 				return;
 			}
 
@@ -227,6 +230,7 @@ void Text::draw(GC xPos, GC yPos, _2DOrigin o, _2DOrigin align) const
 		yPos -= nominalHeight;
 		totalCharsDrawn += charsToDraw;
 	}
+	endUnorderedDraws();
 	assert(totalCharsDrawn <= chars);
 }
 
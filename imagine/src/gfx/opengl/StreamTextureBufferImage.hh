@@ -0,0 +1,49 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <gfx/GfxBufferImage.hh>
+
+// Streamed texture for desktop OpenGL, used for HINT_STREAM images.
+// Frames go into a ring of pixel buffer objects and the texture is updated
+// from the buffer, so glTexSubImage2D returns without waiting on the GPU.
+// With GL_ARB_buffer_storage the buffers stay mapped and lock() returns the
+// mapped memory itself, letting the caller write pixels with no extra copy.
+
+namespace Gfx
+{
+
+struct StreamTextureBufferImage: public TextureBufferImage
+{
+	constexpr StreamTextureBufferImage() { }
+	static const uint buffers = 3;
+	GLuint pbo[buffers] {0};
+	uchar *mapped[buffers] {nullptr}; // only used with persistent mapping
+	GLsync fence[buffers] {nullptr};
+	uint bufferSize = 0, bufferIdx = 0;
+	Pixmap lockPix {PixelFormatRGB565};
+
+	bool init(const Pixmap &texPix);
+	void write(Pixmap &p, uint hints) override;
+	Pixmap *lock(uint x, uint y, uint xlen, uint ylen, Pixmap *fallback = nullptr) override;
+	void unlock(Pixmap *pix = nullptr, uint hints = 0) override;
+	void deinit() override;
+
+private:
+	void deinitBuffers();
+};
+
+}
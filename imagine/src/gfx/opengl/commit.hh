@@ -98,7 +98,8 @@ void renderFrame()
 		Base::displayNeedsUpdate();
 	}
 
-	Gfx::onDraw();
+	Gfx::onDraw(Base::frameTime());
+	flushDrawList();
 
 	//glFlush();
 	//glFinish();
@@ -106,7 +107,11 @@ void renderFrame()
 		if(unlikely(glSyncHackEnabled)) glFinish();
 	#endif
 
-	Base::openGLUpdateScreen();
+	{
+		profileZone(ZONE_SWAP);
+		Base::openGLUpdateScreen();
+	}
+	FrameProfiler::endFrame();
 
 	/*#if defined(CONFIG_GFX_OPENGL_ES) && defined(CONFIG_BASE_IOS)
 	if(useDiscardFramebufferEXT)
@@ -0,0 +1,182 @@
+#pragma once
+
+namespace Gfx
+{
+
+// Quads drawn through QuadGeneric & SpriteBase are queued here along with
+// the texture, blend mode, image mode & color they were drawn with, their
+// positions already transformed by the model matrix. A flush draws them
+// from one vertex stream with a single glDrawElements() per run of quads
+// sharing the same state, then restores the caller's state.
+
+struct DrawVertex
+{
+	GLfloat x, y, z;
+	TextureCoordinate u, v;
+	VertexColor color;
+};
+
+static const uint drawListMaxQuads = 1024;
+static DrawVertex drawListVtx[drawListMaxQuads * 4];
+static VertexIndex drawListIdx[drawListMaxQuads * 6];
+// per quad in draw order: texture & modes above bit 16, queue position below
+static uint64 drawListKey[drawListMaxQuads];
+uint drawListQuads = 0;
+static uint drawListUnorderedDepth = 0;
+
+// state last set by the caller, put back after a flush
+static GfxTextureHandle texState = 0;
+static uint texTypeState = 0;
+static uint blendModeState = BLEND_MODE_OFF, imgModeState = IMG_MODE_MODULATE;
+
+static uint64 drawListStateKey(GfxTextureHandle tex, uint texType, uint blendMode, uint imgMode)
+{
+	#if defined(CONFIG_GFX_OPENGL_TEXTURE_EXTERNAL_OES)
+	bool isExternal = tex && texType == GL_TEXTURE_EXTERNAL_OES;
+	#else
+	bool isExternal = 0;
+	#endif
+	if(!tex)
+		imgMode = 0; // doesn't apply to untextured quads
+	return ((uint64)tex << 5) | (isExternal << 4) | (blendMode << 2) | imgMode;
+}
+
+static void drawListApplyState(uint64 state)
+{
+	GfxTextureHandle tex = state >> 5;
+	#if defined(CONFIG_GFX_OPENGL_TEXTURE_EXTERNAL_OES)
+	uint texType = (state >> 4) & 1 ? GL_TEXTURE_EXTERNAL_OES : GL_TEXTURE_2D;
+	#else
+	uint texType = 0;
+	#endif
+	setActiveTexture(tex, texType);
+	setBlendMode((state >> 2) & 0x3);
+	setImgMode(state & 0x3);
+}
+
+// stable sort by state, the queue position keeps equal states in order
+static void drawListSort(uint quads)
+{
+	for(uint i = 1; i < quads; i++)
+	{
+		uint64 key = drawListKey[i];
+		uint j = i;
+		for(; j && drawListKey[j-1] > key; j--)
+			drawListKey[j] = drawListKey[j-1];
+		drawListKey[j] = key;
+	}
+}
+
+void flushDrawList()
+{
+	uint quads = drawListQuads;
+	if(!quads)
+		return;
+	drawListQuads = 0; // binding textures below must not flush again
+
+	if(drawListUnorderedDepth)
+		drawListSort(quads);
+	iterateTimes(quads, i)
+	{
+		VertexIndex v = (drawListKey[i] & 0xFFFF) * 4;
+		VertexIndex *idx = &drawListIdx[i * 6];
+		idx[0] = v; idx[1] = v + 1; idx[2] = v + 2;
+		idx[3] = v + 2; idx[4] = v + 1; idx[5] = v + 3;
+	}
+
+	GfxTextureHandle prevTex = texState;
+	uint prevTexType = texTypeState, prevBlendMode = blendModeState, prevImgMode = imgModeState;
+	GLfloat prevColor[4];
+	memcpy(prevColor, glState.colorState, sizeof(prevColor));
+
+	if(useVBOFuncs)
+		glState_bindBuffer(GL_ARRAY_BUFFER, 0);
+	glcEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glcTexCoordPointer(2, GL_FLOAT, sizeof(DrawVertex), &drawListVtx[0].u);
+	glcEnableClientState(GL_COLOR_ARRAY);
+	glcColorPointer(4, GL_UNSIGNED_BYTE, sizeof(DrawVertex), &drawListVtx[0].color);
+	glState.colorState[0] = -1; //invalidate glColor state cache
+	glcVertexPointer(3, GL_FLOAT, sizeof(DrawVertex), &drawListVtx[0].x);
+	if(transformTargetIsTexture)
+		glcMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+
+	for(uint start = 0; start < quads;)
+	{
+		uint64 state = drawListKey[start] >> 16;
+		uint end = start + 1;
+		while(end < quads && (drawListKey[end] >> 16) == state)
+			end++;
+		drawListApplyState(state);
+		glDrawElements(GL_TRIANGLES, (end - start) * 6, GL_UNSIGNED_SHORT, &drawListIdx[start * 6]);
+		start = end;
+	}
+
+	glLoadMatrixf(modelMat.v);
+	if(transformTargetIsTexture)
+		glcMatrixMode(GL_TEXTURE);
+	setActiveTexture(prevTex, prevTexType);
+	setBlendMode(prevBlendMode);
+	setImgMode(prevImgMode);
+	glcColor4f(prevColor[0], prevColor[1], prevColor[2], prevColor[3]);
+}
+
+void beginUnorderedDraws()
+{
+	if(!drawListUnorderedDepth)
+		flushDrawList();
+	drawListUnorderedDepth++;
+}
+
+void endUnorderedDraws()
+{
+	assert(drawListUnorderedDepth);
+	if(drawListUnorderedDepth == 1)
+		flushDrawList();
+	drawListUnorderedDepth--;
+}
+
+static void drawListSetTex(DrawVertex &d, const VertexPOD &v) { d.u = d.v = 0; }
+static void drawListSetTex(DrawVertex &d, const ColVertexPOD &v) { d.u = d.v = 0; }
+static void drawListSetTex(DrawVertex &d, const TexVertexPOD &v) { d.u = v.u; d.v = v.v; }
+static void drawListSetTex(DrawVertex &d, const ColTexVertexPOD &v) { d.u = v.u; d.v = v.v; }
+
+static void drawListSetColor(DrawVertex &d, const VertexPOD &v, VertexColor color) { d.color = color; }
+static void drawListSetColor(DrawVertex &d, const ColVertexPOD &v, VertexColor color) { d.color = v.color; }
+static void drawListSetColor(DrawVertex &d, const TexVertexPOD &v, VertexColor color) { d.color = color; }
+static void drawListSetColor(DrawVertex &d, const ColTexVertexPOD &v, VertexColor color) { d.color = v.color; }
+
+static uint drawListColorComponent(GLfloat c)
+{
+	return IG::min(IG::max(c, 0.f), 1.f) * 255.f + .5f;
+}
+
+// queues a quad in triangle strip order, tex is 0 for untextured quads
+template<class Vtx>
+static void queueQuad(const Vtx v[4], GfxTextureHandle tex, uint texType)
+{
+	if(drawListQuads == drawListMaxQuads)
+		flushDrawList();
+	VertexColor color = 0;
+	if(!Vtx::hasColor)
+	{
+		const GLfloat *c = glState.colorState;
+		color = VertexColorPixelFormat.build(drawListColorComponent(c[0]), drawListColorComponent(c[1]),
+			drawListColorComponent(c[2]), drawListColorComponent(c[3]));
+	}
+	const GLfloat *m = modelMat.v;
+	DrawVertex *d = &drawListVtx[drawListQuads * 4];
+	iterateTimes(4, i)
+	{
+		GLfloat x = v[i].x, y = v[i].y;
+		d[i].x = m[0] * x + m[4] * y + m[12];
+		d[i].y = m[1] * x + m[5] * y + m[13];
+		d[i].z = m[2] * x + m[6] * y + m[14];
+		drawListSetTex(d[i], v[i]);
+		drawListSetColor(d[i], v[i], color);
+	}
+	drawListKey[drawListQuads] = (drawListStateKey(tex, texType, blendModeState, imgModeState) << 16) | drawListQuads;
+	drawListQuads++;
+}
+
+}
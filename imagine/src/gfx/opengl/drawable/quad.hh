@@ -34,7 +34,7 @@ void QuadGeneric<Vtx>::draw() const
 {
 	if(!Vtx::hasTexture)
 		Gfx::setActiveTexture(0);
-	Vtx::draw(v, Gfx::TRIANGLE_STRIP, 4);
+	Gfx::queueQuad(v, texState, texTypeState);
 }
 
 template class QuadGeneric<Vertex>;
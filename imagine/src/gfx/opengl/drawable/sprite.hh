@@ -43,6 +43,7 @@ static void setupCropRect(BufferImage *img)
 	#else
 	GLenum target = img->textureDesc().target;
 	#endif
+	Gfx::flushDrawList();
 	Gfx::setActiveTexture(img->textureDesc().tid, target);
 	glTexParameteriv(target, GL_TEXTURE_CROP_RECT_OES, coords);
 }
@@ -80,6 +81,7 @@ void SpriteBase<BaseRect>::draw() const
 	#if defined CONFIG_BASE_ANDROID && defined CONFIG_GFX_OPENGL_USE_DRAW_TEXTURE
 	if(flags & HINT_NO_MATRIX_TRANSFORM && useDrawTex && projAngleM.isComplete())
 	{
+		Gfx::flushDrawList();
 		glDrawTexiOES(screenX, screenY, 1, screenX2, screenY2);
 	}
 	else
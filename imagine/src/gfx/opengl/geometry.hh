@@ -25,6 +25,7 @@ static int convGeomTypeToOGL(uint type)
 template<class Vtx>
 static void setupVertexArrayPointers(const Vtx *v, int numV)
 {
+	flushDrawList();
 	if(useVBOFuncs && v != 0) // turn off VBO when rendering from memory
 	{
 		//logMsg("un-binding VBO");
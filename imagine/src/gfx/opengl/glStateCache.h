@@ -490,12 +490,25 @@ public:
 extern GLStateCache glState;
 static const bool useGLCache = 1;
 
+namespace Gfx
+{
+extern uint drawListQuads;
+void flushDrawList();
+}
+
 static void glcMatrixMode(GLenum mode)
 { if(useGLCache) glState.matrixMode(mode); else glMatrixMode(mode); }
+// queued quads must be drawn with the textures they were queued with
 static void glcBindTexture(GLenum target, GLuint texture)
-{ if(useGLCache) glState.bindTexture(target, texture); else glBindTexture(target, texture); }
+{
+	if(unlikely(Gfx::drawListQuads)) Gfx::flushDrawList();
+	if(useGLCache) glState.bindTexture(target, texture); else glBindTexture(target, texture);
+}
 static void glcDeleteTextures(GLsizei n, const GLuint *textures)
-{ if(useGLCache) glState.deleteTextures(n, textures); else glDeleteTextures(n, textures); }
+{
+	if(unlikely(Gfx::drawListQuads)) Gfx::flushDrawList();
+	if(useGLCache) glState.deleteTextures(n, textures); else glDeleteTextures(n, textures);
+}
 static void glcBlendFunc(GLenum sfactor, GLenum dfactor)
 { if(useGLCache) glState.blendFunc(sfactor, dfactor); else glBlendFunc(sfactor, dfactor); }
 static void glcBlendEquation(GLenum mode)
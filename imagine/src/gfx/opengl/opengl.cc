@@ -20,6 +20,7 @@
 #include <mem/interface.h>
 #include <base/Base.hh>
 #include <util/number.h>
+#include <util/time/FrameProfiler.hh>
 
 #if defined(CONFIG_RESOURCE_IMAGE)
 #include <resource2/image/ResourceImage.h>
@@ -49,6 +50,7 @@ TimedMotion<GC> projAngleM;
 
 #include "settings.h"
 #include "transforms.hh"
+#include "drawList.hh"
 
 #include "geometry.hh"
 #include "texture.hh"
@@ -64,6 +66,10 @@ void setActiveTexture(GfxTextureHandle texture, uint type)
 	#if !defined(CONFIG_GFX_OPENGL_TEXTURE_EXTERNAL_OES)
 	type = GL_TEXTURE_2D;
 	#endif
+	texState = texture;
+	texTypeState = type;
+	if(drawListQuads)
+		return; // bound by the flush once the queued quads are drawn
 	if(texture != 0)
 	{
 		#if defined(CONFIG_GFX_OPENGL_TEXTURE_EXTERNAL_OES)
@@ -89,6 +95,7 @@ void setActiveTexture(GfxTextureHandle texture, uint type)
 
 void setZTest(bool on)
 {
+	flushDrawList();
 	if(on)
 	{
 		glcEnable(GL_DEPTH_TEST);
@@ -103,6 +110,7 @@ void setZTest(bool on)
 
 void setBlendMode(uint mode)
 {
+	blendModeState = mode;
 	switch(mode)
 	{
 		bcase BLEND_MODE_OFF:
@@ -119,6 +127,7 @@ void setBlendMode(uint mode)
 
 void setImgMode(uint mode)
 {
+	imgModeState = mode;
 	switch(mode)
 	{
 		bcase IMG_MODE_REPLACE: glcTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
@@ -130,6 +139,7 @@ void setImgMode(uint mode)
 
 void setBlendEquation(uint mode)
 {
+	flushDrawList();
 #if !defined CONFIG_GFX_OPENGL \
 	|| (defined CONFIG_BASE_IOS || defined CONFIG_BASE_ANDROID || defined CONFIG_BASE_PS3)
 	glcBlendEquation(mode == BLEND_EQ_ADD ? GL_FUNC_ADD :
@@ -141,12 +151,14 @@ void setBlendEquation(uint mode)
 
 void setImgBlendColor(GColor r, GColor g, GColor b, GColor a)
 {
+	flushDrawList();
 	GLfloat col[4] = { r, g, b, a } ;
 	glcTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, col);
 }
 
 void setZBlend(uchar on)
 {
+	flushDrawList();
 	if(on)
 	{
 		#ifndef CONFIG_GFX_OPENGL_ES
@@ -168,6 +180,7 @@ void setZBlend(uchar on)
 
 void setZBlendColor(GColor r, GColor g, GColor b)
 {
+	flushDrawList();
 	GLfloat c[4] = {r, g, b, 1.0f};
 	glFogfv(GL_FOG_COLOR, c);
 }
@@ -184,6 +197,7 @@ uint color()
 
 void setVisibleGeomFace(uint faces)
 {
+	flushDrawList();
 	if(faces == BOTH_FACES)
 	{
 		glcDisable(GL_CULL_FACE);
@@ -209,6 +223,7 @@ namespace Gfx
 
 void setClipRect(bool on)
 {
+	flushDrawList();
 	if(on)
 		glcEnable(GL_SCISSOR_TEST);
 	else
@@ -217,6 +232,7 @@ void setClipRect(bool on)
 
 void setClipRectBounds(int x, int y, int w, int h)
 {
+	flushDrawList();
 	#ifdef CONFIG_GFX_SOFT_ORIENTATION
 	switch(rotateView)
 	{
@@ -51,6 +51,7 @@ static float zRange = 1000.0;
 
 static void resizeGLScene(const Base::Window &win)
 {
+	flushDrawList();
 	auto width = win.rect.xSize();
 	auto height = win.rect.ySize();
 	logMsg("glViewport %d:%d:%d:%d from window %d:%d:%d:%d (%d,%d)", win.rect.x, win.h - win.rect.y2, width, height,
@@ -383,6 +384,30 @@ static void checkForVBO(const char *version, bool hasGL1_5)
 	}
 }
 
+#ifdef CONFIG_GFX_OPENGL_BUFFER_STREAM
+
+static uchar useStreamPBO = 0;
+static uchar forceNoStreamPBO = 0;
+static uchar usePersistentBufferMap = 0;
+static uchar forceNoPersistentBufferMap = 0;
+
+static void checkForStreamPBO(const char *extensions, bool hasGL3_0)
+{
+	if(!forceNoStreamPBO && (hasGL3_0 ||
+		(strstr(extensions, "GL_ARB_pixel_buffer_object") && strstr(extensions, "GL_ARB_map_buffer_range"))))
+	{
+		useStreamPBO = 1;
+		logMsg("streaming textures through PBOs");
+		if(!forceNoPersistentBufferMap && strstr(extensions, "GL_ARB_buffer_storage"))
+		{
+			usePersistentBufferMap = 1;
+			logMsg("persistent buffer mapping is supported");
+		}
+	}
+}
+
+#endif
+
 #if defined CONFIG_BASE_ANDROID && defined CONFIG_GFX_OPENGL_USE_DRAW_TEXTURE
 
 static bool useDrawTex = 0;
@@ -621,6 +646,7 @@ namespace Gfx
 
 void setDither(uint on)
 {
+	flushDrawList();
 	if(on)
 		glcEnable(GL_DITHER);
 	else
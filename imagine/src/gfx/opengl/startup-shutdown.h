@@ -95,6 +95,9 @@ CallResult setOutputVideoMode(const Base::Window &win)
 	checkForCompressedTexturesSupport(hasGL1_3);
 	checkForFBOFuncs(extensions);
 	checkForVBO(version, hasGL1_5);
+	#ifdef CONFIG_GFX_OPENGL_BUFFER_STREAM
+	checkForStreamPBO(extensions, majorVer >= 3);
+	#endif
 	if(useFBOFuncs) useAutoMipmapGeneration = 0; // prefer FBO mipmap function if present
 
 	/*#ifdef CONFIG_GFX_OPENGL_ES
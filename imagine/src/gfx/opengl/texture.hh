@@ -4,6 +4,9 @@
 #if defined(CONFIG_GFX_OPENGL_TEXTURE_EXTERNAL_OES)
 	#include "android/SurfaceTextureBufferImage.hh"
 #endif
+#if defined(CONFIG_GFX_OPENGL_BUFFER_STREAM)
+	#include "StreamTextureBufferImage.hh"
+#endif
 
 namespace Gfx
 {
@@ -225,7 +228,7 @@ static void setDefaultImageTextureParams(uint imgFilter, uchar mipmapType, int x
 	//glTexParameterfv(target, GL_TEXTURE_BORDER_COLOR, col);
 }
 
-static uint writeGLTexture(Pixmap &pix, bool includePadding, GLenum target)
+static uint writeGLTexture(Pixmap &pix, bool includePadding, GLenum target, uint xOffset = 0, uint yOffset = 0)
 {
 	//logMsg("writeGLTexture");
 	uint alignment = setUnpackAlignForPitch(pix.pitch);
@@ -237,7 +240,7 @@ static uint writeGLTexture(Pixmap &pix, bool includePadding, GLenum target)
 		glcPixelStorei(GL_UNPACK_ROW_LENGTH, (!includePadding && pix.isPadded()) ? pix.pitchPixels() : 0);
 		//logMsg("writing %s %dx%d to %dx%d, xline %d", glImageFormatToString(format), 0, 0, pix->x, pix->y, pix->pitch / pix->format->bytesPerPixel);
 		clearGLError();
-		glTexSubImage2D(target, 0, 0, 0,
+		glTexSubImage2D(target, 0, xOffset, yOffset,
 				xSize, pix.y, format, dataType, pix.data);
 		glErrorCase(err)
 		{
@@ -249,7 +252,7 @@ static uint writeGLTexture(Pixmap &pix, bool includePadding, GLenum target)
 		if(includePadding || pix.pitch == pix.x * pix.format.bytesPerPixel)
 		{
 			//logMsg("pitch equals x size optimized case");
-			glTexSubImage2D(target, 0, 0, 0,
+			glTexSubImage2D(target, 0, xOffset, yOffset,
 					xSize, pix.y, format, dataType, pix.data);
 			glErrorCase(err)
 			{
@@ -263,7 +266,7 @@ static uint writeGLTexture(Pixmap &pix, bool includePadding, GLenum target)
 			uchar *row = pix.data;
 			for(int y = 0; y < (int)pix.y; y++)
 			{
-				glTexSubImage2D(target, 0, 0, y,
+				glTexSubImage2D(target, 0, xOffset, yOffset + y,
 						pix.x, 1, format, dataType, row);
 				glErrorCase(err)
 				{
@@ -333,6 +336,7 @@ void BufferImage::setFilter(uint filter)
 	#else
 	GLenum target = textureDesc().target;
 	#endif
+	Gfx::flushDrawList();
 	Gfx::setActiveTexture(textureDesc().tid, target);
 	glTexParameteri(target, GL_TEXTURE_MAG_FILTER, filterGL);
 	glTexParameteri(target, GL_TEXTURE_MIN_FILTER, filterGL);
@@ -345,6 +349,7 @@ void BufferImage::setRepeatMode(uint xMode, uint yMode)
 	#else
 	GLenum target = textureDesc().target;
 	#endif
+	Gfx::flushDrawList();
 	Gfx::setActiveTexture(textureDesc().tid, target);
 	glTexParameteri(target, GL_TEXTURE_WRAP_S, xMode ? GL_REPEAT : GL_CLAMP_TO_EDGE);
 	glTexParameteri(target, GL_TEXTURE_WRAP_T, yMode ? GL_REPEAT : GL_CLAMP_TO_EDGE);
@@ -376,6 +381,134 @@ void TextureBufferImage::deinit()
 	tid = 0;
 }
 
+#ifdef CONFIG_GFX_OPENGL_BUFFER_STREAM
+
+bool StreamTextureBufferImage::init(const Pixmap &texPix)
+{
+	new(&lockPix) Pixmap(texPix.format);
+	bufferSize = texPix.x * texPix.y * texPix.format.bytesPerPixel;
+	glGenBuffers(buffers, pbo);
+	iterateTimes(buffers, i)
+	{
+		glState_bindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, pbo[i]);
+		clearGLError();
+		if(usePersistentBufferMap)
+		{
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_PIXEL_UNPACK_BUFFER_ARB, bufferSize, nullptr, flags);
+			mapped[i] = (uchar*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER_ARB, 0, bufferSize, flags);
+		}
+		else
+			glBufferData(GL_PIXEL_UNPACK_BUFFER_ARB, bufferSize, nullptr, GL_STREAM_DRAW);
+		glErrorCase(err)
+		{
+			logErr("%s creating %d byte pixel buffer", glErrorToString(err), bufferSize);
+			glState_bindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+			deinitBuffers();
+			return 0;
+		}
+	}
+	glState_bindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+	logMsg("streaming texture through %d %s pixel buffers of %d bytes", buffers,
+		usePersistentBufferMap ? "persistent" : "orphaned", bufferSize);
+	return 1;
+}
+
+void StreamTextureBufferImage::write(Pixmap &p, uint hints)
+{
+	Pixmap *dest = lock(0, 0, p.x, p.y);
+	if(!dest)
+	{
+		TextureBufferImage::write(p, hints);
+		return;
+	}
+	p.copy(0, 0, 0, 0, dest, 0, 0);
+	unlock(dest, hints);
+}
+
+Pixmap *StreamTextureBufferImage::lock(uint x, uint y, uint xlen, uint ylen, Pixmap *fallback)
+{
+	if(x || y || xlen * ylen * lockPix.format.bytesPerPixel > bufferSize)
+		return fallback;
+	uchar *data;
+	if(usePersistentBufferMap)
+	{
+		// the GPU should have long finished with a buffer by the time the ring wraps
+		if(fence[bufferIdx])
+		{
+			glClientWaitSync(fence[bufferIdx], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+			glDeleteSync(fence[bufferIdx]);
+			fence[bufferIdx] = nullptr;
+		}
+		data = mapped[bufferIdx];
+	}
+	else
+	{
+		// invalidating orphans the old storage so mapping never waits on a pending upload
+		glState_bindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, pbo[bufferIdx]);
+		data = (uchar*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER_ARB, 0, bufferSize,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		glState_bindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+		if(!data)
+		{
+			logErr("error mapping pixel buffer");
+			return fallback;
+		}
+	}
+	lockPix.init(data, xlen, ylen);
+	return &lockPix;
+}
+
+void StreamTextureBufferImage::unlock(Pixmap *pix, uint hints)
+{
+	if(pix != &lockPix)
+	{
+		if(pix)
+			TextureBufferImage::write(*pix, hints); // lock() returned the fallback
+		return;
+	}
+	glState_bindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, pbo[bufferIdx]);
+	if(!usePersistentBufferMap)
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB);
+	glcBindTexture(GL_TEXTURE_2D, tid);
+	setUnpackAlignForPitch(lockPix.pitch);
+	glcPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	clearGLError();
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, lockPix.x, lockPix.y,
+		pixelFormatToOGLFormat(lockPix.format), pixelFormatToOGLDataType(lockPix.format), nullptr);
+	glErrorCase(err)
+	{
+		logErr("%s in glTexSubImage2D from pixel buffer", glErrorToString(err));
+	}
+	glState_bindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+	if(usePersistentBufferMap)
+		fence[bufferIdx] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	bufferIdx = (bufferIdx + 1) % buffers;
+}
+
+void StreamTextureBufferImage::deinitBuffers()
+{
+	iterateTimes(buffers, i)
+	{
+		if(fence[i])
+		{
+			glDeleteSync(fence[i]);
+			fence[i] = nullptr;
+		}
+		mapped[i] = nullptr; // unmapped when the buffer is deleted
+	}
+	glDeleteBuffers(buffers, pbo);
+	mem_zero(pbo);
+}
+
+void StreamTextureBufferImage::deinit()
+{
+	deinitBuffers();
+	TextureBufferImage::deinit();
+}
+
+#endif
+
 bool BufferImage::setupTexture(Pixmap &pix, bool upload, uint internalFormat, int xWrapType, int yWrapType,
 	uint usedX, uint usedY, uint hints, uint filter)
 {
@@ -478,6 +611,20 @@ bool BufferImage::setupTexture(Pixmap &pix, bool upload, uint internalFormat, in
 	}
 	#endif
 
+	#ifdef CONFIG_GFX_OPENGL_BUFFER_STREAM
+	if((hints & BufferImage::HINT_STREAM) && useStreamPBO)
+	{
+		auto *streamTex = new StreamTextureBufferImage;
+		if(streamTex->init(pix))
+			impl = streamTex;
+		else
+		{
+			logWarn("failed to create pixel buffers, falling back to normal texture");
+			delete streamTex;
+		}
+	}
+	if(!impl)
+	#endif
 	#ifdef CONFIG_GFX_OPENGL_BUFFER_IMAGE_MULTI_IMPL
 		impl = new TextureBufferImage;
 	#endif
@@ -595,19 +742,59 @@ CallResult BufferImage::init(Pixmap &pix, bool upload, uint filter, uint hints,
 	return OK;
 }
 
-void BufferImage::write(Pixmap &p) { BufferImageImpl::write(p, hints); }
+void BufferImage::write(Pixmap &p)
+{
+	profileZone(ZONE_UPLOAD);
+	BufferImageImpl::write(p, hints);
+}
 void BufferImage::replace(Pixmap &p)
 {
 	BufferImageImpl::replace(p, hints);
 }
 void BufferImage::unlock(Pixmap *p) { BufferImageImpl::unlock(p, hints); }
 
+void BufferImage::writeSubImage(Pixmap &p, uint x, uint y)
+{
+	profileZone(ZONE_UPLOAD);
+	glcBindTexture(GL_TEXTURE_2D, textureDesc().tid);
+	writeGLTexture(p, 0, GL_TEXTURE_2D, x, y);
+}
+
+CallResult BufferImage::initSubImage(const BufferImage &parent, GTexC leftTexU, GTexC topTexV, GTexC rightTexU, GTexC bottomTexV)
+{
+	if(isInit())
+		deinit();
+	#ifdef CONFIG_GFX_OPENGL_BUFFER_IMAGE_MULTI_IMPL
+	impl = new TextureBufferImage;
+	if(!impl)
+		return OUT_OF_MEMORY;
+	#endif
+	isSubImage = 1;
+	textureDesc().tid = parent.textureDesc().tid;
+	textureDesc().xStart = leftTexU;
+	textureDesc().yStart = topTexV;
+	textureDesc().xEnd = rightTexU;
+	textureDesc().yEnd = bottomTexV;
+	return OK;
+}
+
 void BufferImage::deinit()
 {
 	if(!isInit())
 		return;
 
-	if(backingImg)
+	if(isSubImage)
+	{
+		// texture belongs to the parent image
+		#ifdef CONFIG_GFX_OPENGL_BUFFER_IMAGE_MULTI_IMPL
+		delete impl;
+		impl = nullptr;
+		#else
+		tid = 0;
+		#endif
+		isSubImage = 0;
+	}
+	else if(backingImg)
 	{
 		logMsg("deinit via backing texture resource");
 		backingImg->deinit(); // backingImg set to 0 before real deinit
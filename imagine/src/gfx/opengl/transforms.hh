@@ -3,33 +3,87 @@
 namespace Gfx
 {
 
+// copy of the model-view matrix so queued draws can be transformed on the CPU
+static Matrix4x4<GLfloat> modelMat {{{ 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 }}};
+static bool transformTargetIsTexture = 0;
+
 void setTransformTarget(TransformTargetEnum target)
 {
+	if(target == TARGET_TEXTURE)
+		flushDrawList();
+	transformTargetIsTexture = target == TARGET_TEXTURE;
 	glcMatrixMode(target == TARGET_TEXTURE ? GL_TEXTURE : GL_MODELVIEW);
 }
 
+// post-multiplies columns a & b of the model matrix by a rotation of t degrees
+static void rotateModelMat(uint a, uint b, Angle t)
+{
+	GLfloat c = IG::cos(IG::toRadians(t)), s = IG::sin(IG::toRadians(t));
+	GLfloat *v = modelMat.v;
+	iterateTimes(4, i)
+	{
+		GLfloat colA = v[a*4 + i], colB = v[b*4 + i];
+		v[a*4 + i] = colA * c + colB * s;
+		v[b*4 + i] = colB * c - colA * s;
+	}
+}
+
 void applyTranslate(TransformCoordinate x, TransformCoordinate y, TransformCoordinate z)
 {
+	if(transformTargetIsTexture)
+		flushDrawList();
+	else
+	{
+		GLfloat *v = modelMat.v;
+		iterateTimes(4, i)
+		{
+			v[12 + i] += v[i] * x + v[4 + i] * y + v[8 + i] * z;
+		}
+	}
 	glTranslatef(x, y, z);
 }
 
 void applyScale(TransformCoordinate sx, TransformCoordinate sy, TransformCoordinate sz)
 {
+	if(transformTargetIsTexture)
+		flushDrawList();
+	else
+	{
+		GLfloat *v = modelMat.v;
+		iterateTimes(4, i)
+		{
+			v[i] *= sx;
+			v[4 + i] *= sy;
+			v[8 + i] *= sz;
+		}
+	}
 	glScalef(sx, sy, sz);
 }
 
 void applyPitchRotate(Angle t)
 {
+	if(transformTargetIsTexture)
+		flushDrawList();
+	else
+		rotateModelMat(1, 2, t);
 	glRotatef(t, (Angle)1, (Angle)0, (Angle)0);
 }
 
 void applyRollRotate(Angle t)
 {
+	if(transformTargetIsTexture)
+		flushDrawList();
+	else
+		rotateModelMat(0, 1, t);
 	glRotatef(t, (Angle)0, (Angle)0, (Angle)1);
 }
 
 void applyYawRotate(Angle t)
 {
+	if(transformTargetIsTexture)
+		flushDrawList();
+	else
+		rotateModelMat(2, 0, t);
 	glRotatef(t, (Angle)0, (Angle)1, (Angle)0);
 }
 
@@ -37,11 +91,19 @@ void loadTranslate(TransformCoordinate x, TransformCoordinate y, TransformCoordi
 {
 	Matrix4x4<float> mat;
 	mat.translate(x, y, z);
+	if(transformTargetIsTexture)
+		flushDrawList();
+	else
+		modelMat = mat;
 	glLoadMatrixf((GLfloat *)&mat.v[0]);
 }
 
 void loadIdentTransform()
 {
+	if(transformTargetIsTexture)
+		flushDrawList();
+	else
+		modelMat.ident();
 	glLoadIdentity();
 }
 
@@ -99,6 +99,7 @@ void FSPicker::init(const char *path, ResourceImage *backRes, ResourceImage *clo
 	singleDir = 1; // stay in Documents dir when not in jailbreak environment
 	#endif
 	text = 0;
+	tbl.cells = 0;
 	faceRes = face;
 	var_selfs(filter);
 	var_selfs(singleDir);
@@ -109,7 +110,13 @@ void FSPicker::init(const char *path, ResourceImage *backRes, ResourceImage *clo
 void FSPicker::deinit()
 {
 	dir.closeDir();
-	delete[] text;
+	iterateTimes(tbl.cells, i)
+	{
+		text[i].deinit();
+	}
+	mem_freeSafe(text);
+	text = nullptr;
+	textCapacity = 0;
 	navV.deinit();
 	tbl.cells = 0;
 }
@@ -120,18 +127,25 @@ void FSPicker::place()
 	{
 		text[i].compile();
 	}
+	placeViews();
+}
 
-	tbl.setYCellSize(faceRes->nominalHeight()*2);
-
+void FSPicker::placeViews()
+{
 	//logMsg("setting viewRect");
 	navV.viewRect.setPosRel(viewFrame.x, viewFrame.y, viewFrame.xSize(), faceRes->nominalHeight() * 1.75, LT2DO);
+	placeTable();
+	navV.place();
+}
+
+void FSPicker::placeTable()
+{
+	tbl.setYCellSize(faceRes->nominalHeight()*2);
 	Rect2<int> tableFrame = viewFrame;
 	tableFrame.setYPos(navV.viewRect.yPos(LB2DO));
 	tableFrame.y2 -= navV.viewRect.ySize();
 	tbl.place(&tableFrame);
 	//logMsg("nav %d, table %d, content %d", gfx_toIYSize(navV.view.ySize), tbl.viewFrame.ySize(), tbl.contentFrame->ySize());
-
-	navV.place();
 }
 
 void FSPicker::changeDirByInput(const char *path, const Input::Event &e)
@@ -212,12 +226,12 @@ void FSPicker::onSelectElement(const GuiTable1D *table, const Input::Event &e, u
 	}
 }
 
-void FSPicker::loadDir(const char *path)
+void FSPicker::loadEntries()
 {
-	assert(path);
-	FsSys::chdir(path);
-	dir.openDir(".", 0, filter);
-	logMsg("%d entries", dir.numEntries());
+	iterateTimes(tbl.cells, i)
+	{
+		text[i].deinit();
+	}
 	if(dir.numEntries())
 	{
 		// TODO free old pointer on failure
@@ -227,11 +241,82 @@ void FSPicker::loadDir(const char *path)
 			logMsg("out of memory loading directory");
 			Base::exit(); // TODO: handle without exiting
 		}
+		textCapacity = dir.numEntries();
 		iterateTimes(dir.numEntries(), i)
 		{
 			text[i].init(dir.entryFilename(i), 1, faceRes);
 		}
 	}
+}
+
+#ifdef CONFIG_FS_POSIX
+static int compareItemName(const void *i1, const void *i2)
+{
+	return strcmp(((const TextMenuItem*)i1)->t.str, ((const TextMenuItem*)i2)->t.str);
+}
+
+void FSPicker::onDirUpdate(DirScanner &)
+{
+	// entry names keep their address, so the selection can follow its entry
+	const char *selectedName = tbl.selected >= 0 && tbl.selected < tbl.cells ?
+		text[tbl.selected].t.str : nullptr;
+	// new entries are appended while scanning, so only those need items
+	uint oldCells = tbl.cells, cells = dir.numEntries();
+	if(cells > textCapacity)
+	{
+		uint newCapacity = IG::max(cells, textCapacity * 2);
+		// realloc() would re-construct the existing items
+		auto newText = (TextMenuItem*)mem_realloc(text, newCapacity * sizeof(TextMenuItem));
+		if(!newText)
+		{
+			logMsg("out of memory loading directory");
+			Base::exit(); // TODO: handle without exiting
+		}
+		text = newText;
+		textCapacity = newCapacity;
+	}
+	for(uint i = oldCells; i < cells; i++)
+	{
+		new(&text[i]) TextMenuItem();
+		text[i].init(dir.entryFilename(i), 1, faceRes);
+		text[i].compile();
+	}
+	if(!dir.isScanning())
+	{
+		// the final update sorts the entries, put the items in the same order
+		qsort(text, cells, sizeof(TextMenuItem), compareItemName);
+	}
+	tbl.cells = cells;
+	if(selectedName && !dir.isScanning())
+	{
+		iterateTimes(dir.numEntries(), i)
+		{
+			if(dir.entryFilename(i) == selectedName)
+			{
+				tbl.selected = i;
+				break;
+			}
+		}
+	}
+	else if(!Input::SUPPORTS_POINTER && tbl.cells && tbl.selected < 0)
+		tbl.selected = 0;
+	logMsg("%d entries%s", dir.numEntries(), dir.isScanning() ? " so far" : "");
+	placeTable();
+	Base::displayNeedsUpdate();
+}
+#endif
+
+void FSPicker::loadDir(const char *path)
+{
+	assert(path);
+	FsSys::chdir(path);
+	#ifdef CONFIG_FS_POSIX
+	dir.openDir(FsSys::workDir(), filter, DirScanner::OnUpdateDelegate::create<FSPicker, &FSPicker::onDirUpdate>(this));
+	#else
+	dir.openDir(".", 0, filter);
+	#endif
+	logMsg("%d entries", dir.numEntries());
+	loadEntries();
 	tbl.init(this, dir.numEntries());
 	#if defined(CONFIG_BASE_IOS) && !defined(CONFIG_BASE_IOS_JB)
 	navV.setTitle("Documents");
@@ -6,6 +6,9 @@
 #include <util/rectangle2.h>
 #include <input/Input.hh>
 #include <fs/sys.hh>
+#ifdef CONFIG_FS_POSIX
+#include <fs/posix/DirScanner.hh>
+#endif
 #include <resource2/face/ResourceFace.hh>
 #include <gui/GuiTable1D/GuiTable1D.hh>
 #include <gui/MenuItem/MenuItem.hh>
@@ -64,7 +67,12 @@ public:
 	ScrollableGuiTable1D tbl;
 private:
 	TextMenuItem *text = nullptr;
+	uint textCapacity = 0;
+	#ifdef CONFIG_FS_POSIX
+	DirScanner dir;
+	#else
 	FsSys dir;
+	#endif
 	Rect2<int> viewFrame;
 	ResourceFace *faceRes = nullptr;
 	FSNavView navV { NavView::OnInputDelegate::create<FSPicker, &FSPicker::onLeftNavBtn>(this),
@@ -72,5 +80,11 @@ private:
 	bool singleDir = 0;
 
 	void loadDir(const char *path);
+	void loadEntries();
+	void placeViews();
+	void placeTable();
+	#ifdef CONFIG_FS_POSIX
+	void onDirUpdate(DirScanner &scanner);
+	#endif
 	void changeDirByInput(const char *path, const Input::Event &e);
 };
@@ -0,0 +1,275 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "io:archiveCache"
+#include "ArchiveCache.hh"
+#include <io/sys.hh>
+#include <fs/sys.hh>
+#include <logger/interface.h>
+#include <util/strings.h>
+#include <sys/stat.h>
+#include <utime.h>
+#include <time.h>
+
+namespace ArchiveCache
+{
+
+struct Entry
+{
+	char name[24];
+	ulong size;
+	time_t mTime;
+};
+
+// stored in the .meta file next to each cached file, followed by the
+// name of the extracted file within the archive
+struct MetaHeader
+{
+	uint64 archiveSize;
+	int64 archiveMTime;
+	int64 cacheTime;
+	uint64 archiveHash;
+};
+
+static FsSys::cPath cacheDir {0};
+static ulong maxSize = 512 * 1024 * 1024;
+static const uint maxEntries = 256;
+
+void setPath(const char *path)
+{
+	string_copy(cacheDir, path);
+	FsSys::mkdir(path);
+	logMsg("cache path %s", path);
+}
+
+void setMaxSize(ulong bytes)
+{
+	maxSize = bytes;
+}
+
+// multiply & xor-shift over 8-byte words, runs near memory bandwidth
+static uint64 hashData(const uchar *data, size_t size, uint64 seed = 0)
+{
+	uint64 hash = 0x9E3779B97F4A7C15ULL ^ seed ^ size;
+	size_t words = size / 8;
+	iterateTimes(words, i)
+	{
+		uint64 word;
+		memcpy(&word, &data[i * 8], 8);
+		hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+		hash ^= hash >> 32;
+	}
+	iterateTimes(size % 8, i)
+	{
+		hash = (hash ^ data[words * 8 + i]) * 0xC4CEB9FE1A85EC53ULL;
+	}
+	return hash ^ (hash >> 29);
+}
+
+static int isCacheFile(const char *name, int type)
+{
+	return type == Fs::TYPE_FILE && string_hasDotExtension(name, "bin");
+}
+
+static void removeEntry(const char *name)
+{
+	FsSys::cPath path;
+	string_printf(path, "%s/%s", cacheDir, name);
+	FsSys::remove(path);
+	// matching file with the archive's metadata
+	strcpy(&path[strlen(path) - 3], "meta");
+	FsSys::remove(path);
+}
+
+// deletes the least recently used entries until the cache fits in maxSize
+static void trim(const char *keepName)
+{
+	FsSys dir;
+	if(dir.openDir(cacheDir, Fs::OPEN_UNSORT, isCacheFile) != OK)
+		return;
+	static Entry entry[maxEntries];
+	uint entries = 0;
+	ulong totalSize = 0;
+	iterateTimes(IG::min(dir.numEntries(), maxEntries), i)
+	{
+		FsSys::cPath path;
+		string_printf(path, "%s/%s", cacheDir, dir.entryFilename(i));
+		struct stat s;
+		if(stat(path, &s) != 0)
+			continue;
+		auto &e = entry[entries++];
+		string_copy(e.name, dir.entryFilename(i));
+		e.size = s.st_size;
+		e.mTime = s.st_mtime;
+		totalSize += e.size;
+	}
+	dir.closeDir();
+	while(totalSize > maxSize)
+	{
+		Entry *oldest = nullptr;
+		iterateTimes(entries, i)
+		{
+			if(entry[i].size && !string_equal(entry[i].name, keepName)
+				&& (!oldest || entry[i].mTime < oldest->mTime))
+				oldest = &entry[i];
+		}
+		if(!oldest)
+			break;
+		logMsg("removing %s from cache", oldest->name);
+		removeEntry(oldest->name);
+		totalSize -= oldest->size;
+		oldest->size = 0;
+	}
+}
+
+static bool writeAtomic(const char *path, const void *data, size_t size)
+{
+	FsSys::cPath tempPath;
+	string_printf(tempPath, "%s.tmp", path);
+	if(IoSys::writeToNewFile(tempPath, (void*)data, size) != OK
+		|| FsSys::rename(tempPath, path) != OK)
+	{
+		logErr("error writing %s", tempPath);
+		FsSys::remove(tempPath);
+		return 0;
+	}
+	return 1;
+}
+
+static uint64 hashArchive(const char *path)
+{
+	Io *io = IoSys::open(path);
+	if(!io)
+		return 0;
+	uint64 hash = 0;
+	if(auto data = io->mmapConst())
+		hash = hashData(data, io->size());
+	delete io;
+	return hash;
+}
+
+// returns the cached file if its metadata matches the archive's current state
+static Io *openCached(const char *path, const char *metaPath, const char *archivePath,
+	const struct stat &archiveStat, char *nameOut, uint nameOutSize)
+{
+	struct
+	{
+		MetaHeader header;
+		FsSys::cPath name;
+	} meta;
+	uint metaSize = IoSys::readFromFile(metaPath, &meta, sizeof(meta) - 1);
+	if(metaSize <= sizeof(MetaHeader)
+		|| meta.header.archiveSize != (uint64)archiveStat.st_size
+		|| meta.header.archiveMTime != (int64)archiveStat.st_mtime)
+		return nullptr;
+	if(meta.header.archiveMTime >= meta.header.cacheTime)
+	{
+		// archive was modified in the same second it was cached, so mtime can't
+		// prove it's unchanged since, compare the contents
+		logMsg("verifying contents of %s", archivePath);
+		if(hashArchive(archivePath) != meta.header.archiveHash)
+			return nullptr;
+	}
+	if(nameOut)
+	{
+		meta.name[metaSize - sizeof(MetaHeader)] = 0;
+		string_copy(nameOut, meta.name, nameOutSize);
+	}
+	Io *io = IoSys::open(path);
+	if(!io)
+		return nullptr;
+	utime(path, nullptr); // mark as recently used
+	return io;
+}
+
+static void add(Io *io, const char *path, const char *metaPath, const struct stat &archiveStat,
+	uint64 archiveHash, const char *entryName)
+{
+	auto data = io->mmapConst();
+	if(!data)
+		return;
+	// metadata goes last, so an entry is only used once both files are complete
+	if(!writeAtomic(path, data, io->size()))
+		return;
+	uint nameSize = strlen(entryName);
+	uchar meta[sizeof(MetaHeader) + sizeof(FsSys::cPath)];
+	MetaHeader header {(uint64)archiveStat.st_size, (int64)archiveStat.st_mtime, (int64)time(nullptr), archiveHash};
+	memcpy(meta, &header, sizeof(header));
+	memcpy(&meta[sizeof(header)], entryName, nameSize);
+	if(!writeAtomic(metaPath, meta, sizeof(header) + nameSize))
+	{
+		FsSys::remove(path);
+		return;
+	}
+	logMsg("cached %d bytes as %s", (int)io->size(), path);
+}
+
+Io *open(const char *path, IoArchive::EntryFilter filter, const char *filterId, char *nameOut, uint nameOutSize)
+{
+	if(!strlen(cacheDir))
+		return IoArchive::open(path, filter, nameOut, nameOutSize);
+	struct stat archiveStat;
+	if(stat(path, &archiveStat) != 0)
+		return nullptr;
+
+	// a different filter may pick a different file from the same archive
+	uint64 key = hashData((const uchar*)path, strlen(path),
+		hashData((const uchar*)filterId, strlen(filterId)));
+	char name[24];
+	string_printf(name, "%016llx.bin", (unsigned long long)key);
+	FsSys::cPath cachePath, metaPath;
+	string_printf(cachePath, "%s/%s", cacheDir, name);
+	string_printf(metaPath, "%s/%.16s.meta", cacheDir, name);
+	if(FsSys::fileExists(cachePath))
+	{
+		if(Io *io = openCached(cachePath, metaPath, path, archiveStat, nameOut, nameOutSize))
+		{
+			logMsg("opened cached copy of %s", path);
+			return io;
+		}
+	}
+
+	Io *archiveIo = IoSys::open(path);
+	if(!archiveIo)
+		return nullptr;
+	auto archiveData = archiveIo->mmapConst();
+	if(!archiveData)
+	{
+		delete archiveIo;
+		return IoArchive::open(path, filter, nameOut, nameOutSize);
+	}
+	uint64 archiveHash = hashData(archiveData, archiveIo->size());
+	FsSys::cPath entryName;
+	Io *io = IoArchive::openMemory(archiveData, archiveIo->size(), filter, entryName, sizeof(entryName));
+	delete archiveIo;
+	if(!io)
+		return nullptr;
+	if(nameOut)
+		string_copy(nameOut, entryName, nameOutSize);
+	add(io, cachePath, metaPath, archiveStat, archiveHash, entryName);
+	trim(name);
+	return io;
+}
+
+Io *openFile(const char *path, IoArchive::EntryFilter filter, const char *filterId, char *nameOut, uint nameOutSize)
+{
+	if(IoArchive::hasArchiveExtension(path))
+		return open(path, filter, filterId, nameOut, nameOutSize);
+	if(nameOut && nameOut != path)
+		string_copy(nameOut, path, nameOutSize);
+	return IoSys::open(path);
+}
+
+}
@@ -0,0 +1,44 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#pragma once
+
+#include <engine-globals.h>
+#include <io/archive/IoArchive.hh>
+
+// On-disk cache of files extracted from archives. Entries are keyed by the
+// archive's path & the filter choosing the file, and are only used while the
+// archive's size & modification time still match, so a hit costs a stat()
+// and is opened as a memory-mapped file instead of being decompressed again.
+// The least recently used entries are deleted once the cache grows past its
+// size limit.
+namespace ArchiveCache
+{
+
+// the cache is disabled until a directory is set, it's created if needed
+void setPath(const char *path);
+void setMaxSize(ulong bytes);
+
+// same as IoArchive::open(), but returns the cached copy if one exists,
+// otherwise the extracted file is added to the cache, filterId must name
+// filter uniquely & stay the same between runs since it's part of the key
+Io *open(const char *path, IoArchive::EntryFilter filter, const char *filterId,
+	char *nameOut = nullptr, uint nameOutSize = 0);
+
+// opens path directly if it's not an archive
+Io *openFile(const char *path, IoArchive::EntryFilter filter, const char *filterId,
+	char *nameOut = nullptr, uint nameOutSize = 0);
+
+}
@@ -0,0 +1,154 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "io:archive"
+#include "IoArchive.hh"
+#include <io/mmap/generic/IoMmapGeneric.hh>
+#include <logger/interface.h>
+#include <mem/interface.h>
+#include <util/strings.h>
+#include <archive.h>
+#include <archive_entry.h>
+
+static archive *newReader()
+{
+	auto arch = archive_read_new();
+	if(!arch)
+		return nullptr;
+	archive_read_support_format_zip(arch);
+	archive_read_support_format_7zip(arch);
+	return arch;
+}
+
+static Io *readEntry(archive *arch, archive_entry *entry)
+{
+	// the size can be missing from the header of a streamed zip
+	size_t size = archive_entry_size_is_set(entry) ? archive_entry_size(entry) : 0;
+	size_t capacity = size ? size : 0x10000, pos = 0;
+	auto data = (uchar*)mem_alloc(capacity);
+	if(!data)
+	{
+		logErr("out of memory for %d byte file", (int)capacity);
+		return nullptr;
+	}
+	for(;;)
+	{
+		if(pos == capacity)
+		{
+			if(size)
+				break;
+			auto newData = (uchar*)mem_realloc(data, capacity * 2);
+			if(!newData)
+			{
+				logErr("out of memory for %d byte file", (int)capacity * 2);
+				mem_free(data);
+				return nullptr;
+			}
+			data = newData;
+			capacity *= 2;
+		}
+		auto bytes = archive_read_data(arch, data + pos, capacity - pos);
+		if(bytes < 0)
+		{
+			logErr("error extracting: %s", archive_error_string(arch));
+			mem_free(data);
+			return nullptr;
+		}
+		if(!bytes)
+			break;
+		pos += bytes;
+	}
+	auto io = (IoMmapGeneric*)IoMmapGeneric::open(data, pos);
+	if(!io)
+	{
+		mem_free(data);
+		return nullptr;
+	}
+	io->memFreeFunc(mem_free);
+	return io;
+}
+
+static Io *extract(archive *arch, IoArchive::EntryFilter filter, char *nameOut, uint nameOutSize)
+{
+	Io *io = nullptr;
+	archive_entry *entry;
+	while(archive_read_next_header(arch, &entry) == ARCHIVE_OK)
+	{
+		if(archive_entry_filetype(entry) != AE_IFREG)
+			continue;
+		const char *name = archive_entry_pathname(entry);
+		if(!name || !filter.invoke(name))
+			continue;
+		logMsg("extracting %s", name);
+		if(nameOut)
+			string_copy(nameOut, name, nameOutSize);
+		io = readEntry(arch, entry);
+		break;
+	}
+	if(!io)
+		logMsg("no file extracted from archive");
+	archive_read_free(arch);
+	return io;
+}
+
+Io *IoArchive::open(const char *path, EntryFilter filter, char *nameOut, uint nameOutSize)
+{
+	auto arch = newReader();
+	if(!arch)
+		return nullptr;
+	if(archive_read_open_filename(arch, path, 0x10000) != ARCHIVE_OK)
+	{
+		logErr("error opening archive %s: %s", path, archive_error_string(arch));
+		archive_read_free(arch);
+		return nullptr;
+	}
+	return extract(arch, filter, nameOut, nameOutSize);
+}
+
+Io *IoArchive::openMemory(const uchar *data, size_t size, EntryFilter filter, char *nameOut, uint nameOutSize)
+{
+	auto arch = newReader();
+	if(!arch)
+		return nullptr;
+	if(archive_read_open_memory(arch, (void*)data, size) != ARCHIVE_OK)
+	{
+		logErr("error opening archive in memory: %s", archive_error_string(arch));
+		archive_read_free(arch);
+		return nullptr;
+	}
+	return extract(arch, filter, nameOut, nameOutSize);
+}
+
+namespace
+{
+
+struct NameMatch
+{
+	const char *name;
+	bool matches(const char *entryName) { return string_equal(entryName, name); }
+};
+
+}
+
+Io *IoArchive::open(const char *path, const char *pathInArchive)
+{
+	NameMatch match {pathInArchive};
+	return open(path, EntryFilter::create<NameMatch, &NameMatch::matches>(&match));
+}
+
+bool IoArchive::hasArchiveExtension(const char *name)
+{
+	return string_hasDotExtension(name, "zip") || string_hasDotExtension(name, "7z");
+}
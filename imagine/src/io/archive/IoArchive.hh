@@ -0,0 +1,41 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#pragma once
+
+#include <engine-globals.h>
+#include <io/Io.hh>
+#include <util/Delegate.hh>
+
+// Zip & 7z archive reading through libarchive. Since neither format can
+// be seeked efficiently, the selected file is fully extracted and returned
+// as a memory-backed Io that supports mmapConst().
+class IoArchive
+{
+public:
+	// returns true for the archive entry to extract, given its path in the archive
+	typedef Delegate<bool (const char *name)> EntryFilter;
+
+	// extracts the first regular file accepted by filter, if nameOut
+	// is given it receives the file's path within the archive
+	static Io *open(const char *path, EntryFilter filter, char *nameOut = nullptr, uint nameOutSize = 0);
+	static Io *open(const char *path, const char *pathInArchive);
+	// same as open() with the archive already in memory, data must
+	// stay valid until the call returns
+	static Io *openMemory(const uchar *data, size_t size, EntryFilter filter,
+		char *nameOut = nullptr, uint nameOutSize = 0);
+
+	static bool hasArchiveExtension(const char *name);
+};
@@ -0,0 +1,13 @@
+ifndef inc_io_archive
+inc_io_archive := 1
+
+include $(IMAGINE_PATH)/src/io/build.mk
+include $(IMAGINE_PATH)/src/io/mmap/generic/build.mk
+
+include $(IMAGINE_PATH)/make/package/libarchive.mk
+
+configDefs += CONFIG_IO_ARCHIVE
+
+SRC += io/archive/IoArchive.cc io/archive/ArchiveCache.cc
+
+endif
@@ -0,0 +1,54 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "pixmapConv"
+#include <pixmap/PixmapConv.hh>
+
+namespace PixmapConv
+{
+
+// kept scalar, unrolling lets the loads of consecutive pixels overlap
+template <class T>
+static void lookupT(T * __restrict__ dest, const uint8 * __restrict__ src, uint pixels, const T *lut, uint8 andMask, uint8 orMask)
+{
+	uint i = 0;
+	for(; i + 4 <= pixels; i += 4)
+	{
+		T p0 = lut[(src[i] & andMask) | orMask];
+		T p1 = lut[(src[i+1] & andMask) | orMask];
+		T p2 = lut[(src[i+2] & andMask) | orMask];
+		T p3 = lut[(src[i+3] & andMask) | orMask];
+		dest[i] = p0;
+		dest[i+1] = p1;
+		dest[i+2] = p2;
+		dest[i+3] = p3;
+	}
+	for(; i < pixels; i++)
+	{
+		dest[i] = lut[(src[i] & andMask) | orMask];
+	}
+}
+
+void lookup(uint16 *dest, const uint8 *src, uint pixels, const uint16 *lut, uint8 andMask, uint8 orMask)
+{
+	lookupT(dest, src, pixels, lut, andMask, orMask);
+}
+
+void lookup(uint32 *dest, const uint8 *src, uint pixels, const uint32 *lut, uint8 andMask, uint8 orMask)
+{
+	lookupT(dest, src, pixels, lut, andMask, orMask);
+}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <engine-globals.h>
+
+// Pixel conversion of whole lines or frames, for emulator video output
+namespace PixmapConv
+{
+
+// dest[i] = lut[(src[i] & andMask) | orMask]
+void lookup(uint16 *dest, const uint8 *src, uint pixels, const uint16 *lut, uint8 andMask = 0xFF, uint8 orMask = 0);
+void lookup(uint32 *dest, const uint8 *src, uint pixels, const uint32 *lut, uint8 andMask = 0xFF, uint8 orMask = 0);
+
+}
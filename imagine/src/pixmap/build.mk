@@ -3,6 +3,6 @@ inc_pixmap := 1
 
 configDefs += CONFIG_PIXMAP
 
-SRC += pixmap/Pixmap.cc
+SRC += pixmap/Pixmap.cc pixmap/PixmapConv.cc
 
 endif
@@ -218,13 +218,33 @@ ResourceFace *ResourceFace::create(ResourceFont *font, FontSettings *set)
 	return inst;
 }
 
-void ResourceFace::free ()
+void ResourceFace::freeGlyphs()
 {
-	font->freeSize(faceSize);
 	iterateTimes(glyphTableEntries, i)
 	{
 		glyphTable[i].glyph->freeSafe();
 	}
+	atlas.deinit();
+}
+
+void ResourceFace::freeAtlasPageGlyphs(uint page)
+{
+	iterateTimes(glyphTableEntries, i)
+	{
+		auto glyph = glyphTable[i].glyph;
+		if(glyph && glyph->atlasPage == (int)page)
+		{
+			glyph->free();
+			// metrics stay valid for layout, only the renderable is re-created on next use
+			glyphTable[i].glyph = nullptr;
+		}
+	}
+}
+
+void ResourceFace::free ()
+{
+	font->freeSize(faceSize);
+	freeGlyphs();
 	mem_free(glyphTable);
 	delete this;
 }
@@ -259,10 +279,7 @@ CallResult ResourceFace::applySettings (FontSettings set)
 		{
 			logMsg("flushing glyph cache");
 			font->freeSize(faceSize);
-			iterateTimes(glyphTableEntries, i)
-			{
-				glyphTable[i].glyph->freeSafe();
-			}
+			freeGlyphs();
 		}
 
 		settings = set;
@@ -302,6 +319,54 @@ CallResult ResourceFace::writeCurrentChar(Pixmap *out)
 	return OK;
 }
 
+// glyphs are rendered here before going to the atlas, grown to the largest seen
+static uchar *glyphScratch = nullptr;
+static uint glyphScratchSize = 0;
+
+CallResult ResourceFace::addToAtlas(ResourceImageGlyph &glyph, const GlyphMetrics &metrics)
+{
+	uint page, x, y;
+	auto res = atlas.alloc(metrics.xSize, metrics.ySize, page, x, y);
+	if(res == NO_FREE_ENTRIES)
+	{
+		page = atlas.leastRecentlyUsedPage();
+		logMsg("atlas full, evicting glyphs in page %d", page);
+		freeAtlasPageGlyphs(page);
+		atlas.clearPage(page);
+		res = atlas.alloc(metrics.xSize, metrics.ySize, page, x, y);
+	}
+	if(res != OK)
+		return res;
+
+	if(metrics.xSize && metrics.ySize)
+	{
+		uint size = metrics.xSize * metrics.ySize;
+		if(size > glyphScratchSize)
+		{
+			auto newScratch = (uchar*)mem_realloc(glyphScratch, size);
+			if(!newScratch)
+			{
+				logErr("out of memory for %dx%d glyph", metrics.xSize, metrics.ySize);
+				return OUT_OF_MEMORY;
+			}
+			glyphScratch = newScratch;
+			glyphScratchSize = size;
+		}
+		Pixmap pix(PixelFormatI8);
+		pix.init(glyphScratch, metrics.xSize, metrics.ySize);
+		writeCurrentChar(&pix);
+		atlas.write(page, x, y, pix);
+	}
+	atlas.markUsed(page);
+	glyph.atlasPage = page;
+
+	auto &pageImg = atlas.pageImage(page);
+	GTexC xScale = pageImg.textureDesc().xEnd / (GTexC)GlyphAtlas::pageSize,
+		yScale = pageImg.textureDesc().yEnd / (GTexC)GlyphAtlas::pageSize;
+	return glyph.gfxD.initSubImage(pageImg, x * xScale, y * yScale,
+		(x + metrics.xSize) * xScale, (y + metrics.ySize) * yScale);
+}
+
 CallResult ResourceFace::cacheChar(int c, int tableIdx)
 {
 	if(glyphTable[tableIdx].metrics.ySize == -1)
@@ -397,6 +462,9 @@ GlyphEntry *ResourceFace::glyphEntry(int c)
 			return nullptr;
 		logMsg("char 0x%X was not in table, cached", c);
 	}
+	auto glyph = glyphTable[tableIdx].glyph;
+	if(glyph && glyph->atlasPage >= 0)
+		atlas.markUsed(glyph->atlasPage);
 
 	return &glyphTable[tableIdx];
 }
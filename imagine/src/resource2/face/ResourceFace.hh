@@ -3,6 +3,7 @@
 
 #include <resource2/font/ResourceFont.h>
 #include <resource2/font/common/glyphTable.h>
+#include <resource2/image/glyph/GlyphAtlas.hh>
 #define RESOURCE_FACE_SETTINGS_UNCHANGED 128
 #include <io/sys.hh>
 #include <pixmap/Pixmap.hh>
@@ -32,16 +33,20 @@ public:
 	}
 	GlyphEntry * glyphEntry(int c);
 	uint nominalHeight() const;
+	CallResult addToAtlas(ResourceImageGlyph &glyph, const GlyphMetrics &metrics);
 
 	FontSettings settings;
 	static constexpr bool supportsUnicode = Config::UNICODE_CHARS;
 private:
 	ResourceFont *font = nullptr;
 	GlyphEntry *glyphTable = nullptr;
+	GlyphAtlas atlas;
 	FontSizeRef faceSize;
 	uint nominalHeight_ = 0;
 
 	void calcNominalHeight();
 	void initGlyphTable ();
+	void freeGlyphs();
+	void freeAtlasPageGlyphs(uint page);
 	CallResult cacheChar (int c, int tableIdx);
 };
@@ -0,0 +1,124 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "res:img:glyphAtlas"
+#include <gfx/Gfx.hh>
+#include <mem/interface.h>
+#include "GlyphAtlas.hh"
+
+CallResult GlyphAtlas::initPage(Page &p)
+{
+	Pixmap pix(PixelFormatI8);
+	pix.init(nullptr, pageSize, pageSize);
+	if(p.img.init(pix, 0, Gfx::BufferImage::linear, Gfx::BufferImage::HINT_NO_MINIFY) != OK)
+		return INVALID_PARAMETER;
+	clearPage(&p - pages);
+	return OK;
+}
+
+void GlyphAtlas::clearPage(uint page)
+{
+	auto &p = pages[page];
+	uchar *blank = (uchar*)mem_alloc(pageSize * pageSize);
+	if(blank)
+	{
+		mem_zero(blank, pageSize * pageSize);
+		Pixmap pix(PixelFormatI8);
+		pix.init(blank, pageSize, pageSize);
+		p.img.write(pix);
+		mem_free(blank);
+	}
+	else
+		logErr("out of memory clearing atlas page %d", page);
+	p.penX = p.penY = p.shelfYSize = 0;
+	p.lastUse = 0;
+}
+
+bool GlyphAtlas::allocInPage(Page &p, uint xSize, uint ySize, uint &x, uint &y)
+{
+	if(p.penX + xSize > pageSize)
+	{
+		// start a new shelf under the current one
+		p.penY += p.shelfYSize;
+		p.penX = p.shelfYSize = 0;
+	}
+	if(p.penY + ySize > pageSize)
+		return 0;
+	x = p.penX;
+	y = p.penY;
+	p.penX += xSize;
+	p.shelfYSize = IG::max(p.shelfYSize, ySize);
+	return 1;
+}
+
+CallResult GlyphAtlas::alloc(uint xSize, uint ySize, uint &page, uint &x, uint &y)
+{
+	// reserve the blank texel to the right & below
+	xSize++;
+	ySize++;
+	if(xSize > pageSize || ySize > pageSize)
+		return OUT_OF_BOUNDS;
+	// keep packing the open page, then any other with room for this size
+	iterateTimes(usedPages, i)
+	{
+		uint tryPage = (openPage + i) % usedPages;
+		if(allocInPage(pages[tryPage], xSize, ySize, x, y))
+		{
+			page = openPage = tryPage;
+			return OK;
+		}
+	}
+	if(usedPages == maxPages)
+		return NO_FREE_ENTRIES;
+	auto &p = pages[usedPages];
+	if(initPage(p) != OK)
+	{
+		logErr("unable to create atlas page %d", usedPages);
+		return OUT_OF_MEMORY;
+	}
+	logMsg("added atlas page %d", usedPages);
+	page = openPage = usedPages++;
+	allocInPage(p, xSize, ySize, x, y);
+	return OK;
+}
+
+void GlyphAtlas::write(uint page, uint x, uint y, Pixmap &pix)
+{
+	pages[page].img.writeSubImage(pix, x, y);
+}
+
+uint GlyphAtlas::leastRecentlyUsedPage() const
+{
+	uint lru = 0;
+	iterateTimes(usedPages, i)
+	{
+		if(pages[i].lastUse < pages[lru].lastUse)
+			lru = i;
+	}
+	return lru;
+}
+
+void GlyphAtlas::deinit()
+{
+	iterateTimes(usedPages, i)
+	{
+		pages[i].img.deinit();
+		pages[i].penX = pages[i].penY = pages[i].shelfYSize = 0;
+		pages[i].lastUse = 0;
+	}
+	usedPages = 0;
+	openPage = 0;
+	useCounter = 0;
+}
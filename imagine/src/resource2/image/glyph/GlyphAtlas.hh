@@ -0,0 +1,43 @@
+#pragma once
+
+#include <engine-globals.h>
+#include <gfx/GfxBufferImage.hh>
+#include <pixmap/Pixmap.hh>
+
+// Packs the glyphs of one face size into shared texture pages so text using
+// them draws from a single texture. Glyphs fill rows (shelves) of a page
+// with a blank texel between them to keep linear filtering from bleeding.
+class GlyphAtlas
+{
+public:
+	static const uint pageSize = 512;
+	static const uint maxPages = 4;
+
+	constexpr GlyphAtlas() { }
+	// finds space for a glyph, NO_FREE_ENTRIES if every page is full,
+	// OUT_OF_BOUNDS if it can never fit in a page
+	CallResult alloc(uint xSize, uint ySize, uint &page, uint &x, uint &y);
+	void write(uint page, uint x, uint y, Pixmap &pix);
+	Gfx::BufferImage &pageImage(uint page) { return pages[page].img; }
+	void markUsed(uint page) { pages[page].lastUse = ++useCounter; }
+	uint leastRecentlyUsedPage() const;
+	// empties a page, glyphs pointing to it must be freed first
+	void clearPage(uint page);
+	void deinit();
+
+private:
+	struct Page
+	{
+		constexpr Page() { }
+		Gfx::BufferImage img;
+		uint penX = 0, penY = 0, shelfYSize = 0;
+		uint lastUse = 0;
+	};
+	Page pages[maxPages];
+	uint usedPages = 0;
+	uint openPage = 0;
+	uint useCounter = 0;
+
+	CallResult initPage(Page &p);
+	static bool allocInPage(Page &p, uint xSize, uint ySize, uint &x, uint &y);
+};
@@ -33,7 +33,11 @@ ResourceImageGlyph *ResourceImageGlyph::createWithFace(ResourceFace *face, Glyph
 	inst->face = face;
 	inst->idx = idx;
 
-	inst->gfxD.init(*inst, Gfx::BufferImage::linear, Gfx::BufferImage::HINT_NO_MINIFY);
+	if(face->addToAtlas(*inst, idx->metrics) != OK)
+	{
+		// too large for an atlas page
+		inst->gfxD.init(*inst, Gfx::BufferImage::linear, Gfx::BufferImage::HINT_NO_MINIFY);
+	}
 	inst->ResourceImage::init();
 
 	return inst;
@@ -17,6 +17,8 @@ public:
 	uint height();
 	const PixelFormatDesc *pixelFormat() const;
 	float aspectRatio();
+
+	int atlasPage = -1; // -1 if the glyph has its own texture
 private:
 	ResourceFace *face = nullptr;
 	GlyphEntry *idx = nullptr;
@@ -5,6 +5,6 @@ include $(IMAGINE_PATH)/src/resource2/image/build.mk
 
 configDefs += CONFIG_RESOURCE_IMAGE_GLYPH
 
-SRC += resource2/image/glyph/ResourceImageGlyph.cc
+SRC += resource2/image/glyph/ResourceImageGlyph.cc resource2/image/glyph/GlyphAtlas.cc
 
 endif
@@ -15,113 +15,134 @@
 	You should have received a copy of the GNU General Public License
 	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
 
-#include <util/cLang.h>
-
-template <class SIZE = uint>
+#include <engine-globals.h>
+#include <string.h>
+
+// Lock-free ring of T elements between a single producer & single consumer.
+// Each side owns its own index and only reads the other's, so the two can
+// run on different threads with no locking. The indices sit on separate
+// cache lines to keep the threads from invalidating each other's writes.
+// Besides copying with write() & read(), each side can access the buffer
+// directly with reserve()/commit() and peek()/consume(), which hand out
+// the contiguous run up to the wrap point.
+template <class T = uchar>
 class RingBuffer
 {
 public:
-	void init(uchar *buff, SIZE size)
+	constexpr RingBuffer() { }
+
+	void init(T *buff, uint size)
 	{
+		assert(size && size <= 0x7FFFFFFF);
 		this->buff = buff;
-		buffSize = size;
+		capacity = size;
 		reset();
 	}
 
+	// only call when neither side is accessing the buffer
 	void reset()
 	{
-		start = end = buff;
-		written = 0;
+		__atomic_store_n(&head, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&tail, 0, __ATOMIC_RELEASE);
 	}
 
-	SIZE freeSpace()
+	uint size() const { return capacity; }
+
+	// elements ready to read, exact on the consumer side
+	uint readAvailable() const
 	{
-		return buffSize - written;
+		return used(__atomic_load_n(&head, __ATOMIC_ACQUIRE), __atomic_load_n(&tail, __ATOMIC_RELAXED));
 	}
 
-	uchar *advancePtr(uchar *ptr)
+	// elements that can be written, exact on the producer side
+	uint writeAvailable() const
 	{
-		assert(ptr >= buff && ptr < buff+buffSize);
-		ptr++;
-		if(ptr == buff+buffSize)
-			ptr = buff;
-		return ptr;
+		return capacity - used(__atomic_load_n(&head, __ATOMIC_RELAXED), __atomic_load_n(&tail, __ATOMIC_ACQUIRE));
 	}
 
-	SIZE write(uchar *buff, SIZE size)
+	// producer side
+
+	// returns a pointer to up to n elements that can be written without
+	// wrapping and sets n to that count, 0 if the buffer is full
+	T *reserve(uint &n)
 	{
-		if(size > freeSpace())
-			size = freeSpace();
-
-		uchar *writePos = end;
-		iterateTimes(size, i)
-		{
-			//logMsg("addr %p", writePos);
-			*writePos = buff[i];
-			written++;
-			writePos = advancePtr(writePos);
-		}
-		end = writePos;
-
-		assert(written <= buffSize);
-
-		//logMsg("wrote %d bytes", (int)size);
-		return size;
+		uint h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+		uint free = capacity - used(h, __atomic_load_n(&tail, __ATOMIC_ACQUIRE));
+		uint pos = wrap(h);
+		n = IG::min(n, IG::min(free, capacity - pos));
+		return n ? &buff[pos] : nullptr;
 	}
 
-	SIZE read(uchar *buff, SIZE size)
+	// makes n reserved elements visible to the consumer
+	void commit(uint n)
 	{
-		if(size > written)
-			size = written;
-
-		uchar *readPos = start;
-		iterateTimes(size, i)
-		{
-			//logMsg("addr %p", readPos);
-			buff[i] = *readPos;
-			written--;
-			readPos = advancePtr(readPos);
-		}
-		start = readPos;
-
-		//logMsg("read %d bytes", (int)size);
-		return size;
+		uint h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+		__atomic_store_n(&head, advance(h, n), __ATOMIC_RELEASE);
 	}
 
-	SIZE readPadded(uchar *buff, SIZE size)
+	uint write(const T *src, uint n)
 	{
-		SIZE readSize = read(buff, size);
-		if(readSize < size)
-		{
-			uint padBytes = size - readSize;
-			logMsg("padding %d bytes", padBytes);
-			uchar padVal = readSize ? buff[readSize-1] : 0;
-			memset(&buff[readSize], padVal, padBytes);
-		}
-		return readSize;
+		uint h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+		n = IG::min(n, capacity - used(h, __atomic_load_n(&tail, __ATOMIC_ACQUIRE)));
+		uint pos = wrap(h);
+		uint firstRun = IG::min(n, capacity - pos);
+		memcpy(&buff[pos], src, firstRun * sizeof(T));
+		memcpy(buff, src + firstRun, (n - firstRun) * sizeof(T));
+		__atomic_store_n(&head, advance(h, n), __ATOMIC_RELEASE);
+		return n;
 	}
 
-	SIZE readPadded32(uchar *buff, SIZE size)
+	// consumer side
+
+	// returns a pointer to up to n elements that can be read without
+	// wrapping and sets n to that count, 0 if the buffer is empty
+	const T *peek(uint &n) const
 	{
-		assert(size % 4 == 0);
-		SIZE readSize = read(buff, size);
-		assert(readSize % 4 == 0);
-		if(readSize < size)
-		{
-			uint padElements = (size - readSize) / 4;
-			logMsg("padding %dx4 bytes", padElements);
-			uint padVal = 0;
-			if(readSize)
-				memcpy(&padVal, &buff[readSize-4], 4);
-			iterateTimes(padElements, i)
-				memcpy(&buff[readSize + (i*4)], &padVal, 4);
-		}
-		return readSize;
+		uint t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+		uint avail = used(__atomic_load_n(&head, __ATOMIC_ACQUIRE), t);
+		uint pos = wrap(t);
+		n = IG::min(n, IG::min(avail, capacity - pos));
+		return n ? &buff[pos] : nullptr;
+	}
+
+	// releases n peeked elements back to the producer
+	void consume(uint n)
+	{
+		uint t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+		__atomic_store_n(&tail, advance(t, n), __ATOMIC_RELEASE);
+	}
+
+	uint read(T *dest, uint n)
+	{
+		uint t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+		n = IG::min(n, used(__atomic_load_n(&head, __ATOMIC_ACQUIRE), t));
+		uint pos = wrap(t);
+		uint firstRun = IG::min(n, capacity - pos);
+		memcpy(dest, &buff[pos], firstRun * sizeof(T));
+		memcpy(dest + firstRun, buff, (n - firstRun) * sizeof(T));
+		__atomic_store_n(&tail, advance(t, n), __ATOMIC_RELEASE);
+		return n;
 	}
 
-	SIZE written;
-	SIZE buffSize;
 private:
-	uchar *buff;
-	uchar *start, *end;
+	static const uint cacheLineSize = 64;
+
+	// indices count up to 2 * capacity so a full buffer can be told apart
+	// from an empty one without leaving a slot unused
+	uint wrap(uint idx) const { return idx >= capacity ? idx - capacity : idx; }
+
+	uint advance(uint idx, uint n) const
+	{
+		assert(n <= capacity);
+		idx += n;
+		return idx >= capacity * 2 ? idx - capacity * 2 : idx;
+	}
+
+	uint used(uint h, uint t) const { return h >= t ? h - t : h + capacity * 2 - t; }
+
+	T *buff = nullptr;
+	uint capacity = 0;
+	uint head __attribute__ ((aligned (cacheLineSize))) = 0; // written by the producer
+	uint tail __attribute__ ((aligned (cacheLineSize))) = 0; // written by the consumer
+	char pad[cacheLineSize - sizeof(uint)] {0};
 };
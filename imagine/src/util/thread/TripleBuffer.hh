@@ -0,0 +1,59 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <engine-globals.h>
+#include <util/bits.h>
+
+// Lock-free buffer index exchange between a single producer & single consumer.
+// The producer always owns writeIdx(), the consumer always owns readIdx(),
+// and the third buffer is swapped between them on commit() & update().
+class TripleBufferIndex
+{
+public:
+	constexpr TripleBufferIndex() { }
+
+	void reset()
+	{
+		front = 0;
+		back = 2;
+		__atomic_store_n(&shared, 1, __ATOMIC_RELEASE);
+	}
+
+	// producer side
+	uint writeIdx() const { return back; }
+
+	void commit()
+	{
+		back = __atomic_exchange_n(&shared, back | FRESH_BIT, __ATOMIC_ACQ_REL) & IDX_MASK;
+	}
+
+	// consumer side, returns true if readIdx() now refers to a newly committed buffer
+	bool update()
+	{
+		if(!(__atomic_load_n(&shared, __ATOMIC_ACQUIRE) & FRESH_BIT))
+			return 0;
+		front = __atomic_exchange_n(&shared, front, __ATOMIC_ACQ_REL) & IDX_MASK;
+		return 1;
+	}
+
+	uint readIdx() const { return front; }
+
+private:
+	static const uint FRESH_BIT = BIT(2), IDX_MASK = 0x3;
+	uint front = 0, back = 2;
+	uint shared = 1;
+};
@@ -0,0 +1,192 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define thisModuleName "frameProfiler"
+#include <util/time/FrameProfiler.hh>
+#include <util/time/sys.hh>
+#include <stdio.h>
+
+namespace FrameProfiler
+{
+
+struct Event
+{
+	uint64 start, duration;
+	uint8 zone, thread;
+};
+
+static const uint maxDepth = 8;
+static const uint maxEvents = 16384;
+
+// per-thread stack of open zones
+static __thread uint8 stackZone[maxDepth];
+static __thread uint64 stackStart[maxDepth];
+static __thread uint depth = 0;
+static __thread uint64 lastMark = 0;
+static __thread int threadIdx = -1;
+static uint threads = 0;
+
+// self time of each zone in the current frame, added to by any thread
+static uint64 zoneNSecs[ZONES] {0};
+
+static uint64 ring[ringFrames][ZONES + 1];
+static uint ringPos = 0, ringCount = 0;
+static uint64 lastFrameEnd = 0;
+
+static Event event[maxEvents];
+static uint eventPos = 0;
+
+static const char *zoneStr[ZONES] = { "Emulate", "Video", "Audio", "Resample", "Upload", "Swap" };
+
+static uint64 nowNSecs()
+{
+	TimeSys now;
+	now.setTimeNow();
+	return double(now) * 1.0e9;
+}
+
+static void addSelfTime(uint zone, uint64 nsecs)
+{
+	__atomic_fetch_add(&zoneNSecs[zone], nsecs, __ATOMIC_RELAXED);
+}
+
+void begin(Zone zone)
+{
+	uint64 now = nowNSecs();
+	if(depth && depth <= maxDepth)
+		addSelfTime(stackZone[depth - 1], now - lastMark);
+	if(depth < maxDepth)
+	{
+		stackZone[depth] = zone;
+		stackStart[depth] = now;
+	}
+	depth++;
+	lastMark = now;
+}
+
+void end()
+{
+	uint64 now = nowNSecs();
+	assert(depth);
+	depth--;
+	if(depth < maxDepth)
+	{
+		uint zone = stackZone[depth];
+		addSelfTime(zone, now - lastMark);
+		if(unlikely(threadIdx == -1))
+			threadIdx = __atomic_fetch_add(&threads, 1, __ATOMIC_RELAXED);
+		auto &e = event[__atomic_fetch_add(&eventPos, 1, __ATOMIC_RELAXED) % maxEvents];
+		e = { stackStart[depth], now - stackStart[depth], (uint8)zone, (uint8)threadIdx };
+	}
+	lastMark = now;
+}
+
+void endFrame()
+{
+	uint64 now = nowNSecs();
+	auto &frame = ring[ringPos];
+	iterateTimes(ZONES, i)
+	{
+		frame[i] = __atomic_exchange_n(&zoneNSecs[i], 0, __ATOMIC_RELAXED);
+	}
+	frame[ZONES] = lastFrameEnd ? now - lastFrameEnd : 0;
+	lastFrameEnd = now;
+	ringPos = (ringPos + 1) % ringFrames;
+	if(ringCount < ringFrames)
+		ringCount++;
+}
+
+const char *zoneName(uint zone)
+{
+	assert(zone < ZONES);
+	return zoneStr[zone];
+}
+
+static double average(uint idx)
+{
+	if(!ringCount)
+		return 0;
+	uint64 total = 0;
+	iterateTimes(ringCount, i)
+	{
+		total += ring[i][idx];
+	}
+	return (total / 1.0e9) / ringCount;
+}
+
+double averageSecs(Zone zone)
+{
+	return average(zone);
+}
+
+double averageFrameSecs()
+{
+	return average(ZONES);
+}
+
+bool writeCSV(const char *path)
+{
+	FILE *f = fopen(path, "w");
+	if(!f)
+	{
+		logErr("can't open %s", path);
+		return 0;
+	}
+	fprintf(f, "frame");
+	iterateTimes(ZONES, i)
+	{
+		fprintf(f, ",%s", zoneStr[i]);
+	}
+	fprintf(f, ",Total\n");
+	uint first = (ringPos + ringFrames - ringCount) % ringFrames;
+	iterateTimes(ringCount, i)
+	{
+		auto &frame = ring[(first + i) % ringFrames];
+		fprintf(f, "%d", i);
+		iterateTimes(ZONES + 1, z)
+		{
+			fprintf(f, ",%.1f", frame[z] / 1000.);
+		}
+		fprintf(f, "\n");
+	}
+	fclose(f);
+	logMsg("wrote %d frames to %s", ringCount, path);
+	return 1;
+}
+
+bool writeTrace(const char *path)
+{
+	FILE *f = fopen(path, "w");
+	if(!f)
+	{
+		logErr("can't open %s", path);
+		return 0;
+	}
+	uint pos = __atomic_load_n(&eventPos, __ATOMIC_RELAXED);
+	uint events = IG::min(pos, maxEvents);
+	fprintf(f, "{\"traceEvents\":[\n");
+	iterateTimes(events, i)
+	{
+		auto &e = event[(pos - events + i) % maxEvents];
+		fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+			zoneStr[e.zone], e.thread, e.start / 1000., e.duration / 1000., i + 1 == events ? "" : ",");
+	}
+	fprintf(f, "]}\n");
+	fclose(f);
+	logMsg("wrote %d events to %s", events, path);
+	return 1;
+}
+
+}
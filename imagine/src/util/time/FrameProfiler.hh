@@ -0,0 +1,73 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <engine-globals.h>
+
+// Scoped timers for the per-frame hot path. Each zone accumulates its own
+// time minus any zones nested inside it, and the totals are closed into a
+// ring of recent frames by endFrame() after every swap. Without
+// CONFIG_FRAME_PROFILER (FrameProfiler.mk) profileZone() compiles to nothing.
+
+namespace FrameProfiler
+{
+
+enum Zone
+{
+	ZONE_EMULATE,
+	ZONE_VIDEO,
+	ZONE_AUDIO,
+	ZONE_RESAMPLE,
+	ZONE_UPLOAD,
+	ZONE_SWAP,
+
+	ZONES
+};
+
+static const uint ringFrames = 120;
+
+#ifdef CONFIG_FRAME_PROFILER
+
+void begin(Zone zone);
+void end();
+void endFrame();
+const char *zoneName(uint zone);
+// averages over the frames currently in the ring
+double averageSecs(Zone zone);
+double averageFrameSecs();
+// one row per frame of zone times in microseconds
+bool writeCSV(const char *path);
+// recent zone begin/end events in Chrome's trace event format
+bool writeTrace(const char *path);
+
+class ScopedZone
+{
+public:
+	ScopedZone(Zone zone) { begin(zone); }
+	~ScopedZone() { end(); }
+};
+
+#define profileZone(zone) FrameProfiler::ScopedZone frameProfilerZone_(FrameProfiler::zone)
+
+#else
+
+static inline void endFrame() { }
+
+#define profileZone(zone)
+
+#endif
+
+}
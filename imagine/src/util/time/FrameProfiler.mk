@@ -0,0 +1,8 @@
+ifndef inc_util_frameprofiler
+inc_util_frameprofiler := 1
+
+configDefs += CONFIG_FRAME_PROFILER
+
+SRC += util/time/FrameProfiler.cc
+
+endif